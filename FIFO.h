@@ -1,4 +1,3 @@
-<<<<<<< HEAD
 // FIFO.h
 // Runs on any LM3Sxxx
 // Provide functions that initialize a FIFO, put data in, get data out,
@@ -29,75 +28,21 @@
 #ifndef __FIFO_H__
 #define __FIFO_H__
 
-long StartCritical (void);    // previous I bit, disable interrupts
-void EndCritical(long sr);    // restore I bit to previous value
-
-// Two-pointer implementation of the receive FIFO
-// can hold 0 to RXFIFOSIZE-1 elements
-#define JSFIFOSIZE 4 // can be any size
-#define JSFIFOSUCCESS 1
-#define JSFIFOFAIL    0
-
-typedef struct {
-	uint16_t x,y;
-	uint8_t select;
-}  jsDataType;
-
-// initialize pointer FIFO
-void JsFifo_Init(void);
-// add element to end of pointer FIFO
-// return RXFIFOSUCCESS if successful
-int JsFifo_Put(jsDataType data);
-// remove element from front of pointer FIFO
-// return RXFIFOSUCCESS if successful
-int JsFifo_Get(jsDataType *datapt);
-// number of elements in pointer FIFO
-// 0 to RXFIFOSIZE-1
-uint32_t JsFifo_Size(void);
-
-#endif //  __FIFO_H__
-=======
-// FIFO.h
-// Runs on any LM3Sxxx
-// Provide functions that initialize a FIFO, put data in, get data out,
-// and return the current size.  The file includes a transmit FIFO
-// using index implementation and a receive FIFO using pointer
-// implementation.  Other index or pointer implementation FIFOs can be
-// created using the macros supplied at the end of the file.
-// Daniel Valvano
-// May 2, 2015
-
-/* This example accompanies the book
-   "Embedded Systems: Real Time Interfacing to Arm Cortex M Microcontrollers",
-   ISBN: 978-1463590154, Jonathan Valvano, copyright (c) 2015
-      Programs 3.7, 3.8., 3.9 and 3.10 in Section 3.7
-
- Copyright 2015 by Jonathan W. Valvano, valvano@mail.utexas.edu
-    You may use, edit, run or distribute this file
-    as long as the above copyright notice remains
- THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
- OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
- MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
- VALVANO SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL,
- OR CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
- For more information about my classes, my research, and my books, see
- http://users.ece.utexas.edu/~valvano/
- */
-
-#ifndef __FIFO_H__
-#define __FIFO_H__
+#include <stdint.h>
+#include <string.h>
 
 long StartCritical (void);    // previous I bit, disable interrupts
 void EndCritical(long sr);    // restore I bit to previous value
 
-// Two-pointer implementation of the receive FIFO
-// can hold 0 to RXFIFOSIZE-1 elements
-#define RXFIFOSIZE 30 // can be any size
+// Ring implementation of the receive FIFO, see AddRingFifo
+// can hold 0 to RXFIFOSIZE elements
+#define RXFIFOSIZE 32 // must be a power of 2
 #define RXFIFOSUCCESS 1
 #define RXFIFOFAIL    0
 
 typedef struct {
 	uint16_t x,y;
+	uint32_t time;	// OS_Time() of the sample
 }  rxDataType;
 
 // initialize pointer FIFO
@@ -108,10 +53,30 @@ int RxFifo_Put(rxDataType data);
 // remove element from front of pointer FIFO
 // return RXFIFOSUCCESS if successful
 int RxFifo_Get(rxDataType *datapt);
-// number of elements in pointer FIFO
-// 0 to RXFIFOSIZE-1
+// number of elements in FIFO
+// 0 to RXFIFOSIZE
 uint32_t RxFifo_Size(void);
 
+// Latest-value mailbox: one slot the writer overwrites, so the
+// reader always gets the newest sample and never a backlog.
+// Seqlock, one interrupt writer and one thread reader, neither
+// blocks.  The counters run from RxMail_Init() so the reader can
+// take the motion it missed as well as the newest position.
+typedef struct {
+	rxDataType data;	// newest sample
+	uint32_t count;		// samples put
+	int32_t dx,dy;		// motion summed over every sample put
+}  rxMailType;
+
+// initialize the mailbox, empty
+void RxMail_Init(void);
+// overwrite the mailbox with the newest sample
+void RxMail_Put(rxDataType data);
+// copy the mailbox into *mail, which holds the previous copy
+// (all zero the first time)
+// return the samples put since the previous copy, 0 if none
+uint32_t RxMail_Get(rxMailType *mail);
+
 // macro to create an index FIFO
 #define AddIndexFifo(NAME,SIZE,TYPE,SUCCESS,FAIL) \
 uint32_t volatile NAME ## PutI;    \
@@ -127,7 +92,7 @@ int NAME ## Fifo_Put (TYPE data){       \
     return(FAIL);      \
   }                    \
   NAME ## Fifo[ NAME ## PutI &(SIZE-1)] = data; \
-  NAME ## PutI ## ++;  \
+  NAME ## PutI++;      \
   return(SUCCESS);     \
 }                      \
 int NAME ## Fifo_Get (TYPE *datapt){  \
@@ -135,7 +100,7 @@ int NAME ## Fifo_Get (TYPE *datapt){  \
     return(FAIL);      \
   }                    \
   *datapt = NAME ## Fifo[ NAME ## GetI &(SIZE-1)];  \
-  NAME ## GetI ## ++;  \
+  NAME ## GetI++;      \
   return(SUCCESS);     \
 }                      \
 unsigned short NAME ## Fifo_Size (void){  \
@@ -175,7 +140,7 @@ int NAME ## Fifo_Get (TYPE *datapt){    \
   if( NAME ## PutPt == NAME ## GetPt ){ \
     return(FAIL);                       \
   }                                     \
-  *datapt = *( NAME ## GetPt ## ++);    \
+  *datapt = *( NAME ## GetPt ++);       \
   if( NAME ## GetPt == &NAME ## Fifo[SIZE]){ \
     NAME ## GetPt = &NAME ## Fifo[0];   \
   }                                     \
@@ -183,14 +148,165 @@ int NAME ## Fifo_Get (TYPE *datapt){    \
 }                                       \
 unsigned short NAME ## Fifo_Size (void){\
   if( NAME ## PutPt < NAME ## GetPt ){  \
-    return ((uint32_t)( NAME ## PutPt - NAME ## GetPt + (SIZE*sizeof(TYPE)))/sizeof(TYPE)); \
+    return ((uint32_t)( NAME ## PutPt - NAME ## GetPt + SIZE)); \
   }                                     \
-  return ((uint32_t)( NAME ## PutPt - NAME ## GetPt )/sizeof(TYPE)); \
+  return ((uint32_t)( NAME ## PutPt - NAME ## GetPt )); \
 }
 // e.g.,
 // AddPointerFifo(Rx,32,unsigned char, 1,0)
 // SIZE can be any size
 // creates RxFifo_Init() RxFifo_Get() and RxFifo_Put()
 
+// Orders the element copy and the index that hands it over, so the
+// other side never sees an index before the data behind it.  One
+// core with interrupts needs the compiler barrier only, __dmb() also
+// covers a DMA or another bus master reading the buffer.
+#if defined(__CC_ARM) || defined(__ARMCC_VERSION)
+#define RING_BARRIER() __dmb(0xF)
+#elif defined(__GNUC__)
+#define RING_BARRIER() __atomic_thread_fence(__ATOMIC_ACQ_REL)
+#else
+#define RING_BARRIER()
+#endif
+
+// macro to create a ring FIFO, one producer and one consumer
+// (interrupt or thread) that never lock each other out.  PutI and
+// GetI run freely, each is written by one side only.
+// _PutN/_GetN copy up to n elements in at most two memcpy()s.
+// _Peek returns the oldest elements that are contiguous in the
+// buffer without copying, _Skip(n) then removes n of them;
+// _Reserve/_Commit(n) do the same for the producer.
+#define AddRingFifo(NAME,SIZE,TYPE,SUCCESS,FAIL) \
+uint32_t volatile NAME ## RingPutI;   \
+uint32_t volatile NAME ## RingGetI;   \
+TYPE static NAME ## Ring [SIZE];      \
+void NAME ## Fifo_Init(void){ long sr;  \
+  sr = StartCritical();                 \
+  NAME ## RingPutI = NAME ## RingGetI = 0; \
+  EndCritical(sr);                      \
+}                                       \
+int NAME ## Fifo_Put (TYPE data){       \
+  uint32_t putI = NAME ## RingPutI;     \
+  if(putI - NAME ## RingGetI >= (SIZE)){  \
+    return(FAIL);                       \
+  }                                     \
+  NAME ## Ring[putI & ((SIZE)-1)] = data;  \
+  RING_BARRIER();                       \
+  NAME ## RingPutI = putI + 1;          \
+  return(SUCCESS);                      \
+}                                       \
+int NAME ## Fifo_Get (TYPE *datapt){    \
+  uint32_t getI = NAME ## RingGetI;     \
+  if(getI == NAME ## RingPutI){         \
+    return(FAIL);                       \
+  }                                     \
+  RING_BARRIER();                       \
+  *datapt = NAME ## Ring[getI & ((SIZE)-1)];  \
+  RING_BARRIER();                       \
+  NAME ## RingGetI = getI + 1;          \
+  return(SUCCESS);                      \
+}                                       \
+uint32_t NAME ## Fifo_Size (void){      \
+  return (NAME ## RingPutI - NAME ## RingGetI);  \
+}                                       \
+uint32_t NAME ## Fifo_PutN (const TYPE *data, uint32_t n){  \
+  uint32_t putI = NAME ## RingPutI, at, first;  \
+  uint32_t room = (SIZE) - (putI - NAME ## RingGetI);  \
+  if(n > room) n = room;                \
+  at = putI & ((SIZE)-1);               \
+  first = ((SIZE) - at < n) ? (SIZE) - at : n;  \
+  memcpy(&NAME ## Ring[at], data, first*sizeof(TYPE));  \
+  memcpy(&NAME ## Ring[0], data + first, (n - first)*sizeof(TYPE));  \
+  RING_BARRIER();                       \
+  NAME ## RingPutI = putI + n;          \
+  return n;                             \
+}                                       \
+uint32_t NAME ## Fifo_GetN (TYPE *data, uint32_t n){  \
+  uint32_t getI = NAME ## RingGetI, at, first;  \
+  uint32_t size = NAME ## RingPutI - getI;  \
+  if(n > size) n = size;                \
+  RING_BARRIER();                       \
+  at = getI & ((SIZE)-1);               \
+  first = ((SIZE) - at < n) ? (SIZE) - at : n;  \
+  memcpy(data, &NAME ## Ring[at], first*sizeof(TYPE));  \
+  memcpy(data + first, &NAME ## Ring[0], (n - first)*sizeof(TYPE));  \
+  RING_BARRIER();                       \
+  NAME ## RingGetI = getI + n;          \
+  return n;                             \
+}                                       \
+TYPE *NAME ## Fifo_Peek (uint32_t *n){  \
+  uint32_t getI = NAME ## RingGetI;     \
+  uint32_t size = NAME ## RingPutI - getI;  \
+  uint32_t at = getI & ((SIZE)-1);      \
+  RING_BARRIER();                       \
+  *n = ((SIZE) - at < size) ? (SIZE) - at : size;  \
+  return &NAME ## Ring[at];             \
+}                                       \
+void NAME ## Fifo_Skip (uint32_t n){    \
+  RING_BARRIER();                       \
+  NAME ## RingGetI = NAME ## RingGetI + n;  \
+}                                       \
+TYPE *NAME ## Fifo_Reserve (uint32_t *n){  \
+  uint32_t putI = NAME ## RingPutI;     \
+  uint32_t room = (SIZE) - (putI - NAME ## RingGetI);  \
+  uint32_t at = putI & ((SIZE)-1);      \
+  *n = ((SIZE) - at < room) ? (SIZE) - at : room;  \
+  return &NAME ## Ring[at];             \
+}                                       \
+void NAME ## Fifo_Commit (uint32_t n){  \
+  RING_BARRIER();                       \
+  NAME ## RingPutI = NAME ## RingPutI + n;  \
+}
+// e.g.,
+// AddRingFifo(Rx,32,rxDataType, 1,0)
+// SIZE must be a power of two, the FIFO holds 0 to SIZE elements
+// creates RxFifo_Init() RxFifo_Put() RxFifo_Get() RxFifo_Size()
+// RxFifo_PutN() RxFifo_GetN() RxFifo_Peek() RxFifo_Skip()
+// RxFifo_Reserve() and RxFifo_Commit()
+
+// macros to add an OS semaphore to a ring FIFO so that one side
+// can block, needs os.h.  Use one of them per FIFO.
+// AddRingFifoGetWait: a thread blocks while the FIFO is empty,
+//   _PutSignal() never blocks (interrupts), _GetWait() blocks
+// AddRingFifoPutWait: a thread blocks while the FIFO is full,
+//   _PutWait() blocks, _GetSignal() never blocks (interrupts)
+// both create NAME ## Fifo_InitWait() to use instead of _Init()
+#define AddRingFifoGetWait(NAME,SIZE,TYPE,SUCCESS,FAIL) \
+Sema4Type NAME ## DataAvailable;        \
+void NAME ## Fifo_InitWait(void){       \
+  NAME ## Fifo_Init();                  \
+  OS_InitSemaphore(&NAME ## DataAvailable, 0);  \
+}                                       \
+int NAME ## Fifo_PutSignal (TYPE data){ \
+  if(NAME ## Fifo_Put(data) == (FAIL)){ \
+    return(FAIL);                       \
+  }                                     \
+  OS_Signal(&NAME ## DataAvailable);    \
+  return(SUCCESS);                      \
+}                                       \
+void NAME ## Fifo_GetWait (TYPE *datapt){  \
+  OS_Wait(&NAME ## DataAvailable);      \
+  NAME ## Fifo_Get(datapt);             \
+}
+#define AddRingFifoPutWait(NAME,SIZE,TYPE,SUCCESS,FAIL) \
+Sema4Type NAME ## RoomLeft;             \
+void NAME ## Fifo_InitWait(void){       \
+  NAME ## Fifo_Init();                  \
+  OS_InitSemaphore(&NAME ## RoomLeft, SIZE);  \
+}                                       \
+void NAME ## Fifo_PutWait (TYPE data){  \
+  OS_Wait(&NAME ## RoomLeft);           \
+  NAME ## Fifo_Put(data);               \
+}                                       \
+int NAME ## Fifo_GetSignal (TYPE *datapt){  \
+  if(NAME ## Fifo_Get(datapt) == (FAIL)){  \
+    return(FAIL);                       \
+  }                                     \
+  OS_Signal(&NAME ## RoomLeft);         \
+  return(SUCCESS);                      \
+}
+// e.g.,
+// AddRingFifo(Tx,16,char, 1,0)
+// AddRingFifoPutWait(Tx,16,char, 1,0)
+
 #endif //  __FIFO_H__
->>>>>>> c04fcbc29e5c1dd4d5927ac8e56ea208d393528c
@@ -1,4 +1,6 @@
-<<<<<<< HEAD
+#ifndef LCD_H
+#define LCD_H
+
 //color constants                  red  grn  blu
 #define LCD_BLACK      0x0000   //   0,   0,   0
 #define LCD_BLUE       0x001F   //   0,   0, 255
@@ -120,297 +122,129 @@ uint16_t BSP_LCD_SwapColor(uint16_t x);
 void BSP_LCD_DrawBitmap(int16_t x, int16_t y, const uint16_t *image, int16_t w, int16_t h);
 
 
-//------------BSP_LCD_DrawCharS------------
-// Simple character draw function.  This is the same function from
-// Adafruit_GFX.c but adapted for this processor.  However, each call
-// to BSP_LCD_DrawPixel() calls setAddrWindow(), which needs to send
-// many extra data and commands.  If the background color is the same
-// as the text color, no background will be printed, and text can be
-// drawn right over existing images without covering them with a box.
-// Requires (11 + 2*size*size)*6*8 bytes of transmission (image fully on screen; textcolor != bgColor)
-// Input: x         horizontal position of the top left corner of the character, columns from the left edge
-//        y         vertical position of the top left corner of the character, rows from the top edge
-//        c         character to be printed
-//        textColor 16-bit color of the character
-//        bgColor   16-bit color of the background
-//        size      number of pixels per character pixel (e.g. size==2 prints each pixel of font as 2x2 square)
-// Output: none
-void BSP_LCD_DrawCharS(int16_t x, int16_t y, char c, int16_t textColor, int16_t bgColor, uint8_t size);
-
-
-//------------BSP_LCD_DrawChar------------
-// Advanced character draw function.  This is similar to the function
-// from Adafruit_GFX.c but adapted for this processor.  However, this
-// function only uses one call to setAddrWindow(), which allows it to
-// run at least twice as fast.
-// Requires (11 + size*size*6*8) bytes of transmission (assuming image fully on screen)
-// Input: x         horizontal position of the top left corner of the character, columns from the left edge
-//        y         vertical position of the top left corner of the character, rows from the top edge
-//        c         character to be printed
-//        textColor 16-bit color of the character
-//        bgColor   16-bit color of the background
-//        size      number of pixels per character pixel (e.g. size==2 prints each pixel of font as 2x2 square)
-// Output: none
-void BSP_LCD_DrawChar(int16_t x, int16_t y, char c, int16_t textColor, int16_t bgColor, uint8_t size);
-
-
-//------------BSP_LCD_DrawString------------
-// String draw function.
-// 13 rows (0 to 12) and 21 characters (0 to 20)
-// Requires (11 + size*size*6*8) bytes of transmission for each character
-// Input: x         columns from the left edge (0 to 20)
-//        y         rows from the top edge (0 to 12)
-//        pt        pointer to a null terminated string to be printed
-//        textColor 16-bit color of the characters
-// bgColor is Black and size is 1
-// Output: number of characters printed
-uint32_t BSP_LCD_DrawString(uint16_t x, uint16_t y, char *pt, int16_t textColor);
-
-
-//********BSP_LCD_SetCursor*****************
-// Move the cursor to the desired X- and Y-position.  The
-// next character of the next unsigned decimal will be
-// printed here.  X=0 is the leftmost column.  Y=0 is the top
-// row.
-// inputs: newX  new X-position of the cursor (0<=newX<=20)
-//         newY  new Y-position of the cursor (0<=newY<=12)
-// outputs: none
-void BSP_LCD_SetCursor(uint32_t newX, uint32_t newY);
-
-//-----------------------BSP_LCD_OutUDec-----------------------
-// Output a 32-bit number in unsigned decimal format
-// Position determined by BSP_LCD_SetCursor command
-// Input: n         32-bit number to be transferred
-//        textColor 16-bit color of the numbers
-// Output: none
-// Variable format 1-10 digits with no space before or after
-void BSP_LCD_OutUDec(uint32_t n, int16_t textColor);
-
-//-----------------------BSP_LCD_OutUDec4-----------------------
-// Output a 32-bit number in unsigned 4-digit decimal format
-// Position determined by BSP_LCD_SetCursor command
-// Input: 32-bit number to be transferred
-//        textColor 16-bit color of the numbers
-// Output: none
-// Fixed format 4 digits with no space before or after
-void BSP_LCD_OutUDec4(uint32_t n, int16_t textColor);
-
-//-----------------------BSP_LCD_OutUDec5-----------------------
-// Output a 32-bit number in unsigned 5-digit decimal format
-// Position determined by BSP_LCD_SetCursor command
-// Input: 32-bit number to be transferred
-//        textColor 16-bit color of the numbers
-// Output: none
-// Fixed format 5 digits with no space before or after
-void BSP_LCD_OutUDec5(uint32_t n, int16_t textColor);
-
-//-----------------------BSP_LCD_OutUFix2_1-----------------------
-// Output a 32-bit number in unsigned 3-digit fixed point, 0.1 resolution
-// numbers 0 to 999 printed as " 0.0" to "99.9"
-// Position determined by BSP_LCD_SetCursor command
-// Input: 32-bit number to be transferred
-//        textColor 16-bit color of the numbers
-// Output: none
-// Fixed format 4 characters with no space before or after
-void BSP_LCD_OutUFix2_1(uint32_t n, int16_t textColor);
-
-//-----------------------BSP_LCD_OutUHex2-----------------------
-// Output a 32-bit number in unsigned 2-digit hexadecimal format
-// numbers 0 to 255 printed as "00," to "FF,"
-// Position determined by BSP_LCD_SetCursor command
-// Input: 32-bit number to be transferred
-//        textColor 16-bit color of the numbers
-// Output: none
-// Fixed format 3 characters with comma after
-void BSP_LCD_OutUHex2(uint32_t n, int16_t textColor);
-
-// ------------BSP_LCD_Drawaxes------------
-// Set up the axes, labels, and other variables to
-// allow data to be plotted in a chart using the
-// functions BSP_LCD_PlotPoint() and
-// BSP_LCD_PlotIncrement().
-// Input: axisColor   16-bit color for axes, which can be produced by BSP_LCD_Color565()
-//        bgColor     16-bit color for plot background, which can be produced by BSP_LCD_Color565()
-//        xLabel      pointer to a null terminated string for x-axis (~4 character space)
-//        yLabel1     pointer to a null terminated string for top of y-axis (~3-5 character space)
-//        label1Color 16-bit color for y-axis label1, which can be produced by BSP_LCD_Color565()
-//        yLabel2     pointer to a null terminated string for bottom of y-axis (~3 character space)
-//                      if yLabel2 is empty string, no yLabel2 is printed, and yLabel1 is centered
-//        label2Color 16-bit color for y-axis label2, which can be produced by BSP_LCD_Color565()
-//        ymax        maximum value to be printed
-//        ymin        minimum value to be printed
-// Output: none
-// Assumes: BSP_LCD_Init() has been called
-void BSP_LCD_Drawaxes(uint16_t axisColor, uint16_t bgColor, char *xLabel,
-  char *yLabel1, uint16_t label1Color, char *yLabel2, uint16_t label2Color,
-  int32_t ymax, int32_t ymin);
-
-
-// ------------BSP_LCD_PlotPoint------------
-// Plot a point on the chart.  To plot several points in the
-// same column, call this function repeatedly before calling
-// BSP_LCD_PlotIncrement().  The units of the data are the
-// same as the ymax and ymin values specified in the
-// initialization function.
-// Input: data1  value to be plotted (units not specified)
-//        color1 16-bit color for the point, which can be produced by BSP_LCD_Color565()
-// Output: none
-// Assumes: BSP_LCD_Init() and BSP_LCD_Drawaxes() have been called
-void BSP_LCD_PlotPoint(int32_t data1, uint16_t color1);
-
-
-// ------------BSP_LCD_PlotIncrement------------
-// Increment the plot between subsequent calls to
-// BSP_LCD_PlotPoint().  Automatically wrap and clear the
-// column to be printed to.
-// Input: none
-// Output: none
-// Assumes: BSP_LCD_Init() and BSP_LCD_Drawaxes() have been called
-void BSP_LCD_PlotIncrement(void);
-
-//------------BSP_LCD_Message-------------------
-// Divide the LCD into two logical partitions and provide
-// an interface to output a string
-// inputs: 	device	specifies top(0) or bottom(1)
-//					line 		specifies line number (0-5)
-//                  col         specifies column number (0-20)
-// 					string	pointer to NULL-terminated ASCII string
-//  				value		16-bit number in unsigned decimal format
-// outputs: none
-void BSP_LCD_Message (int device, int line, int col, char *string, unsigned int value);
-
-
-// Initial LCD in OS
-void BSP_LCD_OutputInit(void);
-
-//------------BSP_LCD_DrawCrosshaire-------------------
-// Draw a crosshair at the given coordinates
-// an interface to output a string
-// inputs: 	x				specifies top(0) or bottom(1)
-//					y 			specifies line number (0-5)
-// outputs: none
-void BSP_LCD_DrawCrosshair(int16_t x, int16_t y, int16_t bgColor);
-=======
-//color constants                  red  grn  blu
-#define LCD_BLACK      0x0000   //   0,   0,   0
-#define LCD_BLUE       0x001F   //   0,   0, 255
-#define LCD_DARKBLUE   0x34BF   //  50, 150, 255
-#define LCD_RED        0xF800   // 255,   0,   0
-#define LCD_GREEN      0x07E0   //   0, 255,   0
-#define LCD_LIGHTGREEN 0x07EF   //   0, 255, 120
-#define LCD_ORANGE     0xFD60   // 255, 175,   0
-#define LCD_CYAN       0x07FF   //   0, 255, 255
-#define LCD_MAGENTA    0xF81F   // 255,   0, 255
-#define LCD_YELLOW     0xFFE0   // 255, 255,   0
-#define LCD_WHITE      0xFFFF   // 255, 255, 255
-#define LCD_GREY       0x8410   // 128, 128, 
-
-
-// ------------BSP_LCD_Init------------
-// Initialize the SPI and GPIO, which correspond with
-// BoosterPack pins J1.7 (SPI CLK), J2.13 (SPI CS), J2.15
-// (SPI MOSI), J2.17 (LCD ~RST), and J4.31 (LCD DC).
-// Input: none
+//------------BSP_LCD_DrawSprite------------
+// Displays a 16-bit color image stored top row first, left to right
+// (the order of the arrays in bitmaps.h), through a single address
+// window.  The image is clipped on all four sides.
+// Requires (11 + 2*w*h) bytes of transmission (assuming image fully on screen)
+// Input: x     horizontal position of the top left corner of the image, columns from the left edge
+//        y     vertical position of the top left corner of the image, rows from the top edge
+//        image pointer to a 16-bit color image, top row first
+//        w     number of pixels wide
+//        h     number of pixels tall
 // Output: none
-void BSP_LCD_Init(void);
+void BSP_LCD_DrawSprite(int16_t x, int16_t y, const uint16_t *image, int16_t w, int16_t h);
 
 
-//------------BSP_LCD_DrawPixel------------
-// Color the pixel at the given coordinates with the given color.
-// Requires 13 bytes of transmission
-// Input: x     horizontal position of the pixel, columns from the left edge
-//               must be less than 128
-//               0 is on the left, 126 is near the right
-//        y     vertical position of the pixel, rows from the top edge
-//               must be less than 128
-//               126 is near the wires, 0 is the side opposite the wires
+//------------BSP_LCD_DrawSpriteKey------------
+// Same as BSP_LCD_DrawSprite(), but pixels equal to the key color are
+// not drawn.  Each horizontal run of opaque pixels uses its own window.
+// Requires (11 + 2*n) bytes of transmission for each run of n opaque pixels
+// Input: x     horizontal position of the top left corner of the image, columns from the left edge
+//        y     vertical position of the top left corner of the image, rows from the top edge
+//        image pointer to a 16-bit color image, top row first
+//        w     number of pixels wide
+//        h     number of pixels tall
+//        key   16-bit color that is not drawn
+// Output: none
+void BSP_LCD_DrawSpriteKey(int16_t x, int16_t y, const uint16_t *image, int16_t w, int16_t h, uint16_t key);
+
+
+//------------BSP_LCD_MoveSprite------------
+// Move an opaque sprite from (oldX,oldY) to (x,y), redrawing the sprite
+// and filling only the strips of the old position that became exposed.
+// Input: oldX    horizontal position of the old top left corner
+//        oldY    vertical position of the old top left corner
+//        x       horizontal position of the new top left corner
+//        y       vertical position of the new top left corner
+//        image   pointer to a 16-bit color image, top row first
+//        w       number of pixels wide
+//        h       number of pixels tall
+//        bgColor 16-bit color of the uncovered background
+// Output: none
+void BSP_LCD_MoveSprite(int16_t oldX, int16_t oldY, int16_t x, int16_t y, const uint16_t *image, int16_t w, int16_t h, uint16_t bgColor);
+
+
+// Image compressed by tools/imgpack.py: a palette of RGB565 colors and
+// a run-length coded stream of palette indices, top row first.
+// Control byte 0x00-0x7F: (c+1) literal indices follow
+// Control byte 0x80-0xFF: the next index repeats (c&0x7F)+2 times
+typedef struct {
+  int16_t w, h;              // size of the image in pixels
+  uint16_t colors;           // number of palette entries (1 to 256)
+  const uint16_t *palette;   // RGB565 color of each index
+  uint32_t size;             // number of bytes in data[]
+  const uint8_t *data;       // run-length coded palette indices
+} LCD_PackedImage;
+
+//------------BSP_LCD_DrawPacked------------
+// Decode a packed image and stream its pixels straight into one
+// address window, without a frame buffer.  The image is clipped on
+// all four sides; pixels off the screen are decoded but not sent.
+// Requires (11 + 2*w*h) bytes of transmission (assuming image fully on screen),
+// about 250 pixels/ms with a 4 MHz SSI clock (tools/lcdbench.c)
+// Input: x     horizontal position of the top left corner of the image, columns from the left edge
+//        y     vertical position of the top left corner of the image, rows from the top edge
+//        image pointer to a packed image generated by tools/imgpack.py
+// Output: none
+void BSP_LCD_DrawPacked(int16_t x, int16_t y, const LCD_PackedImage *image);
+
+
+//------------BSP_LCD_DrawLine------------
+// Draw a line between two points with Bresenham's algorithm.  Pixels
+// that share a row (shallow lines) or a column (steep lines) are sent
+// as one run.  The line is clipped to the screen.
+// Requires 11 + 2*n bytes of transmission for each run of n pixels
+// Input: x0    horizontal position of the first end point
+//        y0    vertical position of the first end point
+//        x1    horizontal position of the second end point
+//        y1    vertical position of the second end point
 //        color 16-bit color, which can be produced by BSP_LCD_Color565()
 // Output: none
-void BSP_LCD_DrawPixel(int16_t x, int16_t y, uint16_t color);
+void BSP_LCD_DrawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
 
-
-//------------BSP_LCD_DrawFastVLine------------
-// Draw a vertical line at the given coordinates with the given height and color.
-// A vertical line is parallel to the longer side of the rectangular display
-// Requires (11 + 2*h) bytes of transmission (assuming image fully on screen)
-// Input: x     horizontal position of the start of the line, columns from the left edge
-//        y     vertical position of the start of the line, rows from the top edge
-//        h     vertical height of the line
+//------------BSP_LCD_DrawCircle------------
+// Draw the outline of a circle, sending the pixels that share a row
+// or column as one run.  The circle is clipped to the screen.
+// Input: x     horizontal position of the center
+//        y     vertical position of the center
+//        r     radius in pixels
 //        color 16-bit color, which can be produced by BSP_LCD_Color565()
 // Output: none
-void BSP_LCD_DrawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
-
+void BSP_LCD_DrawCircle(int16_t x, int16_t y, int16_t r, uint16_t color);
 
-//------------BSP_LCD_DrawFastHLine------------
-// Draw a horizontal line at the given coordinates with the given width and color.
-// A horizontal line is parallel to the shorter side of the rectangular display
-// Requires (11 + 2*w) bytes of transmission (assuming image fully on screen)
-// Input: x     horizontal position of the start of the line, columns from the left edge
-//        y     vertical position of the start of the line, rows from the top edge
-//        w     horizontal width of the line
+//------------BSP_LCD_FillCircle------------
+// Draw a filled circle as one horizontal run per row.
+// Requires (11 + 2*w) bytes of transmission for each row of width w
+// Input: x     horizontal position of the center
+//        y     vertical position of the center
+//        r     radius in pixels
 //        color 16-bit color, which can be produced by BSP_LCD_Color565()
 // Output: none
-void BSP_LCD_DrawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
-
-
-//------------BSP_LCD_FillScreen------------
-// Fill the screen with the given color.
-// Requires 33,293 bytes of transmission
-// Input: color 16-bit color, which can be produced by BSP_LCD_Color565()
-// Output: none
-void BSP_LCD_FillScreen(uint16_t color);
+void BSP_LCD_FillCircle(int16_t x, int16_t y, int16_t r, uint16_t color);
 
-
-//------------BSP_LCD_FillRect------------
-// Draw a filled rectangle at the given coordinates with the given width, height, and color.
-// Requires (11 + 2*w*h) bytes of transmission (assuming image fully on screen)
-// Input: x     horizontal position of the top left corner of the rectangle, columns from the left edge
-//        y     vertical position of the top left corner of the rectangle, rows from the top edge
-//        w     horizontal width of the rectangle
-//        h     vertical height of the rectangle
+//------------BSP_LCD_FillTriangle------------
+// Draw a filled triangle as one horizontal run per row.
+// Requires (11 + 2*w) bytes of transmission for each row of width w
+// Input: x0,y0 first corner
+//        x1,y1 second corner
+//        x2,y2 third corner
 //        color 16-bit color, which can be produced by BSP_LCD_Color565()
 // Output: none
-void BSP_LCD_FillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
-
-
-//------------BSP_LCD_Color565------------
-// Pass 8-bit (each) R,G,B and get back 16-bit packed color.
-// Input: r red value
-//        g green value
-//        b blue value
-// Output: 16-bit color
-uint16_t BSP_LCD_Color565(uint8_t r, uint8_t g, uint8_t b);
+void BSP_LCD_FillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
 
+#define LCD_POLY_MAXCORNERS 16   // largest polygon accepted by BSP_LCD_FillPolygon()
 
-//------------BSP_LCD_SwapColor------------
-// Swaps the red and blue values of the given 16-bit packed color;
-// green is unchanged.
-// Input: x 16-bit color in format B, G, R
-// Output: 16-bit color in format R, G, B
-uint16_t BSP_LCD_SwapColor(uint16_t x);
-
-
-//------------BSP_LCD_DrawBitmap------------
-// Displays a 16-bit color BMP image.  A bitmap file that is created
-// by a PC image processing program has a header and may be padded
-// with dummy columns so the data have four byte alignment.  This
-// function assumes that all of that has been stripped out, and the
-// array image[] has one 16-bit halfword for each pixel to be
-// displayed on the screen (encoded in reverse order, which is
-// standard for bitmap files).  An array can be created in this
-// format from a 24-bit-per-pixel .bmp file using the associated
-// converter program.
-// (x,y) is the screen location of the lower left corner of BMP image
-// Requires (11 + 2*w*h) bytes of transmission (assuming image fully on screen)
-// Input: x     horizontal position of the bottom left corner of the image, columns from the left edge
-//        y     vertical position of the bottom left corner of the image, rows from the top edge
-//        image pointer to a 16-bit color BMP image
-//        w     number of pixels wide
-//        h     number of pixels tall
+//------------BSP_LCD_FillPolygon------------
+// Draw a filled polygon, which may be concave, with the even-odd rule.
+// Each pair of edge crossings on a row is sent as one run.
+// Requires (11 + 2*w) bytes of transmission for each run of width w
+// Input: x     pointer to the horizontal positions of the corners
+//        y     pointer to the vertical positions of the corners
+//        n     number of corners (3 to LCD_POLY_MAXCORNERS)
+//        color 16-bit color, which can be produced by BSP_LCD_Color565()
 // Output: none
-// Must be less than or equal to 128 pixels wide by 128 pixels high
-void BSP_LCD_DrawBitmap(int16_t x, int16_t y, const uint16_t *image, int16_t w, int16_t h);
-
+void BSP_LCD_FillPolygon(const int16_t *x, const int16_t *y, int n, uint16_t color);
 
 //------------BSP_LCD_DrawCharS------------
 // Simple character draw function.  This is the same function from
@@ -560,6 +394,114 @@ void BSP_LCD_PlotPoint(int32_t data1, uint16_t color1);
 // Assumes: BSP_LCD_Init() and BSP_LCD_Drawaxes() have been called
 void BSP_LCD_PlotIncrement(void);
 
+// ------------BSP_LCD_SetScrollArea------------
+// Define the band of screen rows that BSP_LCD_Scroll() moves.
+// The rows above and below the band stay where they are.
+// BSP_LCD_SetScrollArea(0, 128) returns to the normal display.
+// Requires 10 bytes of transmission
+// Input: top    first screen row of the band (0 to 127)
+//        height number of rows in the band (1 to 128-top)
+// Output: none
+void BSP_LCD_SetScrollArea(int16_t top, int16_t height);
+
+// ------------BSP_LCD_Scroll------------
+// Scroll the band defined by BSP_LCD_SetScrollArea().  The band row
+// offset is shown on the first line of the band, and the rows above
+// it wrap around to the bottom.
+// Requires 3 bytes of transmission
+// Input: offset rows to scroll up, taken modulo the band height
+// Output: none
+void BSP_LCD_Scroll(int16_t offset);
+
+// ------------BSP_LCD_ScrollRow------------
+// Find where to draw so that something appears on a given line of
+// the scrolled band.  The drawing functions address memory rows,
+// which move with the band.
+// Input: line line of the band as seen on the screen (0 to height-1)
+// Output: y coordinate to pass to the drawing functions
+int16_t BSP_LCD_ScrollRow(int16_t line);
+
+// ------------BSP_LCD_StripInit------------
+// Set up a strip chart that fills the full width of the screen rows
+// top to top+height-1.  Time runs down the screen: each call to
+// BSP_LCD_StripPlot() scrolls the chart up by one row and draws the
+// new sample on the bottom row.  This uses the scrolling band, so it
+// cannot be combined with BSP_LCD_LogInit().
+// Input: top     first screen row of the chart (0 to 127)
+//        height  number of rows (samples) shown at a time
+//        ymin    value plotted at the left edge
+//        ymax    value plotted at the right edge
+//        bgColor 16-bit color for the chart background
+// Output: none
+void BSP_LCD_StripInit(int16_t top, int16_t height, int32_t ymin, int32_t ymax, uint16_t bgColor);
+
+// ------------BSP_LCD_StripPlot------------
+// Scroll the strip chart by one row and plot one sample on the new
+// bottom row, erasing only the oldest point that was there.
+// Requires 33 bytes of transmission
+// Input: data  value to be plotted (units of ymin and ymax)
+//        color 16-bit color for the point
+// Output: none
+// Assumes: BSP_LCD_StripInit() has been called
+void BSP_LCD_StripPlot(int32_t data, uint16_t color);
+
+// ------------BSP_LCD_LogInit------------
+// Set up a scrolling text log on lines of the 10-row text grid.
+// New lines are added at the bottom and the older ones move up.
+// This uses the scrolling band, so it cannot be combined with
+// BSP_LCD_StripInit().
+// Input: line    first text line of the log (0 to 12)
+//        lines   number of text lines in the log
+//        bgColor 16-bit color behind the text
+// Output: none
+void BSP_LCD_LogInit(int16_t line, int16_t lines, uint16_t bgColor);
+
+// ------------BSP_LCD_LogLine------------
+// Scroll the log up one text line and write a string on the bottom
+// line, padded with spaces to the full 21 characters.
+// Requires 3 + 21*(11 + 96) bytes of transmission
+// Input: string    pointer to a null terminated string
+//        textColor 16-bit color of the characters
+// Output: none
+// Assumes: BSP_LCD_LogInit() has been called
+void BSP_LCD_LogLine(char *string, int16_t textColor);
+
+// ------------BSP_LCD_SetFrameRate------------
+// Choose the frame rate timing closest to the requested refresh rate
+// and program it for normal and partial mode.  The panel can reach
+// about 31 Hz to 96 Hz.  The TE output is not wired, so drawing is not
+// synchronized to the refresh.
+// Requires 11 bytes of transmission
+// Input: hz requested refresh rate in frames per second
+// Output: refresh rate actually set, in 0.1 Hz units
+uint32_t BSP_LCD_SetFrameRate(uint32_t hz);
+
+// ------------BSP_LCD_SetPartialArea------------
+// Switch to partial display mode: only the screen rows top to
+// top+height-1 are refreshed from memory and the rest of the glass is
+// blanked.
+// Requires 6 bytes of transmission
+// Input: top    first screen row of the area (0 to 127)
+//        height number of rows in the area (1 to 128-top)
+// Output: none
+void BSP_LCD_SetPartialArea(int16_t top, int16_t height);
+
+// ------------BSP_LCD_NormalMode------------
+// Leave partial display mode and refresh the whole screen again.
+// Requires 1 byte of transmission
+// Input: none
+// Output: none
+void BSP_LCD_NormalMode(void);
+
+// Bytes sent to the LCD since reset, commands and data, counted by the
+// low level write functions.  Each byte takes 2 us on the 4 MHz bus.
+extern uint32_t BSP_LCD_Bytes;
+#define LCD_BYTE_TIME 160   // one byte on the bus in 12.5 ns units
+
+// BSP_LCD_FillRect() calls since reset that drew something, the screen
+// clears and the erasing of sprites and text among them.
+extern uint32_t BSP_LCD_Fills;
+
 
 //------------BSP_LCD_Message-------------------
 // Divide the LCD into two logical partitions and provide
@@ -582,4 +524,13 @@ uint16_t rgb24_to_rgb565(uint8_t r, uint8_t g, uint8_t b);
 //					y 			specifies line number (0-5)
 // outputs: none
 void BSP_LCD_DrawCrosshair(int16_t x, int16_t y, uint16_t bgColor);
->>>>>>> c04fcbc29e5c1dd4d5927ac8e56ea208d393528c
+
+//------------BSP_LCD_EraseCrosshair-------------------
+// Erase a crosshair by restoring the pixels that were under it
+// inputs: 	x				specifies the x coordinate (0 to 127)
+//					y 			specifies the y coordinate (0 to 127)
+//					under		returns the color of the screen at (x,y) without the crosshair
+// outputs: none
+void BSP_LCD_EraseCrosshair(int16_t x, int16_t y, uint16_t (*under)(int16_t x, int16_t y));
+
+#endif
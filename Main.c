@@ -1,5 +1,4 @@
 #include <stdint.h>
-#include <stdio.h>
 #include "PLL.h"
 #include "LCD.h"
 #include "os.h"
@@ -8,6 +7,16 @@
 #include "bitmaps.h"
 #include "FIFO.h"
 #include "PORTE.h"
+#include "widget.h"
+#include "cube.h"
+#include "board.h"
+#include "replay.h"
+#include "game.h"
+#include "UART.h"
+#include "log.h"
+#include "telemetry.h"
+#include "trace.h"
+#include "shell.h"
 #include "tm4c123gh6pm.h"
 // main picture in game setting maximum will have four threads to control the cubes,
 // on LCD screen, it can have 36 semaphores(total 36 cubes)
@@ -27,9 +36,10 @@ int state = 2;
 // Constants
 #define BGCOLOR     					LCD_BLACK
 #define CROSSSIZE            			5
+#define GAME_FRAMERATE					90	// panel refresh in Hz while playing, less visible tearing
+#define MENU_FRAMERATE					40	// panel refresh in Hz on the static menu pages
 
 //------------------Defines and Variables-------------------
-uint16_t origin[2]; // the original ADC value of x,y if the joystick is not touched
 int16_t x = 63;  // horizontal position of the crosshair, initially 63
 int16_t y = 63;  // vertical position of the crosshair, initially 63
 int16_t prevx = 63;
@@ -38,14 +48,13 @@ uint8_t select;  // joystick push
 
 #define LFSR_POLY_MASK 0xB8
 int cubeCount = 0; //
-int game_type = 0;
-// 0 -> five cubes, 1-> one cube
-int game_mode = 0;
-// use to differentiate 50, 100, 200 seconds
+// game_type: 0 -> five cubes, 1-> one cube
+// game_mode: use to differentiate 50, 100, 200 seconds
 // 0 -> 50 sec 
 // 1 -> 100 sec
 // 2 -> 200 sec
 // 3 -> infinity
+// both in game.c
 int p_game_type = 0;
 int p_game_mode = 0;
 int selector = 0; 
@@ -65,78 +74,73 @@ int sound = 1;  // 1 -> open sound, 0 -> mute
 int oneOff_0 = 0;  // use to start new panel thread
 int oneOff_1 = 0;  // use to start new game thread and protect adding too much threads
 int oneOff_2 = 0;  // use to start new setting thread
-int nrounds = 0;
-int mainY = 0;
-int mainX = 0;  
 int db_sw1 = 0;  // use to debounce 
 int db_sw2 = 0;  // use to debounce 
 int HighScore = 0; 
-int scores;
+// HUD on the bottom text row, only changed glyphs are redrawn
+WidgetType RoundsLabel, RoundsField, ScoreLabel, ScoreField;
+// settings page text, drawn once per visit and on change
+WidgetType SettingsText[8];
 //---------------------User debugging-----------------------
 
 #define TEST_TIMER 0		// Change to 1 if testing the timer
 #define TEST_PERIOD 4000000  // Defined by user
 #define PERIOD 800000  		// Defined by user
+#define FRAME_TICKS (FRAME_MS*TIME_1MS)	// one frame in OS_Time() units
+#define FRAME_MAXSTEPS 4	// fixed steps run in one frame to catch up, later frames are dropped
+#define FRAME_LOG 32		// frames kept in FrameLog[]
+#define INPUT_MAILBOX 1		// 1 reads the newest joystick sample from RxMail with LCDFree held,
+							// 0 sweeps every sample queued in RxFifo before taking LCDFree
+#define INPUT_LOAD_MS 0		// more than 0 adds a thread that holds LCDFree this long every 100 ms,
+							// to measure the input latency under load
+#define REPLAY_MODE REPLAY_OFF	// REPLAY_RECORD sends every game to UART0, REPLAY_PLAY plays games sent to UART0
+							// (exact only with CUBE_ENGINE 1, addTile threads depend on the scheduler)
+#define TELEMETRY_UART 1	// 1 sends telemetry frames to UART0 while replay does not use it, see telemetry.h
+#define LOG_DRAIN_MS 20		// the Telemetry thread sends the Log records this often, 230 bytes at most at 115200 baud
+#define TELE_MS 100			// and snapshots of the game and the kernel this often
+#define SHELL_UART 0		// 1 runs the command shell of shell.h on UART0 in place of telemetry
+#define SHELL_POLL_MS 20	// the Shell thread looks for typed bytes this often
+#define TRACE_GAME_OVER 1	// 1 dumps the kernel trace around each game over, see trace.h
 
 unsigned long Count;   		// number of times thread loops
 
 
 //--------------------------------------------------------------
 void CrossHair_Init(void){
+	uint16_t rawX, rawY;
 	BSP_LCD_FillScreen(LCD_BLACK);	// Draw a black screen
-	BSP_Joystick_Input(&origin[0], &origin[1], &select); // Initial values of the joystick, used as reference
+	BSP_Joystick_Input(&rawX, &rawY, &select); // joystick at rest, the center of its deflection
+	Game_Calibrate(rawX, rawY);
 }
 
-//******** Producer *************** 
-void Producer(void){
 #if TEST_TIMER
+//******** Heartbeat *************** 
+void Heartbeat(void){
 	PE1 ^= 0x02;	// heartbeat
 	Count++;	// Increment dummy variable			
-#else
+}
+#endif
+
+//******** Producer *************** 
+// runs in the ADC0 sequencer 1 interrupt with every joystick
+// sample, triggered by Timer0A each PERIOD (see joystick.c)
+void Producer(uint16_t rawX, uint16_t rawY){
 	// Variable to hold updated x and y values
 	int16_t newX = x;
 	int16_t newY = y;
-	int16_t deltaX = 0;
-	int16_t deltaY = 0;
-	uint16_t rawX, rawY; // To hold raw adc values
-	uint8_t select;	// To hold pushbutton status
 	rxDataType data;
-	
-	//read joystick input
-	BSP_Joystick_Input(&rawX, &rawY, &select);
-
-	//detect joystick movement in all four direction and move at a speed of 6
-	if(rawX > 3000)
-		origin[0] +=6; 
-	if(rawY < 1800)
-		origin[1] +=6; 
-	if(rawX < 1400)
-		origin[0] -=6; 
-	if(rawY > 3000)
-		origin[1] -=6; 	
-	
-	//boundary condition on all four sides of the frame
-	if(origin[0] >= 4050)
-		origin[0] =  4050;
-
-	if(origin[0] <= 50)
-		origin[0] = 50; 
 
-	if(origin[1] <= 50)
-		origin[1] = 50;  
-
-	if(origin[1] >= 3550)
-		origin[1] =  3550;	
-
-	//scale x,y from 0 - 4095 into 0 - 128
-	newX    = ( origin[0] * 128 ) / 4095;
-	newY    = ( origin[1] * 128 ) / 4095;	
+	//move the crosshair, see game.c
+	Game_Joystick(rawX, rawY, &newX, &newY);
 	
-	//store x and y into fifo
+	//store x and y into the mailbox or the fifo
 	data.x  = newX;
 	data.y  = newY;
+	data.time = OS_Time();
+#if INPUT_MAILBOX
+	RxMail_Put(data);
+#else
 	RxFifo_Put(data);
-		
 #endif
 }
 //******** display bitmap *********
@@ -174,48 +178,59 @@ uint16_t colors[20] = {
     0xF4A3  // Neon Carrot
 };
 
+// draw the 17x17 bg1 tile, or clear it to the game background
+// one address window each way instead of one per pixel
 void DisplayBitmap(uint16_t startX, uint16_t startY, int clearMode) {
     int width = 17;
     int height = 17;
-    uint32_t index = 0;
 
     if (clearMode) {
-        for (int y = startY; y < startY + height; y++) {
-            for (int x = startX; x < startX + width; x++) {
-                BSP_LCD_FillRect(x, y, 1, 1, 0x1AA6); // Clear with default color
-            }
-        }
+        BSP_LCD_FillRect(startX, startY, width, height, 0x1AA6); // Clear with default color
         return;
     }
 
-    for (int y = startY; y < startY + height; y++) {
-        for (int x = startX; x < startX + width; x++) {
-            uint16_t color = bg1[index++];
-            BSP_LCD_FillRect(x, y, 1, 1, color); // Draw pixel
-        }
-    }
+    BSP_LCD_DrawSprite(startX, startY, bg1, width, height);
 }
 
 
-uint32_t read_adc_value(void);
-#define POLY_MASK_32 0xB4BCD35C
-#define POLY_MASK_31 0x7A5BC2E3
-
-typedef unsigned int uint;
-uint32_t lfsr32, lfsr31;
+// what each cell of the 6x6 grid shows on the LCD, 0x1AA6 if no cube
+// indexed x*6+y like the cell semaphores; the crosshair restores the
+// pixels under it from here instead of painting the background over cubes
+uint16_t TileShadow[36];
+// tiles are 21 pixels tall on a 19 pixel pitch, so the bottom two rows
+// of each tile are also the top two of the cell below; what shows there
+// is whichever of the two was drawn last
+uint16_t TileLow[36];
+
+// record a tile drawn in color at cell
+void TileDrawn(uint8_t cell, uint16_t color){
+	TileShadow[cell] = color;
+	TileLow[cell] = color;
+	if(cell % 6){
+		TileLow[cell - 1] = color;	// its top rows cover the bottom of the tile above
+	}
+}
 
-int shift_lfsr(uint* lfsr, uint polynomial_mask)
-{
-    int feedback;
-    feedback = *lfsr & 1;
-    
-    if(feedback == 1)
-    {
-        *lfsr ^=  polynomial_mask;
-    }
-    return *lfsr;
+// color of the game screen at (px,py) without the crosshair
+uint16_t TileColorAt(int16_t px, int16_t py){
+	int cx = px / 21;
+	int cy = py / 19;
+	if(py >= 118){
+		return LCD_BLACK;	// HUD rows below the play field
+	}
+	if(cx > 5){
+		return 0x1AA6;		// right edge not covered by any tile
+	}
+	if(cy >= 1 && py < cy*19 + 2){
+		return TileLow[cx*6 + cy - 1];
+	}
+	if(cy <= 5){
+		return TileShadow[cx*6 + cy];
+	}
+	return 0x1AA6;
 }
 
+uint32_t read_adc_value(void);
 void init_lfsr(void)
 {
 	// constant
@@ -263,87 +278,298 @@ uint32_t read_adc_value(void) {
     return adc_value;
 }
 
-int next_rand(int bounds)
-{
-	// using constant (lfsr32) ^ seeed value to make even random number
-	return ((shift_lfsr(&lfsr32, POLY_MASK_32) ^ shift_lfsr(&lfsr31, POLY_MASK_31))&0xFFFF) % bounds;
+
+
+
+
+//******** game clock *************** 
+// The game runs in fixed FRAME_MS steps paced with OS_Time(), so the
+// rounds, the cubes and the crosshair all move on the same clock and
+// MSTime is left alone.  Each frame has a simulation phase (input, hit
+// test, game clock, cubes) and a render phase (LCD).  Only the input
+// sweep runs before LCDFree is taken.  The rules and the game clock
+// are in game.c, this file paces, draws and takes the locks.
+uint32_t FrameNext;		// OS_Time() when the next step is due
+int aimHit;				// the crosshair hit a cube this frame and stays
+
+// budget of one frame, all times in 12.5 ns units
+typedef struct {
+	uint32_t sim;		// simulation phase
+	uint32_t render;	// render phase, includes the SPI time
+	uint32_t spi;		// time on the LCD bus, BSP_LCD_Bytes*LCD_BYTE_TIME
+	uint32_t steps;		// fixed steps run, more than 1 when catching up
+	uint32_t latency;	// newest joystick sample to crosshair drawn, 0 if no new sample
+} FrameStatType;
+FrameStatType FrameLog[FRAME_LOG];	// last frames, FrameLog[FrameCount % FRAME_LOG] is next
+FrameStatType FrameWorst;	// frame with the longest sim + render
+uint32_t FrameCount;		// frames run since reset
+uint32_t FrameOverruns;		// frames with sim + render over FRAME_TICKS
+uint32_t FrameDropped;		// steps skipped because the loop fell too far behind
+uint32_t FrameContended;	// frames that had to wait for LCDFree
+uint32_t InputLatencyMax;	// longest FrameLog[].latency since reset
+uint32_t InputTime;			// OS_Time() of the newest sample aim() took
+int InputNew;				// aim() took a sample this frame
+
+#if CUBE_ENGINE
+static void cubeRender(void){
+	uint32_t i;
+	uint16_t color;
+	uint8_t cell;
+	for(i = 0; i < CubeDrawCount; i++){
+		cell = CubeDrawList[i].cell;
+		color = (CubeDrawList[i].color == CUBE_ERASE) ? 0x1AA6 : colors[CubeDrawList[i].color];
+		BSP_LCD_FillRect((cell / 6) * 21, (cell % 6) * 19, 21, 21, color);
+		TileDrawn(cell, color);
+	}
+	CubeDrawCount = 0;
 }
+#endif
 
+//******** game frame *************** 
 
+//******** replay *************** 
+uint8_t ReplayPushed;		// buttons of the replayed frame, applied after it
+uint8_t ReplayEnded;		// the end of the replayed game has been read
+uint16_t ReplayScore;		// score in the recording
+uint32_t ReplayGames;		// games replayed
+uint32_t ReplayFailed;		// games that did not end with the recorded score
+void stop();
 
+// the same effect as the switch task during a game
+static void replayButtons(void){
+	if((ReplayPushed & REPLAY_SW1) && sound){
+		GetScoreSound();
+	}
+	if(ReplayPushed & REPLAY_SW2){
+		stop();
+	}
+	ReplayPushed = 0;
+}
 
-// use to check whether we hit the cubes or not,
-// return 1-> means we hit the cube
-// return 0-> otherwise
-int update(int xcord, int ycord){
-	
-	// update xcord and ycord to 6*6 grid index
-	int newx = (xcord * 6) / 128;
-	int newy = (ycord * 66)  / 1280;
-
-	// if x and y change
-	if(mainX != newx || mainY != newy){
-		// check if this cube someone is using it 
-		// if someone using it->means we hit the cube
-		// checksemapt will return 0, if someone using it
-		if(!checkSemaPt(newx,newy)){		
-			score(newx,newy);
-			scores++;
-			// remove this cube on LCD screen
-			BSP_LCD_FillRect((newx * 21), (newy * 19), 17, 17, 0x1AA6); 
-			if(sound){
-				GetScoreSound();}
-			
-			mainX = newx;
-			mainY = newy;
-			return 1;
+// wait for a recorded game and take its seed, settings and crosshair
+static void replayBegin(void){
+	ReplayEventType e;
+	while(Replay_Read(&e) != REPLAY_BEGIN){}
+	lfsr32 = e.session.lfsr32;
+	lfsr31 = e.session.lfsr31;
+	game_type = e.session.gameType;
+	game_mode = e.session.gameMode;
+	aimX = e.session.x;
+	aimY = e.session.y;
+	ReplayPushed = 0;
+	ReplayEnded = 0;
+}
+
+// samples of the next recorded frame, up to its frame record
+// output: steps the frame ran, 0 once the game is over
+static uint32_t replayFrame(void){
+	ReplayEventType e;
+	while(1){
+		switch(Replay_Read(&e)){
+			case REPLAY_SAMPLE:
+				Game_Aim(e.x, e.y);
+				break;
+			case REPLAY_BUTTON:
+				ReplayPushed |= e.value;
+				break;
+			case REPLAY_FRAME:
+				return e.value;
+			case REPLAY_END:
+				ReplayScore = e.value;
+				ReplayEnded = 1;
+				replayButtons();
+				stop();
+				return 0;
+			default:
+				// a broken stream ends the game, and it counts as failed
+				ReplayScore = ~scores;
+				ReplayEnded = 1;
+				stop();
+				return 0;
 		}
-		
-		mainX = newx;
-		mainY = newy;
+	}
+}
 
+// check the score once a replayed game is over
+static void replayEnd(void){
+	ReplayEventType e;
+	if(!ReplayEnded){
+		while(Replay_Read(&e) < REPLAY_BEGIN){}
+		ReplayScore = (e.type == REPLAY_END) ? e.value : ~scores;
+	}
+	ReplayGames++;
+	if(ReplayScore != (uint16_t)scores){
+		ReplayFailed++;
 	}
-	return 0;
 }
 
+// joystick samples since the last frame and the cells crossed from
+// each one to the next
+// input: steps the frame is due to run
+// output: steps to run, from the recording when one is replayed
+static uint32_t aim(uint32_t steps){
+#if INPUT_MAILBOX
+	// the newest sample only, the cells crossed since the last one are
+	// swept on a straight line
+	static rxMailType mail;
+	InputNew = (RxMail_Get(&mail) != 0);
+	if(InputNew){
+		InputTime = mail.data.time;
+		if(ReplayMode != REPLAY_PLAY){
+			Game_Aim(mail.data.x, mail.data.y);
+			Replay_Sample(mail.data.x, mail.data.y);
+		}
+	}
+#else
+	rxDataType data;
+	// the Producer runs every 10 ms, about two samples per frame
+	InputNew = 0;
+	while(RxFifo_Size()){
+		RxFifo_Get(&data);
+		InputNew = 1;
+		InputTime = data.time;
+		if(ReplayMode != REPLAY_PLAY){
+			Game_Aim(data.x, data.y);
+			Replay_Sample(data.x, data.y);
+		}
+	}
+#endif
+	if(ReplayMode == REPLAY_PLAY){
+		steps = replayFrame();
+	}
+	return steps;
+}
 
-//******** Consumer *************** 
-void Consumer(void){
-	
-	while(state == 1){	
+#if INPUT_LOAD_MS
+// holds LCDFree INPUT_LOAD_MS every 100 ms, like a page or a cube
+// thread that keeps the LCD too long
+void Loader(void){
+	uint32_t t;
+	while(1){
+		OS_Sleep(100);
+		OS_Wait(&LCDFree);
+		t = OS_Time();
+		while(OS_TimeDifference(t, OS_Time()) < INPUT_LOAD_MS*TIME_1MS){}
+		OS_Signal(&LCDFree);
+	}
+}
+#endif
 
-		rxDataType dataC;
-		RxFifo_Get(&dataC);
 
-		// grab semaphore 
-		OS_Wait(&LCDFree);
-		// if we're not in gaming state
-		if(state != 1){
-			// release lock
-			OS_Signal(&LCDFree);
-			break;
-		} 
-		// if we doesn't hit the cube
-		if(!update(dataC.x, dataC.y)){
-			// erase crosshair
-			BSP_LCD_DrawCrosshair(prevx, prevy, 0x1AA6);
-			// draw new crosshair
-			BSP_LCD_DrawCrosshair(dataC.x, dataC.y, LCD_WHITE);
-			prevx = dataC.x;
-			prevy = dataC.y;
-		}	
+static void render(void){
+	uint8_t cell;
+	for(cell = 0; HitCells; cell++){
+		if(HitCells & BOARD_BIT(cell)){
+			BSP_LCD_FillRect((cell / 6) * 21, (cell % 6) * 19, 17, 17, 0x1AA6);
+			TileShadow[cell] = 0x1AA6;	// the middle only, the cube engine erases the rest
+			HitCells &= ~BOARD_BIT(cell);
+		}
+	}
+#if CUBE_ENGINE
+	cubeRender();
+#endif
+	// if we doesn't hit the cube
+	if(!aimHit){
+		// erase crosshair, putting back whatever it covered
+		BSP_LCD_EraseCrosshair(prevx, prevy, TileColorAt);
+		// draw new crosshair
+		BSP_LCD_DrawCrosshair(aimX, aimY, LCD_WHITE);
+		prevx = aimX;
+		prevy = aimY;
+	}
+	// labels are drawn once, the fields only when a digit changes
+	Widget_Label(&RoundsLabel, "X > ");
+	Widget_Number(&RoundsField, nrounds);
+	Widget_Label(&ScoreLabel, "s > ");
+	Widget_Number(&ScoreField, scores);
+}
 
-		OS_Signal(&LCDFree);
+// sleep until the next step is due, then count the steps to run
+// output: 1 normally, up to FRAME_MAXSTEPS after a long frame
+static uint32_t waitFrame(void){
+	int32_t left = (int32_t)(FrameNext - OS_Time());
+	uint32_t steps = 0, late;
+	if(left >= TIME_1MS){
+		OS_Sleep(left / TIME_1MS);
+	}
+	while((int32_t)(FrameNext - OS_Time()) > 0){
 		OS_Suspend();
 	}
-	// grab sempahore again to erase crosshair
+	do{
+		FrameNext += FRAME_TICKS;
+		steps++;
+	}while((steps < FRAME_MAXSTEPS) && ((int32_t)(OS_Time() - FrameNext) >= 0));
+	// still behind, drop the rest instead of running ever longer frames
+	if((int32_t)(OS_Time() - FrameNext) >= 0){
+		late = (OS_Time() - FrameNext) / FRAME_TICKS + 1;
+		FrameNext += late * FRAME_TICKS;
+		FrameDropped += late;
+		Log2(LOG_FRAME_DROP, FrameCount, late);
+	}
+	return steps;
+}
+
+static void recordFrame(uint32_t sim, uint32_t render, uint32_t bytes, uint32_t steps, uint32_t latency){
+	FrameStatType *f = &FrameLog[FrameCount % FRAME_LOG];
+	f->latency = latency;
+	if(latency > InputLatencyMax){
+		InputLatencyMax = latency;
+	}
+	f->sim = sim;
+	f->render = render;
+	f->spi = bytes * LCD_BYTE_TIME;
+	f->steps = steps;
+	if(sim + render > FRAME_TICKS){
+		FrameOverruns++;
+		Log3(LOG_FRAME_LATE, FrameCount, sim, render);
+	}
+	if(sim + render > FrameWorst.sim + FrameWorst.render){
+		FrameWorst = *f;
+	}
+	FrameCount++;
+}
+
+// one frame: pace, simulate, render and measure
+static void frame(void){
+	uint32_t steps, i, t0, t1, t2, bytes, input;
+	steps = waitFrame();
+	t0 = OS_Time();
+#if !INPUT_MAILBOX
+	steps = aim(steps);		// every queued sample, too long to sweep with the lock held
+#endif
+	input = OS_TimeDifference(t0, OS_Time());
+	if(LCDFree.Value <= 0){
+		FrameContended++;	// a cube thread or a page still holds the LCD
+	}
 	OS_Wait(&LCDFree);
-	// earse cross hair to background colors
-	BSP_LCD_DrawCrosshair(prevx, prevy, 0x1AA6);
-	// release lcd lock
+	if(state != 1){
+		OS_Signal(&LCDFree);
+		return;
+	}
+	t0 = OS_Time();
+	bytes = BSP_LCD_Bytes;
+#if INPUT_MAILBOX
+	steps = aim(steps);		// the newest sample, waiting for LCDFree did not age it
+#endif
+	aimHit = Game_Update();
+	for(i = 0; i < steps; i++){
+		Game_Step();
+	}
+	t1 = OS_Time();
+	render();
+	t2 = OS_Time();
+	bytes = BSP_LCD_Bytes - bytes;
 	OS_Signal(&LCDFree);
-	// kill this thread to prevent stack overflow
-	OS_Kill();
+	recordFrame(input + OS_TimeDifference(t0, t1), OS_TimeDifference(t1, t2), bytes, steps,
+		InputNew ? OS_TimeDifference(InputTime, t2) : 0);
+	if(aimHit && sound){
+		GetScoreSound();
+	}
+	// buttons pushed during the frame take effect after it
+	Replay_Frame(steps);
+	if(ReplayMode == REPLAY_PLAY){
+		replayButtons();
+	}
 }
 
 int tt = 0;
@@ -359,6 +585,7 @@ void addTile() {
 	int initial = 0;
 	int rands = next_rand(19); // randomly choose one color from 20 options
 	int color = colors[rands];
+	uint32_t wake;
 
 	while(state == 1){
 		worked = 0; // use to determine if we find a way to move 
@@ -414,9 +641,11 @@ void addTile() {
 			// if it's not the first time generating cube, remove the previous cube
 			else{
 				BSP_LCD_FillRect((x * 21), (y * 19), 21, 21, 0x1AA6);
+				TileDrawn(x*6 + y, 0x1AA6);
 			}
 			// draw new cube
 			BSP_LCD_FillRect((xnew * 21), (ynew * 19), 21, 21, color);
+			TileDrawn(xnew*6 + ynew, color);
 		
 		}
 		OS_Signal(&LCDFree);
@@ -427,8 +656,11 @@ void addTile() {
 	  	rands = (rands + 1)% 20;
 		color = colors[rands];
 	
-		// put this thread to sleep
-		OS_Sleep(3000);
+		// wait CUBE_MOVE_MS of game time
+		wake = GameMs + CUBE_MOVE_MS;
+		while(state == 1 && (int32_t)(GameMs - wake) < 0){
+			OS_Sleep(FRAME_MS);
+		}
 
 	}
 	// if state != 1, do following things or cube being hit
@@ -446,6 +678,7 @@ void addTile() {
 	// 這表示畫面上可能還留有這顆 cube 的圖形，但這個 thread 即將結束，因此要清除它。
 	if(state == 1 && initial > 0){
 		BSP_LCD_FillRect((x * 21), (y * 19)+1, 21, 21, 0x1AA6);
+		TileDrawn(x*6 + y, 0x1AA6);
 	}
 	OS_Signal(&LCDFree);
 		
@@ -472,6 +705,10 @@ void stop(){
 		if(scores > HighScore){
 			HighScore = scores;
 		}
+		Log3(LOG_GAME_OVER, scores, HighScore, GameMs);
+#if TRACE_GAME_OVER
+		Trace_Trigger(scores);	// the cube threads see state 0 and kill themselves
+#endif
 		// play gameover sound
 		if(sound)
 			PlayGameOverSound();
@@ -480,8 +717,25 @@ void stop(){
 
 
 
+// "  n" as sprintf(s, "  %d", n) wrote it, without the formatter's stack
+static void decimal(char *s, uint32_t n){
+	char digits[10];
+	int i = 0;
+	*s++ = ' ';
+	*s++ = ' ';
+	do{
+		digits[i++] = '0' + n % 10;
+		n /= 10;
+	}while(n);
+	while(i){
+		*s++ = digits[--i];
+	}
+	*s = 0;
+}
+
 void panel(){
 	OS_Wait(&LCDFree);
+	BSP_LCD_SetFrameRate(MENU_FRAMERATE);
 	BSP_LCD_FillScreen(LCD_BLACK);
 	OS_Signal(&LCDFree);
 	int y = 0;
@@ -498,11 +752,11 @@ void panel(){
 		// draw every option
 		BSP_LCD_String(3/2, 4, "Highest Score");
 		//BSP_LCD_Value(2, 8, 430);
-		sprintf(HighScoreStr, "  %d", HighScore);
+		decimal(HighScoreStr, HighScore);
   		BSP_LCD_String(2, 8, HighScoreStr);	
 
 		BSP_LCD_String (5, 6, "New Score");
-		sprintf(newScoreStr, "  %d", scores);
+		decimal(newScoreStr, scores);
   		BSP_LCD_String(6, 8, newScoreStr);
 		//BSP_LCD_Value(6, 8, 234);
 		BSP_LCD_String(9, 7, "Settings");	
@@ -542,10 +796,17 @@ void panel(){
 
 void settings(){
 	OS_Wait(&LCDFree);
+	BSP_LCD_SetFrameRate(MENU_FRAMERATE);
 	BSP_LCD_FillScreen(LCD_BLACK);
 	OS_Signal(&LCDFree);
 	int y = 0;
 	int prevy =0;
+	int i;
+	// line of each settings entry, the screen was just cleared
+	const uint8_t rows[8] = {1, 3, 4, 5, 6, 8, 9, 11};
+	for(i = 0; i < 8; i++){
+		Widget_Init(&SettingsText[i], 7, rows[i], 14, LCD_WHITE, LCD_BLACK);
+	}
   	while(state == 2){
 		
 		OS_Wait(&LCDFree);
@@ -555,21 +816,21 @@ void settings(){
 		{
 			OS_Signal(&LCDFree);
 			break;}
+		// widgets skip every glyph that is already on the screen
 		if(sound){
-			BSP_LCD_String(1, 7, "Sound  On");
+			Widget_Label(&SettingsText[0], "Sound  On");
 		}else{
-			BSP_LCD_String(1, 7, "Sound Off");		
+			Widget_Label(&SettingsText[0], "Sound Off");		
 		}
 	
-		//BSP_LCD_String(2, 7, "100 - Forge");	
-		BSP_LCD_String(3, 7, "50 - Trial");
-		BSP_LCD_String(4, 7, "100 - Forge");	
-		BSP_LCD_String(5, 7, "200 - Dominion");
-		BSP_LCD_String(6, 7, "~~~ - Endurance");
+		Widget_Label(&SettingsText[1], "50 - Trial");
+		Widget_Label(&SettingsText[2], "100 - Forge");	
+		Widget_Label(&SettingsText[3], "200 - Dominion");
+		Widget_Label(&SettingsText[4], "~~~ - Endurance");
 	
-		BSP_LCD_String(8, 7, "five");
-		BSP_LCD_String(9, 7, "Solus");	
-		BSP_LCD_String(11, 7, "Start Game");	
+		Widget_Label(&SettingsText[5], "five");
+		Widget_Label(&SettingsText[6], "Solus");	
+		Widget_Label(&SettingsText[7], "Start Game");	
 
 		// draw little cubes to corresponding line
 		// selector = 0 → y = 10 (option 1) 10 pixels apart
@@ -610,6 +871,9 @@ void SW1Push(void){
 		return; // the time is too close, ignore behavior
 	}
 	
+	if(state == 1){
+		Replay_Press(REPLAY_SW1);
+	}
 	// if sound open-> play sound
 	if(sound){
 		GetScoreSound();
@@ -671,6 +935,9 @@ void SW2Push(void){
 			// sound on/off
 			case 0:
 				sound ^= 1;
+				if(!sound){
+					Sound_Stop();   // mute what is still queued
+				}
 				break;
 			// game mode 0-> 50sec, 1 ->100 sec
 			case 2:
@@ -694,6 +961,7 @@ void SW2Push(void){
 
 	// if we're in game right now
 	if(state == 1 && oneOff_1){
+		Replay_Press(REPLAY_SW2);
 		stop();
 	}
 }
@@ -703,6 +971,7 @@ void SW2Push(void){
 
 int xv = 0;
 void Updater(){
+	ReplaySessionType session;
 	
 	while(1){
 		
@@ -710,19 +979,31 @@ void Updater(){
 			
 			// we want to start new game 
 			if(!oneOff_1){
+				// a replayed game brings its own seed, settings and crosshair
+				if(ReplayMode == REPLAY_PLAY){
+					replayBegin();
+				}
 				// checking if this semaphore another threads are waiting 
 				// return this lock waiting count
 				// if someone is waiting, infinite loop
 				while(GetNumberOfWaitingThreads(&LCDFree) != 0){} 
 				// grab the lock
 				OS_Wait(&LCDFree);
+				BSP_LCD_SetFrameRate(GAME_FRAMERATE);
 				// draw blue background in gaming 
 				BSP_LCD_FillRect(0,0, 128, 118,  0x1AA6); 
+				for(int i = 0; i < 36; i++){
+					TileDrawn(i, 0x1AA6);
+				}
 				// finish drawing
 				OS_Signal(&LCDFree);
+				// the panel or settings page cleared the HUD row
+				Widget_Invalidate(&RoundsLabel);
+				Widget_Invalidate(&RoundsField);
+				Widget_Invalidate(&ScoreLabel);
+				Widget_Invalidate(&ScoreField);
 				OS_InitSemaphore(&CubeCnt, 1); // ***can initial in start() ?
-				OS_InitSemaphores();  // initialize 36 semaphores for lcd
-				scores = 0;
+				OS_InitBoard();  // release the 36 cells of the grid
 				// grab semaphore to set cubecount
 				OS_Wait(&CubeCnt);
 				cubeCount = 0;
@@ -730,27 +1011,37 @@ void Updater(){
 				// release semaphore
 				// ***if our game type is solus, what about five cubes?
 				// we add it more cubes after initialization game in else part
+				session.lfsr32 = lfsr32;
+				session.lfsr31 = lfsr31;
+				session.gameType = game_type;
+				session.gameMode = game_mode;
+				session.x = aimX;
+				session.y = aimY;
+				Replay_Begin(&session);
+				// score, rounds, the game clock and the cube engine
+				Game_Start();
+				Log3(LOG_GAME_START, game_type, game_mode, lfsr31);
+#if !CUBE_ENGINE
 				if(game_type == 1){
 					OS_AddThread(&addTile,128,1);
 				}
+#endif
 				RxFifo_Init();
-				OS_AddThread(&Consumer,128,1);
-				if(game_mode == 0){nrounds = 50;}
-				if(game_mode == 1){nrounds = 100;}
-				if(game_mode == 2){nrounds = 200;}
-				BeginningSound();
+				FrameNext = OS_Time() + FRAME_TICKS;
+				if(sound){
+					BeginningSound();
+				}
 				oneOff_1++;
 
 				OS_Suspend();
 			}
 			// execution of game 
 			else{
-				// if we exceed 0.5 sec
-				if(OS_MsTime() > 500){
-					OS_ClearMsTime(); // clear ms time to 0 to reset
-					nrounds--;		  // deduct nround every 0.5 sec
-				}
-				//ex: if we have 50 nrounds, it weill become 0 after 25 seconds
+#if CUBE_ENGINE
+				OS_Wait(&CubeCnt);
+				cubeCount = Cube_Count();
+				OS_Signal(&CubeCnt);
+#else
 				// grab semaphore once we need to change value to cubeCount
 				OS_Wait(&CubeCnt);
 				// keep checking if cubecount < 4 and game type is five cubes
@@ -761,29 +1052,39 @@ void Updater(){
 				}
 				// release semaphore 
 				OS_Signal(&CubeCnt);
-				// grab semaphore to draw things on LCD
-				OS_Wait(&LCDFree);
-				BSP_LCD_Message (1, 0, 1, "X > ",  nrounds);
-				BSP_LCD_Message (1, 0, 13, "s > ", scores);	
-				// release semaphore
-				OS_Signal(&LCDFree);
+#endif
+				// sleeps until the frame is due, then simulates and draws
+				frame();
 				// if nrounds end and game mode not equal to infinity		
-				if(nrounds == 0 && game_mode != 3){
+				if(Game_Over()){
 					stop();
 				}
 			}
 		
 			OS_Suspend();
 		}
+		// a game just ended, erase the crosshair, putting back whatever it covered
+		if(oneOff_1 == 1){
+			Replay_End(scores);
+			if(ReplayMode == REPLAY_PLAY){
+				replayEnd();
+			}
+			OS_Wait(&LCDFree);
+			BSP_LCD_EraseCrosshair(prevx, prevy, TileColorAt);
+			OS_Signal(&LCDFree);
+			oneOff_1++;
+		}
 	
 		if(state == 2 && oneOff_2 == 0){
 			while(GetNumberOfWaitingThreads(&LCDFree) != 0){}
 			OS_AddThread(&settings,128,1);
+			Log1(LOG_STATE, state);
 			oneOff_2++;
 		}
 		if(state == 0 && oneOff_0 == 0){
 			while(GetNumberOfWaitingThreads(&LCDFree) != 0){}
 			OS_AddThread(&panel,128,1); 
+			Log1(LOG_STATE, state);
 			oneOff_0++;
 		}	
 	
@@ -791,14 +1092,104 @@ void Updater(){
 	}
 }
 
+// the game as the other threads left it, read without a lock: a snapshot
+// may mix two frames, the next one 100 ms later will not
+static void gameSnapshot(TeleGameType *g){
+	g->ms = OS_MsTime();
+	g->state = state;
+	g->gameType = game_type;
+	g->gameMode = game_mode;
+	g->score = scores;
+	g->highScore = HighScore;
+	g->rounds = nrounds;
+	g->cubes = cubeCount;
+}
+
+static void teleGame(uint32_t ms){
+	static TeleGameType g;		// static, thread stacks are 400 bytes
+	gameSnapshot(&g);
+	g.ms = ms;
+	Telemetry_Send(TELE_GAME, &g, sizeof(g));
+}
+
+static void teleKernel(uint32_t ms){
+	static TeleKernelType k;
+	static OSThreadType list[TELE_THREADS_MAX];
+	k.ms = ms;
+	k.threads = OS_Threads(list, TELE_THREADS_MAX);
+	k.lcdValue = LCDFree.Value;
+	k.lcdWaiting = LCDFree.waitingCount;
+	k.lcdWaits = LCDFree.waits;
+	k.cubeValue = CubeCnt.Value;
+	k.cubeWaiting = CubeCnt.waitingCount;
+	k.cubeWaits = CubeCnt.waits;
+	k.teleDropped = TeleStats.dropped;
+	k.logLost = LogStats.lost;
+	k.rxDropped = UARTStats.rxDropped;
+	Telemetry_Send(TELE_KERNEL, &k, sizeof(k));
+}
+
+// the only writer of UART0: Log records and a frozen kernel trace every
+// LOG_DRAIN_MS and the snapshots every TELE_MS, whatever does not fit
+// waits (Log, trace) or is dropped and counted (snapshots)
+void Telemetry(void){
+	uint32_t dropped = 0, ms, last = OS_MsTime();
+	while(1){
+		if(UARTStats.rxDropped != dropped){
+			Log1(LOG_UART_DROP, UARTStats.rxDropped - dropped);
+			dropped = UARTStats.rxDropped;
+		}
+		Log_Drain();
+		Trace_Drain();
+		ms = OS_MsTime();
+		if(ms - last >= TELE_MS){
+			last = ms;
+			teleGame(ms);
+			teleKernel(ms);
+			Telemetry_Threads(ms);
+		}
+		OS_Sleep(LOG_DRAIN_MS);
+	}
+}
+
+// the command shell, the only writer of UART0 when it runs: a command
+// typed at a terminal gets its reply, see shell.h
+void Shell(void){
+	static char in[16];
+	uint32_t i, n;
+	Shell_Init(&gameSnapshot);
+	while(1){
+		n = UART_Read(in, sizeof(in));
+		for(i = 0; i < n; i++){
+			Shell_Input(in[i]);
+		}
+		if(n == 0){
+			OS_Sleep(SHELL_POLL_MS);
+		}
+	}
+}
+
 // entry point
 void start(){
 	state = 0;
 	OS_InitSemaphore(&LCDFree, 1);
 	OS_InitSemaphore(&CubeCnt, 1);
+	// HUD: "X > " rounds left in columns 1-8, "s > " score in columns 13-20
+	Widget_Init(&RoundsLabel, 1, 12, 4, LCD_WHITE, LCD_BLACK);
+	Widget_Init(&RoundsField, 5, 12, 4, LCD_WHITE, LCD_BLACK);
+	Widget_Init(&ScoreLabel, 13, 12, 4, LCD_WHITE, LCD_BLACK);
+	Widget_Init(&ScoreField, 17, 12, 4, LCD_WHITE, LCD_BLACK);
 	OS_AddThread(&Updater,128,1); // thread always in the system
 	OS_AddSW1Task(&SW1Push, 4);   // add interupt thread
 	OS_AddSW2Task(&SW2Push, 4);	
+#if INPUT_LOAD_MS
+	OS_AddThread(&Loader,128,1);
+#endif
+#if SHELL_UART && (REPLAY_MODE == REPLAY_OFF)
+	OS_AddThread(&Shell,128,5);		// lowest priority
+#elif TELEMETRY_UART && (REPLAY_MODE == REPLAY_OFF)
+	OS_AddThread(&Telemetry,128,5);	// lowest priority
+#endif
 	
 
 }
@@ -809,16 +1200,23 @@ int main(void){
 #if TEST_TIMER
 	PortE_Init();       // profile user threads
 	Count = 0;
-	OS_AddPeriodicThread(&Producer, TEST_PERIOD, 1);
+	OS_AddPeriodicThread(&Heartbeat, TEST_PERIOD, 1);
 	while(1){}
 #else
 	OS_Init(); 
+	Log_Init();            // calls cost a few cycles from here on
+	Trace_Init();          // the kernel records its events from here on
 	Sound_Init();
   	BSP_LCD_Init();        // initialize LCD
 	BSP_Joystick_Init();   // initialize Joystick
   	CrossHair_Init();      
 	RxFifo_Init();
-	OS_AddPeriodicThread(&Producer,PERIOD, 1);
+	RxMail_Init();
+#if (REPLAY_MODE != REPLAY_OFF) || TELEMETRY_UART || SHELL_UART
+	UART_Init();           // recordings, telemetry or the shell use UART0
+#endif
+	Replay_Init(REPLAY_MODE);
+	BSP_Joystick_InitTimed(&Producer, PERIOD, 1);
 	
   	init_lfsr();
 	start();
@@ -0,0 +1,363 @@
+// ST7735Sim.c
+// Host-side model of the ST7735 controller for LCD.c built with -DLCD_SIM.
+// Only the part of the command set that the driver relies on to put
+// pixels on the glass is decoded: CASET and RASET set the address
+// window, RAMWR starts a pixel stream that fills the window left to
+// right, top to bottom, and wraps back to the top like the real part.
+// VSCRDEF and VSCSAD are applied when the image is read back, the way
+// the panel scans its memory out through the scroll registers, and so
+// is the partial area set by PTLAR/PTLON.  FRMCTR1/FRMCTR3 only set the
+// refresh rate reported by ST7735Sim_FrameRate().  The first
+// SIM_TRACE_SIZE commands after ST7735Sim_TraceClear() are recorded
+// with their arguments, so a test can check the exact sequence.
+// All other commands and their arguments are counted and ignored.
+// Pixel words are kept exactly as sent, so snapshots interpret them as
+// the 5-6-5 values produced by BSP_LCD_Color565().
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "ST7735Sim.h"
+
+#define CASET  0x2A
+#define RASET  0x2B
+#define RAMWR  0x2C
+#define VSCRDEF 0x33
+#define VSCSAD 0x37
+#define PTLON  0x12
+#define NORON  0x13
+#define PTLAR  0x30
+#define FRMCTR1 0xB1
+#define FRMCTR3 0xB3
+#define FOSC   625000              // oscillator frequency of the ST7735R
+
+static uint16_t Gram[SIM_GRAM_HEIGHT][SIM_GRAM_WIDTH];
+static SimStatsType Stats;
+static uint32_t Clock = 4000000;   // SSI2 bit rate set up by commonInit()
+
+static uint8_t Command;            // last command byte received
+static uint8_t Args[6];            // arguments collected so far
+static uint32_t ArgCount;          // data bytes received since the command
+static uint16_t XStart, XEnd, YStart, YEnd;
+static uint16_t Col, Row;          // RAMWR address counter
+static uint8_t PixelHigh;          // first byte of a pixel word
+static uint16_t Tfa, Vsa, Ssa;     // top fixed rows, scrolling rows, scroll start
+static uint8_t Frame[2][3];        // RTNA, FPA, BPA for normal and partial mode
+static uint16_t PartialStart, PartialEnd;
+static int Partial;                // 1 between PTLON and NORON
+static SimTraceType Trace[SIM_TRACE_SIZE];
+static uint32_t TraceCount;
+
+void ST7735Sim_Reset(void){
+  memset(Gram, 0, sizeof(Gram));
+  Command = 0;
+  ArgCount = 0;
+  XStart = 0; XEnd = SIM_GRAM_WIDTH - 1;
+  YStart = 0; YEnd = SIM_GRAM_HEIGHT - 1;
+  Col = Row = 0;
+  Tfa = 0; Vsa = SIM_GRAM_HEIGHT; Ssa = 0;
+  Frame[0][0] = Frame[1][0] = 0x01;  // reset values, about 60 Hz
+  Frame[0][1] = Frame[1][1] = 0x2C;
+  Frame[0][2] = Frame[1][2] = 0x2D;
+  PartialStart = 0; PartialEnd = SIM_GRAM_HEIGHT - 1;
+  Partial = 0;
+  TraceCount = 0;
+  ST7735Sim_ClearStats();
+}
+
+void ST7735Sim_Command(uint8_t c){
+  Stats.commands++;
+  Command = c;
+  ArgCount = 0;
+  if(TraceCount < SIM_TRACE_SIZE){
+    Trace[TraceCount].command = c;
+    Trace[TraceCount].count = 0;
+  }
+  TraceCount++;
+  if(c == PTLON){
+    Partial = 1;
+  }else if(c == NORON){
+    Partial = 0;
+  }
+  if(c == RAMWR){
+    Col = XStart;
+    Row = YStart;
+  }
+}
+
+// store one pixel word and advance the address counter inside the window
+static void writePixel(uint16_t color){
+  if((Col < SIM_GRAM_WIDTH) && (Row < SIM_GRAM_HEIGHT)){
+    Gram[Row][Col] = color;
+  }
+  Stats.pixels++;
+  if(Col < XEnd){
+    Col++;
+  }else{
+    Col = XStart;
+    Row = (Row < YEnd) ? Row + 1 : YStart;
+  }
+}
+
+void ST7735Sim_Data(uint8_t d){
+  Stats.data++;
+  if((TraceCount > 0) && (TraceCount <= SIM_TRACE_SIZE)){
+    SimTraceType *t = &Trace[TraceCount - 1];
+    if(t->count < SIM_TRACE_ARGS){
+      t->args[t->count] = d;
+    }
+    t->count++;
+  }
+  switch(Command){
+    case CASET:
+    case RASET:
+      if(ArgCount < 4){
+        Args[ArgCount] = d;
+      }
+      if(ArgCount == 3){
+        if(Command == CASET){
+          XStart = (Args[0]<<8)|Args[1];
+          XEnd   = (Args[2]<<8)|Args[3];
+        }else{
+          YStart = (Args[0]<<8)|Args[1];
+          YEnd   = (Args[2]<<8)|Args[3];
+          Stats.windows++;
+        }
+      }
+      break;
+    case VSCRDEF:
+      if(ArgCount < 6){
+        Args[ArgCount] = d;
+      }
+      if(ArgCount == 5){
+        Tfa = (Args[0]<<8)|Args[1];
+        Vsa = (Args[2]<<8)|Args[3];  // the bottom fixed rows are the rest
+        if((Vsa == 0) || (Tfa + Vsa > SIM_GRAM_HEIGHT)){
+          Tfa = 0; Vsa = SIM_GRAM_HEIGHT;  // invalid definition, scroll nothing
+        }
+      }
+      break;
+    case FRMCTR1:
+    case FRMCTR3:
+      if(ArgCount < 3){              // FRMCTR3 repeats them for line inversion
+        Frame[Command == FRMCTR3][ArgCount] = d;
+      }
+      break;
+    case PTLAR:
+      if(ArgCount < 4){
+        Args[ArgCount] = d;
+      }
+      if(ArgCount == 3){
+        PartialStart = (Args[0]<<8)|Args[1];
+        PartialEnd   = (Args[2]<<8)|Args[3];
+      }
+      break;
+    case VSCSAD:
+      if(ArgCount == 0){
+        Args[0] = d;
+      }else if(ArgCount == 1){
+        Ssa = (Args[0]<<8)|d;
+      }
+      break;
+    case RAMWR:
+      if(ArgCount & 1){
+        writePixel((PixelHigh<<8)|d);  // most significant byte first
+      }else{
+        PixelHigh = d;
+      }
+      break;
+    default:
+      break;
+  }
+  ArgCount++;
+}
+
+void ST7735Sim_Delay(uint32_t ms){
+  Stats.delayms += ms;
+}
+
+void ST7735Sim_SetClock(uint32_t hz){
+  if(hz){
+    Clock = hz;
+  }
+}
+
+void ST7735Sim_Stats(SimStatsType *stats){
+  *stats = Stats;
+}
+
+void ST7735Sim_ClearStats(void){
+  memset(&Stats, 0, sizeof(Stats));
+}
+
+uint32_t ST7735Sim_BusTime(void){
+  uint64_t bits = 8*(uint64_t)(Stats.commands + Stats.data);
+  return (uint32_t)((bits*1000000 + Clock/2)/Clock);
+}
+
+uint16_t ST7735Sim_GetPixel(int16_t x, int16_t y){
+  int32_t line, start;
+  if((x < 0) || (x >= SIM_WIDTH) || (y < 0) || (y >= SIM_HEIGHT)) return 0;
+  line = y + SIM_ROWSTART;
+  if(Partial && ((line < PartialStart) || (line > PartialEnd))){
+    return 0;                      // outside the partial area the glass is blank
+  }
+  if((line >= Tfa) && (line < Tfa + Vsa)){
+    // lines of the scrolling band start at memory row Ssa and wrap
+    start = ((int32_t)Ssa - Tfa)%Vsa;
+    if(start < 0) start = start + Vsa;
+    line = Tfa + (start + line - Tfa)%Vsa;
+  }
+  return Gram[line][x + SIM_COLSTART];
+}
+
+uint32_t ST7735Sim_FrameRate(void){
+  uint32_t d = (2*(Frame[Partial][0]&0x0F) + 40)*(160 + Frame[Partial][1] + Frame[Partial][2]);
+  return (10*FOSC + d/2)/d;
+}
+
+void ST7735Sim_TraceClear(void){
+  TraceCount = 0;
+}
+
+uint32_t ST7735Sim_TraceCount(void){
+  return TraceCount;
+}
+
+const SimTraceType *ST7735Sim_TraceGet(uint32_t i){
+  if((i >= TraceCount) || (i >= SIM_TRACE_SIZE)) return NULL;
+  return &Trace[i];
+}
+
+// expand one visible pixel to 8-bit red, green, blue
+static void rgb888(int16_t x, int16_t y, uint8_t *rgb){
+  uint16_t c = ST7735Sim_GetPixel(x, y);
+  rgb[0] = ((c>>11)&0x1F)*255/31;
+  rgb[1] = ((c>>5)&0x3F)*255/63;
+  rgb[2] = (c&0x1F)*255/31;
+}
+
+int ST7735Sim_SavePPM(const char *path){
+  FILE *f = fopen(path, "wb");
+  uint8_t rgb[3];
+  int16_t x, y;
+  if(f == NULL) return -1;
+  fprintf(f, "P6\n%d %d\n255\n", SIM_WIDTH, SIM_HEIGHT);
+  for(y = 0; y < SIM_HEIGHT; y++){
+    for(x = 0; x < SIM_WIDTH; x++){
+      rgb888(x, y, rgb);
+      fwrite(rgb, 1, 3, f);
+    }
+  }
+  return fclose(f) ? -1 : 0;
+}
+
+//------------PNG writer------------
+static uint32_t CrcTable[256];
+
+static void crcInit(void){
+  uint32_t c, k, i;
+  for(k = 0; k < 256; k++){
+    c = k;
+    for(i = 0; i < 8; i++){
+      c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+    }
+    CrcTable[k] = c;
+  }
+}
+
+static uint32_t crc32(uint32_t crc, const uint8_t *buf, uint32_t n){
+  if(CrcTable[1] == 0){
+    crcInit();
+  }
+  crc = ~crc;
+  while(n--){
+    crc = CrcTable[(crc ^ *buf++) & 0xFF] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+static void put32(uint8_t *p, uint32_t v){
+  p[0] = v>>24; p[1] = v>>16; p[2] = v>>8; p[3] = v;
+}
+
+static void chunk(FILE *f, const char *type, const uint8_t *body, uint32_t n){
+  uint8_t b[4];
+  uint32_t crc;
+  put32(b, n);
+  fwrite(b, 1, 4, f);
+  fwrite(type, 1, 4, f);
+  fwrite(body, 1, n, f);
+  crc = crc32(crc32(0, (const uint8_t *)type, 4), body, n);
+  put32(b, crc);
+  fwrite(b, 1, 4, f);
+}
+
+int ST7735Sim_SavePNG(const char *path){
+  // one scan line is a filter byte plus 3 bytes per pixel, and each
+  // line goes into its own stored deflate block (at most 65535 bytes)
+  enum { LINE = 1 + 3*SIM_WIDTH, BLOCK = 5 + LINE };
+  static uint8_t idat[2 + SIM_HEIGHT*BLOCK + 4];
+  static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  uint8_t ihdr[13] = {0};
+  uint32_t a = 1, b = 0;           // Adler-32 of the uncompressed lines
+  uint8_t *p = idat;
+  int16_t x, y;
+  int i;
+  FILE *f = fopen(path, "wb");
+  if(f == NULL) return -1;
+  put32(&ihdr[0], SIM_WIDTH);
+  put32(&ihdr[4], SIM_HEIGHT);
+  ihdr[8] = 8;                     // bit depth
+  ihdr[9] = 2;                     // truecolor
+  *p++ = 0x78; *p++ = 0x01;        // zlib header, no compression
+  for(y = 0; y < SIM_HEIGHT; y++){
+    *p++ = (y == SIM_HEIGHT - 1);  // BFINAL on the last block, BTYPE 00
+    *p++ = LINE & 0xFF; *p++ = LINE >> 8;
+    *p++ = ~LINE & 0xFF; *p++ = (~LINE >> 8) & 0xFF;
+    *p = 0;                        // filter type none
+    for(x = 0; x < SIM_WIDTH; x++){
+      rgb888(x, y, p + 1 + 3*x);
+    }
+    for(i = 0; i < LINE; i++){
+      a = (a + p[i]) % 65521;
+      b = (b + a) % 65521;
+    }
+    p += LINE;
+  }
+  put32(p, (b << 16) | a);
+  p += 4;
+  fwrite(signature, 1, 8, f);
+  chunk(f, "IHDR", ihdr, 13);
+  chunk(f, "IDAT", idat, p - idat);
+  chunk(f, "IEND", ihdr, 0);
+  return fclose(f) ? -1 : 0;
+}
+
+int32_t ST7735Sim_Compare(const char *path){
+  FILE *f = fopen(path, "rb");
+  uint8_t rgb[3], golden[3];
+  int w, h, maxval;
+  int32_t diff = 0;
+  int16_t x, y;
+  if(f == NULL) return -1;
+  if((fscanf(f, "P6 %d %d %d", &w, &h, &maxval) != 3) || (w != SIM_WIDTH) ||
+     (h != SIM_HEIGHT) || (maxval != 255) || (fgetc(f) == EOF)){
+    fclose(f);
+    return -1;
+  }
+  for(y = 0; y < SIM_HEIGHT; y++){
+    for(x = 0; x < SIM_WIDTH; x++){
+      if(fread(golden, 1, 3, f) != 3){
+        fclose(f);
+        return -1;
+      }
+      rgb888(x, y, rgb);
+      if(memcmp(rgb, golden, 3)){
+        diff++;
+      }
+    }
+  }
+  fclose(f);
+  return diff;
+}
@@ -0,0 +1,146 @@
+#ifndef ST7735SIM_H
+#define ST7735SIM_H
+
+#include <stdint.h>
+
+// Host-side model of the ST7735 controller, used when LCD.c is compiled
+// with -DLCD_SIM.  writecommand()/writedata() hand every byte to this
+// module instead of SSI2, and it decodes CASET/RASET/RAMWR into a copy
+// of the panel memory, so any drawing primitive can be run, timed and
+// compared against a golden image on the PC.
+//
+// Host build of a program that uses the LCD driver, e.g.
+//   gcc -std=gnu99 -O2 -DLCD_SIM -o lcdbench tools/lcdbench.c LCD.c ST7735Sim.c
+// ST7735Sim.c is not part of the Keil project.
+
+#define SIM_GRAM_WIDTH   132  // columns of controller memory
+#define SIM_GRAM_HEIGHT  162  // rows of controller memory
+#define SIM_WIDTH        128  // visible columns of the green tab panel
+#define SIM_HEIGHT       128  // visible rows of the green tab panel
+#define SIM_COLSTART       2  // first visible column, same as ColStart in LCD.c
+#define SIM_ROWSTART       3  // first visible row, same as RowStart in LCD.c
+
+typedef struct {
+  uint32_t commands;      // command bytes (D/C low)
+  uint32_t data;          // data bytes (D/C high), including pixels
+  uint32_t pixels;        // pixels written by RAMWR
+  uint32_t windows;       // CASET plus RASET pairs, counted at each RASET
+  uint32_t delayms;       // milliseconds spent in BSP_Delay1ms()
+} SimStatsType;
+
+#define SIM_TRACE_SIZE    64  // commands kept after ST7735Sim_TraceClear()
+#define SIM_TRACE_ARGS     6  // arguments kept for each command
+
+typedef struct {
+  uint8_t command;        // command byte
+  uint8_t args[SIM_TRACE_ARGS]; // first arguments that followed it
+  uint32_t count;         // number of data bytes that followed it
+} SimTraceType;
+
+//------------ST7735Sim_Reset------------
+// Clear the panel memory to black, reset the address window and the
+// counters.  Called by the driver at the start of BSP_LCD_Init().
+// Input: none
+// Output: none
+void ST7735Sim_Reset(void);
+
+//------------ST7735Sim_Command------------
+// Accept one byte sent with D/C low.
+// Input: c command code
+// Output: none
+void ST7735Sim_Command(uint8_t c);
+
+//------------ST7735Sim_Data------------
+// Accept one byte sent with D/C high.
+// Input: d data byte
+// Output: none
+void ST7735Sim_Data(uint8_t d);
+
+//------------ST7735Sim_Delay------------
+// Account for a busy-wait delay requested by the driver.
+// Input: ms number of milliseconds
+// Output: none
+void ST7735Sim_Delay(uint32_t ms);
+
+//------------ST7735Sim_SetClock------------
+// Select the SPI bit rate used by ST7735Sim_BusTime().  The default is
+// 4 MHz, the rate programmed into SSI2 by the driver.
+// Input: hz SPI clock in bits per second
+// Output: none
+void ST7735Sim_SetClock(uint32_t hz);
+
+//------------ST7735Sim_Stats------------
+// Copy the counters accumulated since the last reset or clear.
+// Input: stats pointer to the structure to be filled in
+// Output: none
+void ST7735Sim_Stats(SimStatsType *stats);
+
+//------------ST7735Sim_ClearStats------------
+// Zero the counters without touching the panel memory, so that one
+// drawing call can be measured on its own.
+// Input: none
+// Output: none
+void ST7735Sim_ClearStats(void);
+
+//------------ST7735Sim_BusTime------------
+// Estimated time on the wire for the bytes counted so far, 8 bits
+// per byte at the selected clock, excluding delays.
+// Input: none
+// Output: time in microseconds
+uint32_t ST7735Sim_BusTime(void);
+
+//------------ST7735Sim_FrameRate------------
+// Refresh rate selected by FRMCTR1 (normal mode) or FRMCTR3 (partial
+// mode), whichever is in use.
+// Input: none
+// Output: refresh rate in 0.1 Hz units
+uint32_t ST7735Sim_FrameRate(void);
+
+//------------ST7735Sim_TraceClear------------
+// Start recording a new command trace.
+// Input: none
+// Output: none
+void ST7735Sim_TraceClear(void);
+
+//------------ST7735Sim_TraceCount------------
+// Number of commands received since ST7735Sim_TraceClear(), including
+// any beyond the SIM_TRACE_SIZE that are kept.
+// Input: none
+// Output: number of commands
+uint32_t ST7735Sim_TraceCount(void);
+
+//------------ST7735Sim_TraceGet------------
+// Read one recorded command.
+// Input: i index in the trace, 0 is the oldest
+// Output: pointer to the entry, NULL if it was not recorded
+const SimTraceType *ST7735Sim_TraceGet(uint32_t i);
+
+//------------ST7735Sim_GetPixel------------
+// Read back a visible pixel as it appears on the glass, after the
+// vertical scroll set up by VSCRDEF/VSCSAD and the partial area.
+// Input: x column 0 to 127
+//        y row 0 to 127
+// Output: 16-bit 5-6-5 color, 0 if outside the panel
+uint16_t ST7735Sim_GetPixel(int16_t x, int16_t y);
+
+//------------ST7735Sim_SavePPM------------
+// Write the visible 128x128 image as a binary (P6) PPM file.
+// Input: path file name
+// Output: 0 if successful, -1 on a file error
+int ST7735Sim_SavePPM(const char *path);
+
+//------------ST7735Sim_SavePNG------------
+// Write the visible 128x128 image as an 8-bit RGB PNG file, using
+// stored (uncompressed) deflate blocks so no library is needed.
+// Input: path file name
+// Output: 0 if successful, -1 on a file error
+int ST7735Sim_SavePNG(const char *path);
+
+//------------ST7735Sim_Compare------------
+// Compare the visible image with a golden P6 PPM file written earlier
+// by ST7735Sim_SavePPM().
+// Input: path file name of the golden image
+// Output: number of pixels that differ, -1 if the file cannot be read
+int32_t ST7735Sim_Compare(const char *path);
+
+#endif
@@ -0,0 +1,184 @@
+// SoundSim.c
+// Host-side model of PWM1 generator 3 and Timer5A for sound.c built
+// with -DSOUND_SIM, see SoundSim.h.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "tm4c123gh6pm.h"
+#include "SoundSim.h"
+
+void Timer5A_Handler(void);
+
+#define TONES_MAX  4096
+#define TAEN       0x01           // TIMER5_CTL_R
+#define TATO       0x01           // TIMER5_RIS_R, TIMER5_IMR_R and TIMER5_ICR_R
+#define M1PWM6     0x40           // PWM1_ENABLE_R
+#define INT92      0x10000000     // NVIC_EN2_R, Timer5A
+
+SoundSimStatsType SoundSimStats;
+
+static uint32_t Regs[SIM_REGS];
+static int Pending = -1;          // register of the last access, its write not applied yet
+static int Running;               // Timer5A counts
+static uint32_t Held;             // counter while stopped
+static uint64_t Timeout;          // cycle the counter reaches 0 while running
+static SoundSimToneType Tones[TONES_MAX];
+static uint32_t ToneCount;
+static int InHandler;
+
+static void error(const char *what){
+  SoundSimStats.errors++;
+  if(SoundSimStats.errors <= 10){
+    printf("  SoundSim at cycle %llu: %s\n", (unsigned long long)SoundSimStats.cycles, what);
+  }
+}
+
+// counter value now
+static uint32_t counter(void){
+  return Running ? (uint32_t)(Timeout - SoundSimStats.cycles - 1) : Held;
+}
+
+// the write of the previous access takes effect
+static void commit(void){
+  uint32_t v;
+  if(Pending < 0) return;
+  v = Regs[Pending];
+  switch(Pending){
+    case SIM_TIMER5_ICR:
+      Regs[SIM_TIMER5_RIS] &= ~v;
+      break;
+    case SIM_TIMER5_TAV:
+      Held = v;
+      if(Running){
+        Timeout = SoundSimStats.cycles + v + 1;
+      }
+      break;
+    case SIM_TIMER5_CTL:
+      if((v&TAEN) && !Running){
+        if((Regs[SIM_TIMER5_CFG] != 0) || ((Regs[SIM_TIMER5_TAMR]&3) != 2) ||
+           (Regs[SIM_TIMER5_TAPR] != 0)){
+          error("Timer5A is not a 32-bit periodic timer");
+        }
+        Running = 1;
+        Timeout = SoundSimStats.cycles + Held + 1;
+      }else if(!(v&TAEN) && Running){
+        Held = counter();
+        Running = 0;
+      }
+      break;
+  }
+  Pending = -1;
+}
+
+volatile uint32_t *SoundSim_Reg(int reg){
+  commit();
+  switch(reg){
+    case SIM_TIMER5_TAV:
+      Regs[reg] = counter();
+      break;
+    case SIM_PRGPIO:
+      Regs[reg] = Regs[SIM_RCGCGPIO];
+      break;
+    case SIM_PRTIMER:
+      Regs[reg] = Regs[SIM_RCGCTIMER];
+      break;
+    case SIM_TIMER5_ICR:
+      Regs[reg] = 0;                // write only
+      break;
+  }
+  Pending = reg;
+  return &Regs[reg];
+}
+
+// log the buzzer if it changed, and check how it is set up while on
+static void tone(void){
+  uint32_t load;
+  int on;
+  SoundSimToneType *last = &Tones[ToneCount - 1];
+  commit();
+  load = Regs[SIM_PWM1_3_LOAD];
+  on = (Regs[SIM_PWM1_ENABLE]&M1PWM6) != 0;
+  if(on){
+    if((load == 0) || (load > 0xFFFF)){
+      error("PWM1_3_LOAD_R out of the 16-bit range");
+    }
+    if(Regs[SIM_PWM1_3_CMPA] != (load + 1)/2){
+      error("duty cycle not 50 %");
+    }
+    if(!(Regs[SIM_PWM1_3_CTL]&1) || (Regs[SIM_PWM1_3_GENA] != 0xC8)){
+      error("PWM1 generator 3 not running");
+    }
+    if(!(Regs[SIM_RCC]&SYSCTL_RCC_USEPWMDIV) ||
+       ((Regs[SIM_RCC]&SYSCTL_RCC_PWMDIV_M) != SYSCTL_RCC_PWMDIV_64)){
+      error("PWM clock not the bus clock divided by 64");
+    }
+    if(!(Regs[SIM_PORTF_AFSEL]&0x04) || ((Regs[SIM_PORTF_PCTL]&0xF00) != 0x500) ||
+       !(Regs[SIM_PORTF_DEN]&0x04)){
+      error("PF2 is not M1PWM6");
+    }
+  }
+  if((on == last->on) && (!on || (load == last->load))){
+    return;
+  }
+  if(ToneCount < TONES_MAX){
+    Tones[ToneCount].cycle = SoundSimStats.cycles;
+    Tones[ToneCount].load = load;
+    Tones[ToneCount++].on = on;
+  }
+}
+
+// the NVIC calls Timer5A_Handler() while the timeout is pending
+static void interrupts(void){
+  commit();
+  if(!InHandler && (Regs[SIM_NVIC_EN2]&INT92) &&
+     (Regs[SIM_TIMER5_RIS]&Regs[SIM_TIMER5_IMR]&TATO)){
+    InHandler = 1;
+    SoundSimStats.interrupts++;
+    Timer5A_Handler();
+    commit();
+    InHandler = 0;
+    if(Regs[SIM_TIMER5_RIS]&TATO){
+      error("Timer5A_Handler() does not acknowledge its interrupt");
+      Regs[SIM_TIMER5_RIS] = 0;
+    }
+  }
+  tone();
+}
+
+void SoundSim_Reset(void){
+  memset(Regs, 0, sizeof(Regs));
+  memset(&SoundSimStats, 0, sizeof(SoundSimStats));
+  Pending = -1;
+  Running = InHandler = 0;
+  Held = 0xFFFFFFFF;
+  Timeout = 0;
+  Tones[0].cycle = 0;
+  Tones[0].load = 0;
+  Tones[0].on = 0;
+  ToneCount = 1;
+}
+
+void SoundSim_Run(uint64_t cycles){
+  uint64_t end = SoundSimStats.cycles + cycles;
+  interrupts();
+  commit();
+  while(Running && (Timeout <= end)){
+    SoundSimStats.cycles = Timeout;
+    Regs[SIM_TIMER5_RIS] |= TATO;
+    Timeout += (uint64_t)Regs[SIM_TIMER5_TAILR] + 1;   // reloads and goes on
+    interrupts();
+    commit();
+  }
+  SoundSimStats.cycles = end;
+}
+
+const SoundSimToneType *SoundSim_Tones(uint32_t *n){
+  *n = ToneCount;
+  return Tones;
+}
+
+int SoundSim_TimerOn(void){
+  commit();
+  return Running;
+}
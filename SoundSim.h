@@ -0,0 +1,127 @@
+#ifndef SOUNDSIM_H
+#define SOUNDSIM_H
+
+#include <stdint.h>
+
+// Host-side model of PWM1 generator 3 and Timer5A, for sound.c built
+// with -DSOUND_SIM.  Every register sound.c touches becomes a call to
+// SoundSim_Reg(), so the sequencer runs unchanged against a 32-bit
+// periodic timer counting the 80 MHz bus clock and a PWM output whose
+// tone is logged each time it changes.  Timer5A_Handler() is called the
+// way the NVIC would, between steps of the model; the driver's own code
+// runs in no time.
+//
+// Register accesses follow the hardware: TIMER5_ICR_R clears the bits
+// written, TIMER5_TAV_R reads the counter and a write loads it, setting
+// TAEN starts counting from the value held.  A new LOAD takes effect at
+// once, not at the end of the PWM period as on the board.
+//
+// Host build of a program that uses the sound driver, e.g.
+//   gcc -std=gnu99 -O2 -DSOUND_SIM -I. -o soundtest tools/soundtest.c sound.c SoundSim.c
+// SoundSim.c is not part of the Keil project.
+
+enum {
+  SIM_PWM1_3_CTL, SIM_PWM1_3_GENA, SIM_PWM1_3_LOAD, SIM_PWM1_3_CMPA, SIM_PWM1_ENABLE,
+  SIM_TIMER5_CTL, SIM_TIMER5_CFG, SIM_TIMER5_TAMR, SIM_TIMER5_TAILR, SIM_TIMER5_TAPR,
+  SIM_TIMER5_TAV, SIM_TIMER5_IMR, SIM_TIMER5_RIS, SIM_TIMER5_ICR,
+  SIM_RCGCPWM, SIM_RCGCGPIO, SIM_PRGPIO, SIM_RCGCTIMER, SIM_PRTIMER, SIM_RCC,
+  SIM_PORTF_AFSEL, SIM_PORTF_PCTL, SIM_PORTF_AMSEL, SIM_PORTF_DIR, SIM_PORTF_DEN,
+  SIM_NVIC_PRI23, SIM_NVIC_EN2,
+  SIM_REGS
+};
+
+#undef PWM1_3_CTL_R
+#undef PWM1_3_GENA_R
+#undef PWM1_3_LOAD_R
+#undef PWM1_3_CMPA_R
+#undef PWM1_ENABLE_R
+#undef TIMER5_CTL_R
+#undef TIMER5_CFG_R
+#undef TIMER5_TAMR_R
+#undef TIMER5_TAILR_R
+#undef TIMER5_TAPR_R
+#undef TIMER5_TAV_R
+#undef TIMER5_IMR_R
+#undef TIMER5_RIS_R
+#undef TIMER5_ICR_R
+#undef SYSCTL_RCGCPWM_R
+#undef SYSCTL_RCGCGPIO_R
+#undef SYSCTL_PRGPIO_R
+#undef SYSCTL_RCGCTIMER_R
+#undef SYSCTL_PRTIMER_R
+#undef SYSCTL_RCC_R
+#undef GPIO_PORTF_AFSEL_R
+#undef GPIO_PORTF_PCTL_R
+#undef GPIO_PORTF_AMSEL_R
+#undef GPIO_PORTF_DIR_R
+#undef GPIO_PORTF_DEN_R
+#undef NVIC_PRI23_R
+#undef NVIC_EN2_R
+#define PWM1_3_CTL_R        (*SoundSim_Reg(SIM_PWM1_3_CTL))
+#define PWM1_3_GENA_R       (*SoundSim_Reg(SIM_PWM1_3_GENA))
+#define PWM1_3_LOAD_R       (*SoundSim_Reg(SIM_PWM1_3_LOAD))
+#define PWM1_3_CMPA_R       (*SoundSim_Reg(SIM_PWM1_3_CMPA))
+#define PWM1_ENABLE_R       (*SoundSim_Reg(SIM_PWM1_ENABLE))
+#define TIMER5_CTL_R        (*SoundSim_Reg(SIM_TIMER5_CTL))
+#define TIMER5_CFG_R        (*SoundSim_Reg(SIM_TIMER5_CFG))
+#define TIMER5_TAMR_R       (*SoundSim_Reg(SIM_TIMER5_TAMR))
+#define TIMER5_TAILR_R      (*SoundSim_Reg(SIM_TIMER5_TAILR))
+#define TIMER5_TAPR_R       (*SoundSim_Reg(SIM_TIMER5_TAPR))
+#define TIMER5_TAV_R        (*SoundSim_Reg(SIM_TIMER5_TAV))
+#define TIMER5_IMR_R        (*SoundSim_Reg(SIM_TIMER5_IMR))
+#define TIMER5_RIS_R        (*SoundSim_Reg(SIM_TIMER5_RIS))
+#define TIMER5_ICR_R        (*SoundSim_Reg(SIM_TIMER5_ICR))
+#define SYSCTL_RCGCPWM_R    (*SoundSim_Reg(SIM_RCGCPWM))
+#define SYSCTL_RCGCGPIO_R   (*SoundSim_Reg(SIM_RCGCGPIO))
+#define SYSCTL_PRGPIO_R     (*SoundSim_Reg(SIM_PRGPIO))
+#define SYSCTL_RCGCTIMER_R  (*SoundSim_Reg(SIM_RCGCTIMER))
+#define SYSCTL_PRTIMER_R    (*SoundSim_Reg(SIM_PRTIMER))
+#define SYSCTL_RCC_R        (*SoundSim_Reg(SIM_RCC))
+#define GPIO_PORTF_AFSEL_R  (*SoundSim_Reg(SIM_PORTF_AFSEL))
+#define GPIO_PORTF_PCTL_R   (*SoundSim_Reg(SIM_PORTF_PCTL))
+#define GPIO_PORTF_AMSEL_R  (*SoundSim_Reg(SIM_PORTF_AMSEL))
+#define GPIO_PORTF_DIR_R    (*SoundSim_Reg(SIM_PORTF_DIR))
+#define GPIO_PORTF_DEN_R    (*SoundSim_Reg(SIM_PORTF_DEN))
+#define NVIC_PRI23_R        (*SoundSim_Reg(SIM_NVIC_PRI23))
+#define NVIC_EN2_R          (*SoundSim_Reg(SIM_NVIC_EN2))
+
+#define SIM_CLOCK  80000000     // bus clock, cycles per second
+
+// the buzzer from one cycle on
+typedef struct {
+  uint64_t cycle;         // when the change took effect
+  uint32_t load;          // PWM1_3_LOAD_R, the tone is SIM_CLOCK/64/(load+1) Hz
+  int on;                 // M1PWM6 enabled
+} SoundSimToneType;
+
+typedef struct {
+  uint64_t cycles;        // time since SoundSim_Reset()
+  uint32_t interrupts;    // Timer5A_Handler() calls
+  uint32_t errors;        // driver mistakes, each printed when found
+} SoundSimStatsType;
+extern SoundSimStatsType SoundSimStats;
+
+//------------SoundSim_Reg------------
+// Storage of one register for the macros above, see SoundSim.c.
+volatile uint32_t *SoundSim_Reg(int reg);
+
+//------------SoundSim_Reset------------
+// Power-on state: registers zero, timer stopped, tone log empty, time 0.
+void SoundSim_Reset(void);
+
+//------------SoundSim_Run------------
+// Let time pass, counting Timer5A down and calling Timer5A_Handler() at
+// each timeout; SoundSim_Run(0) logs what the driver did just now.
+// Input: cycles of the 80 MHz bus clock
+void SoundSim_Run(uint64_t cycles);
+
+//------------SoundSim_Tones------------
+// The buzzer changes so far, the first the state at SoundSim_Reset().
+// Output: pointer to them, *n gets the count
+const SoundSimToneType *SoundSim_Tones(uint32_t *n);
+
+//------------SoundSim_TimerOn------------
+// Output: 1 while Timer5A counts
+int SoundSim_TimerOn(void);
+
+#endif
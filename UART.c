@@ -27,11 +27,33 @@
 
 // U0Rx (VCP receive) connected to PA0
 // U0Tx (VCP transmit) connected to PA1
+// uDMA moves the data both ways, the CPU only takes an interrupt per
+// transfer:
+//   TX  uDMA channel 9 sends the bytes at the front of Tx_UARTFifo
+//       straight out of the ring, one basic transfer per contiguous span,
+//       and UART0_Handler() skips them and starts the next span when it
+//       is done.
+//   RX  uDMA channel 8 fills two UART_RXBLOCK halves ping-pong, moving
+//       4 bytes per burst once the hardware FIFO is half full.
+//       UART0_Handler() copies a full half to Rx_UARTFifo and re-arms it
+//       while uDMA fills the other.  A burst leaves at least 4 bytes in
+//       the hardware FIFO, so when the line goes idle for 32 bit times
+//       the receive time-out interrupt always comes, hands over the part
+//       of the half already filled and reads the rest out of the FIFO.
+// The host build with -DUART_SIM runs this file against a model of
+// UART0 and uDMA, see UARTSim.c and tools/uartdma.c.
 #include <stdint.h>
+#include <string.h>
 #include "tm4c123gh6pm.h"
+#ifdef UART_SIM
+#include "UARTSim.h"
+#endif
 
+#include "os.h"
+#include "uDMA.h"
 #include "UART_FIFO.h"
 #include "UART.h"
+#include "trace.h"
 
 #define NVIC_EN0_INT5           0x00000020  // Interrupt 5 enable
 
@@ -41,54 +63,132 @@
 #define UART_LCRH_WLEN_8        0x00000060  // 8 bit word length
 #define UART_LCRH_FEN           0x00000010  // UART Enable FIFOs
 #define UART_CTL_UARTEN         0x00000001  // UART Enable
-#define UART_IFLS_RX1_8         0x00000000  // RX FIFO >= 1/8 full
-#define UART_IFLS_TX1_8         0x00000000  // TX FIFO <= 1/8 full
+#define UART_IFLS_RX4_8         0x00000010  // RX FIFO >= 1/2 full
+#define UART_IFLS_TX4_8         0x00000002  // TX FIFO <= 1/2 full
 #define UART_IM_RTIM            0x00000040  // UART Receive Time-Out Interrupt
                                             // Mask
-#define UART_IM_TXIM            0x00000020  // UART Transmit Interrupt Mask
-#define UART_IM_RXIM            0x00000010  // UART Receive Interrupt Mask
 #define UART_RIS_RTRIS          0x00000040  // UART Receive Time-Out Raw
                                             // Interrupt Status
-#define UART_RIS_TXRIS          0x00000020  // UART Transmit Raw Interrupt
-                                            // Status
-#define UART_RIS_RXRIS          0x00000010  // UART Receive Raw Interrupt
-                                            // Status
-#define UART_ICR_RTIC           0x00000040  // Receive Time-Out Interrupt Clear
-#define UART_ICR_TXIC           0x00000020  // Transmit Interrupt Clear
-#define UART_ICR_RXIC           0x00000010  // Receive Interrupt Clear
+#define UART_DMACTL_TXDMAE      0x00000002  // Transmit DMA Enable
+#define UART_DMACTL_RXDMAE      0x00000001  // Receive DMA Enable
+
+#define UART0_RX_CHANNEL 8                  // uDMA channel 8 encoding 0
+#define UART0_TX_CHANNEL 9                  // uDMA channel 9 encoding 0
+#define RX_BIT (1u << UART0_RX_CHANNEL)
+#define TX_BIT (1u << UART0_TX_CHANNEL)
+                                        // memory to UART0_DR_R, the data
+                                        // request comes with 8 free entries
+#define TX_CONTROL (UDMA_CHCTL_DSTINC_NONE|UDMA_CHCTL_DSTSIZE_8|UDMA_CHCTL_SRCINC_8|\
+  UDMA_CHCTL_SRCSIZE_8|UDMA_CHCTL_ARBSIZE_8|UDMA_CHCTL_XFERMODE_BASIC)
+                                        // UART0_DR_R to a half, 4 bytes per
+                                        // burst, the burst request comes with
+                                        // the hardware FIFO half full
+#define RX_CONTROL (UDMA_CHCTL_DSTINC_8|UDMA_CHCTL_DSTSIZE_8|UDMA_CHCTL_SRCINC_NONE|\
+  UDMA_CHCTL_SRCSIZE_8|UDMA_CHCTL_ARBSIZE_4|((UART_RXBLOCK - 1) << UDMA_CHCTL_XFERSIZE_S)|\
+  UDMA_CHCTL_XFERMODE_PINGPONG)
 
 void DisableInterrupts(void); // Disable interrupts
 void EnableInterrupts(void);  // Enable interrupts
 long StartCritical(void);    // previous I bit, disable interrupts
 void EndCritical(long sr);    // restore I bit to previous value
 void WaitForInterrupt(void);  // low power mode
-#define FIFOSIZE   16         // size of the FIFOs (must be power of 2)
-#define FIFOSUCCESS 1         // return value on success
-#define FIFOFAIL    0         // return value on failure
-                              // create index implementation FIFO (see FIFO.h)
-//AddIndexFifo(Rx_UART, FIFOSIZE, char, FIFOSUCCESS, FIFOFAIL)
-//AddIndexFifo(Tx_UART, FIFOSIZE, char, FIFOSUCCESS, FIFOFAIL)
-	
+
+UARTStatsType UARTStats;
+
+static volatile uint32_t TxCount;       // bytes the TX channel is sending, 0 when idle
+static char RxBuffer[2][UART_RXBLOCK];  // ping-pong halves of the RX channel
+static uint32_t RxHalf;                 // the half uDMA is filling, 0 primary
+static uint32_t RxTaken;                // bytes of it already in Rx_UARTFifo
+
+// start the TX channel on the span at the front of Tx_UARTFifo
+// call with the channel idle, from UART0_Handler() or with interrupts disabled
+static void txStart(void){
+  uint32_t n;
+  char *pt = Tx_UARTFifo_Peek(&n);
+  TxCount = n;
+  if(n){
+    DMA_PRIMARY(UART0_TX_CHANNEL)->srcEnd = (uintptr_t)(pt + n - 1);
+    DMA_PRIMARY(UART0_TX_CHANNEL)->control = TX_CONTROL|((n - 1) << UDMA_CHCTL_XFERSIZE_S);
+    UDMA_ENASET_R = TX_BIT;
+  }
+}
+
+// start the TX channel if it is idle, after a thread put data
+static void txKick(void){
+  long sr;
+  if(TxCount == 0){
+    sr = StartCritical();
+    if(TxCount == 0){                   // UART0_Handler() may have started it
+      txStart();
+    }
+    EndCritical(sr);
+  }
+}
+
+static void rxPut(const char *pt, uint32_t n){
+  UARTStats.rxDropped += n - Rx_UARTFifo_PutN(pt, n);
+}
+
+// copy what uDMA wrote into the halves since the last call to
+// Rx_UARTFifo, and re-arm each half it filled
+static void rxFlush(void){
+  DMA_ChannelType *half;
+  uint32_t filled;
+  for(;;){
+    half = RxHalf ? DMA_ALTERNATE(UART0_RX_CHANNEL) : DMA_PRIMARY(UART0_RX_CHANNEL);
+    filled = UART_RXBLOCK - DMA_REMAINING(half->control);
+    rxPut(&RxBuffer[RxHalf][RxTaken], filled - RxTaken);
+    RxTaken = filled;
+    if(filled < UART_RXBLOCK){
+      return;
+    }
+    half->control = RX_CONTROL;         // full, uDMA has moved on to the other half
+    RxHalf ^= 1;
+    RxTaken = 0;
+    UDMA_ENASET_R = RX_BIT;             // restarts the channel if both halves had filled
+  }
+}
+
 // Initialize UART0
 // Baud rate is 115200 bits/sec
 void UART_Init(void){
   SYSCTL_RCGCUART_R |= 0x01;            // activate UART0
   SYSCTL_RCGCGPIO_R |= 0x01;            // activate port A
-  Rx_UARTFifo_Init();                        // initialize empty FIFOs
+  Rx_UARTFifo_Init();                   // initialize empty FIFOs
   Tx_UARTFifo_Init();
-	
+  TxCount = 0;
+  RxHalf = RxTaken = 0;
+  DMA_Init();
+  UDMA_ENACLR_R = RX_BIT|TX_BIT;        // stop both channels while they are set up
+  UDMA_CHMAP1_R &= ~(UDMA_CHMAP1_CH8SEL_M|UDMA_CHMAP1_CH9SEL_M); // encoding 0, UART0
+  UDMA_PRIOCLR_R = RX_BIT|TX_BIT;       // default priority
+  UDMA_REQMASKCLR_R = RX_BIT|TX_BIT;    // allow requests from UART0
+  UDMA_ALTCLR_R = RX_BIT|TX_BIT;        // start on the primary structures
+  UDMA_USEBURSTSET_R = RX_BIT;          // RX bursts only, leftovers wait for the time-out
+  UDMA_USEBURSTCLR_R = TX_BIT;          // TX also fills the last few entries singly
+  DMA_PRIMARY(UART0_TX_CHANNEL)->dstEnd = (uintptr_t)&UART0_DR_R;
+  DMA_PRIMARY(UART0_RX_CHANNEL)->srcEnd = (uintptr_t)&UART0_DR_R;
+  DMA_PRIMARY(UART0_RX_CHANNEL)->dstEnd = (uintptr_t)&RxBuffer[0][UART_RXBLOCK - 1];
+  DMA_PRIMARY(UART0_RX_CHANNEL)->control = RX_CONTROL;
+  DMA_ALTERNATE(UART0_RX_CHANNEL)->srcEnd = (uintptr_t)&UART0_DR_R;
+  DMA_ALTERNATE(UART0_RX_CHANNEL)->dstEnd = (uintptr_t)&RxBuffer[1][UART_RXBLOCK - 1];
+  DMA_ALTERNATE(UART0_RX_CHANNEL)->control = RX_CONTROL;
+
   UART0_CTL_R &= ~UART_CTL_UARTEN;      // disable UART
   UART0_IBRD_R = 43;                    // IBRD = int(80,000,000 / (16 * 115,200)) = int(43.4028)
   UART0_FBRD_R = 26;                     // FBRD = int(0.4028 * 64 + 0.5) = 26
                                         // 8 bit word length (no parity bits, one stop bit, FIFOs)
   UART0_LCRH_R = (UART_LCRH_WLEN_8|UART_LCRH_FEN);
   UART0_IFLS_R &= ~0x3F;                // clear TX and RX interrupt FIFO level fields
-                                        // configure interrupt for TX FIFO <= 1/8 full
-                                        // configure interrupt for RX FIFO >= 1/8 full
-  UART0_IFLS_R += (UART_IFLS_TX1_8|UART_IFLS_RX1_8);
-                                        // enable TX and RX FIFO interrupts and RX time-out interrupt
-  UART0_IM_R |= (UART_IM_RXIM|UART_IM_TXIM|UART_IM_RTIM);
+                                        // uDMA burst requests at TX FIFO <= 1/2 full
+                                        // and at RX FIFO >= 1/2 full
+  UART0_IFLS_R += (UART_IFLS_TX4_8|UART_IFLS_RX4_8);
+                                        // only the RX time-out interrupts, the
+                                        // uDMA done interrupts come on their own
+  UART0_IM_R = UART_IM_RTIM;
+  UART0_DMACTL_R = UART_DMACTL_TXDMAE|UART_DMACTL_RXDMAE;
   UART0_CTL_R |= UART_CTL_UARTEN;       // enable UART
+  UDMA_ENASET_R = RX_BIT;               // receive from now on
   GPIO_PORTA_AFSEL_R |= 0x03;           // enable alt funct on PA1-0
   GPIO_PORTA_DEN_R |= 0x03;             // enable digital I/O on PA1-0
                                         // configure PA1-0 as UART
@@ -98,62 +198,70 @@ void UART_Init(void){
   NVIC_PRI1_R = (NVIC_PRI1_R&0xFFFF00FF)|0x00008000; // bits 13-15
   NVIC_EN0_R = NVIC_EN0_INT5;           // enable interrupt 5 in NVIC
 }
-// copy from hardware RX FIFO to software RX FIFO
-// stop when hardware RX FIFO is empty or software RX FIFO is full
-void static copyHardwareToSoftware(void){
-  char letter;
-  while(((UART0_FR_R&UART_FR_RXFE) == 0) && (Rx_UARTFifo_Size() < (FIFOSIZE - 1))){
-    letter = UART0_DR_R;
-    Rx_UARTFifo_Put(letter);
-  }
-}
-// copy from software TX FIFO to hardware TX FIFO
-// stop when software TX FIFO is empty or hardware TX FIFO is full
-void static copySoftwareToHardware(void){
-  char letter;
-  while(((UART0_FR_R&UART_FR_TXFF) == 0) && (Tx_UARTFifo_Size() > 0)){
-    Tx_UARTFifo_Get(&letter);
-    UART0_DR_R = letter;
-  }
-}
 // input ASCII character from UART
-// spin if RxFifo is empty
+// wait if RxFifo is empty
 char UART_InChar(void){
   char letter;
-  while(Rx_UARTFifo_Get(&letter) == FIFOFAIL){};
+  while(Rx_UARTFifo_Get(&letter) == UARTFIFOFAIL){
+    OS_Suspend();                       // a full half or an idle line brings more
+  }
   return(letter);
 }
 // output ASCII character to UART
-// spin if TxFifo is full
+// wait if TxFifo is full
 void UART_OutChar(char data){
-  while(Tx_UARTFifo_Put(data) == FIFOFAIL){};
-  UART0_IM_R &= ~UART_IM_TXIM;          // disable TX FIFO interrupt
-  copySoftwareToHardware();
-  UART0_IM_R |= UART_IM_TXIM;           // enable TX FIFO interrupt
+  while(Tx_UARTFifo_Put(data) == UARTFIFOFAIL){
+    OS_Suspend();                       // a finished transfer makes room
+  }
+  txKick();
 }
+
+//------------UART_Write------------
+// Queue bytes for transmission without waiting, see UART.h
+uint32_t UART_Write(const char *pt, uint32_t n){
+  n = Tx_UARTFifo_PutN(pt, n);
+  txKick();
+  return n;
+}
+
+//------------UART_Read------------
+// Take up to max received bytes without waiting, see UART.h
+uint32_t UART_Read(char *pt, uint32_t max){
+  return Rx_UARTFifo_GetN(pt, max);
+}
+
 // at least one of three things has happened:
-// hardware TX FIFO goes from 3 to 2 or less items
-// hardware RX FIFO goes from 1 to 2 or more items
-// UART receiver has timed out
+// the TX channel finished its transfer
+// the RX channel filled a half
+// UART receiver has timed out, 1 to 7 bytes wait in the hardware FIFO
 void UART0_Handler(void){
-  if(UART0_RIS_R&UART_RIS_TXRIS){       // hardware TX FIFO <= 2 items
-    UART0_ICR_R = UART_ICR_TXIC;        // acknowledge TX FIFO
-    // copy from software TX FIFO to hardware TX FIFO
-    copySoftwareToHardware();
-    if(Tx_UARTFifo_Size() == 0){             // software TX FIFO is empty
-      UART0_IM_R &= ~UART_IM_TXIM;      // disable TX FIFO interrupt
-    }
+  uint32_t timeout = UART0_RIS_R&UART_RIS_RTRIS;
+  uint32_t done = UDMA_CHIS_R&(RX_BIT|TX_BIT);
+  char letter;
+  TRACE(TRACE_ISR_ENTER, TRACE_CURRENT, TRACE_IRQ_UART0);
+  UARTStats.interrupts++;
+  UDMA_CHIS_R = done;                   // acknowledge uDMA
+  UART0_ICR_R = timeout;                // acknowledge receiver time out
+  if(done&TX_BIT){
+    UARTStats.txBlocks++;
+    Tx_UARTFifo_Skip(TxCount);          // sent, the room goes back to the threads
+    txStart();
   }
-  if(UART0_RIS_R&UART_RIS_RXRIS){       // hardware RX FIFO >= 2 items
-    UART0_ICR_R = UART_ICR_RXIC;        // acknowledge RX FIFO
-    // copy from hardware RX FIFO to software RX FIFO
-    copyHardwareToSoftware();
+  if(done&RX_BIT){
+    UARTStats.rxBlocks++;
+    rxFlush();
   }
-  if(UART0_RIS_R&UART_RIS_RTRIS){       // receiver timed out
-    UART0_ICR_R = UART_ICR_RTIC;        // acknowledge receiver time out
-    // copy from hardware RX FIFO to software RX FIFO
-    copyHardwareToSoftware();
+  if(timeout){
+    UARTStats.rxIdle++;
+    UDMA_REQMASKSET_R = RX_BIT;         // uDMA leaves the hardware FIFO alone
+    rxFlush();                          // older bytes first
+    while((UART0_FR_R&UART_FR_RXFE) == 0){
+      letter = UART0_DR_R;
+      rxPut(&letter, 1);
+    }
+    UDMA_REQMASKCLR_R = RX_BIT;
   }
+  TRACE(TRACE_ISR_EXIT, TRACE_CURRENT, TRACE_IRQ_UART0);
 }
 
 //------------UART_OutString------------
@@ -161,9 +269,14 @@ void UART0_Handler(void){
 // Input: pointer to a NULL-terminated string to be transferred
 // Output: none
 void UART_OutString(char *pt){
-  while(*pt){
-    UART_OutChar(*pt);
-    pt++;
+  uint32_t n = strlen(pt), k;
+  while(n){
+    k = UART_Write(pt, n);
+    pt += k;
+    n -= k;
+    if(n){
+      OS_Suspend();                     // a finished transfer makes room
+    }
   }
 }
 
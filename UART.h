@@ -29,6 +29,8 @@
 #ifndef _UARTH_
 #define _UARTH_
 
+#include <stdint.h>
+
 // standard ASCII symbols
 #define CR   0x0D
 #define LF   0x0A
@@ -56,6 +58,30 @@ char UART_InChar(void);
 // Output: none
 void UART_OutChar(char data);
 
+//------------UART_Write------------
+// Queue bytes for transmission without waiting, uDMA sends them
+// Input: pt points to n bytes
+// Output: number of bytes queued, fewer than n if Tx_UARTFifo filled up
+uint32_t UART_Write(const char *pt, uint32_t n);
+
+//------------UART_Read------------
+// Take received bytes without waiting
+// Input: pt points to room for max bytes
+// Output: number of bytes copied, 0 if none have arrived
+uint32_t UART_Read(char *pt, uint32_t max);
+
+#define UART_RXBLOCK 64       // bytes in each ping-pong half of the RX channel
+
+// counts kept by UART0_Handler()
+typedef struct {
+  uint32_t interrupts;        // UART0_Handler() calls
+  uint32_t txBlocks;          // transmit transfers finished
+  uint32_t rxBlocks;          // interrupts for a full receive half
+  uint32_t rxIdle;            // receive time-outs, the line went idle
+  uint32_t rxDropped;         // received bytes lost, Rx_UARTFifo was full
+} UARTStatsType;
+extern UARTStatsType UARTStats;
+
 //------------UART_OutString------------
 // Output String (NULL termination)
 // Input: pointer to a NULL-terminated string to be transferred
@@ -0,0 +1,323 @@
+// UARTSim.c
+// Host-side model of UART0 and its uDMA channels for UART.c built with
+// -DUART_SIM, see UARTSim.h.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "tm4c123gh6pm.h"
+#include "UARTSim.h"
+#include "uDMA.h"
+
+void UART0_Handler(void);
+
+#define FIFO_DEPTH  16
+#define RX_CHANNEL  8
+#define TX_CHANNEL  9
+#define RX_BIT      (1u << RX_CHANNEL)
+#define TX_BIT      (1u << TX_CHANNEL)
+#define CHIS_MARK   0x80000000    // channel 31 is not UART0, a write clears it
+#define LINE_MAX    (1 << 22)     // bytes each way
+
+UARTSimStatsType UARTSimStats;
+
+static uint32_t Regs[SIM_REGS];
+static int Pending = -1;          // register of the last access, its write not applied yet
+static uint32_t Enabled, UseBurst, ReqMask, Alternate, Chis;
+
+static uint8_t RxFifo[FIFO_DEPTH], TxFifo[FIFO_DEPTH];
+static uint32_t RxCount, RxFirst, TxCount, TxFirst;
+static uint64_t LastRx;           // the last byte reached RxFifo
+static int TimeoutArmed;
+
+static uint8_t InLine[LINE_MAX];  // computer to board
+static uint64_t InTime[LINE_MAX]; // end of each stop bit
+static uint32_t InCount, InNext;
+static uint8_t OutLine[LINE_MAX]; // board to computer
+static uint64_t OutTime[LINE_MAX];
+static uint32_t OutCount;
+static int Shifting;              // TX shift register busy
+static uint8_t ShiftByte;
+static uint64_t ShiftDone;
+static int InHandler;
+
+static void error(const char *what){
+  UARTSimStats.errors++;
+  if(UARTSimStats.errors <= 10){
+    printf("  UARTSim at cycle %llu: %s\n", (unsigned long long)UARTSimStats.cycles, what);
+  }
+}
+
+uint32_t UARTSim_BitCycles(void){
+  uint32_t quarter = 64*Regs[SIM_UART0_IBRD] + Regs[SIM_UART0_FBRD];  // 16*(IBRD + FBRD/64) cycles
+  return (quarter + 2)/4;
+}
+
+uint32_t UARTSim_CharCycles(void){
+  return (10*(64*Regs[SIM_UART0_IBRD] + Regs[SIM_UART0_FBRD]) + 2)/4;
+}
+
+// the write of the previous access takes effect
+static void commit(void){
+  uint32_t v;
+  if(Pending < 0) return;
+  v = Regs[Pending];
+  switch(Pending){
+    case SIM_UART0_DR:              // read, pop the receive FIFO
+      if(RxCount){
+        RxFirst = (RxFirst + 1)%FIFO_DEPTH;
+        RxCount--;
+        UARTSimStats.cpuRx++;
+      }
+      break;
+    case SIM_UART0_ICR:
+      Regs[SIM_UART0_RIS] &= ~v;
+      break;
+    case SIM_UDMA_USEBURSTSET: UseBurst |= v;  break;
+    case SIM_UDMA_USEBURSTCLR: UseBurst &= ~v; break;
+    case SIM_UDMA_REQMASKSET:  ReqMask |= v;   break;
+    case SIM_UDMA_REQMASKCLR:  ReqMask &= ~v;  break;
+    case SIM_UDMA_ENASET:      Enabled |= v;   break;
+    case SIM_UDMA_ENACLR:      Enabled &= ~v;  break;
+    case SIM_UDMA_ALTSET:      Alternate |= v; break;
+    case SIM_UDMA_ALTCLR:      Alternate &= ~v; break;
+    case SIM_UDMA_CHIS:
+      if((v&CHIS_MARK) == 0){       // written
+        Chis &= ~v;
+      }
+      break;
+  }
+  Pending = -1;
+}
+
+volatile uint32_t *UARTSim_Reg(int reg){
+  commit();
+  switch(reg){
+    case SIM_UART0_DR:
+      Regs[reg] = RxCount ? RxFifo[RxFirst] : 0;
+      break;
+    case SIM_UART0_FR:
+      Regs[reg] = (RxCount ? 0 : 0x10) | ((TxCount == FIFO_DEPTH) ? 0x20 : 0) |
+                  ((RxCount == FIFO_DEPTH) ? 0x40 : 0) | (TxCount ? 0 : 0x80);
+      break;
+    case SIM_UDMA_CHIS:
+      Regs[reg] = Chis|CHIS_MARK;
+      break;
+    case SIM_PRDMA:
+      Regs[reg] = Regs[SIM_RCGCDMA]&1;
+      break;
+    case SIM_UART0_ICR: case SIM_UDMA_USEBURSTSET: case SIM_UDMA_USEBURSTCLR:
+    case SIM_UDMA_REQMASKSET: case SIM_UDMA_REQMASKCLR: case SIM_UDMA_ENASET:
+    case SIM_UDMA_ENACLR: case SIM_UDMA_ALTSET: case SIM_UDMA_ALTCLR: case SIM_UDMA_PRIOCLR:
+      Regs[reg] = 0;                // write only
+      break;
+  }
+  Pending = reg;
+  return &Regs[reg];
+}
+
+void UARTSim_Reset(void){
+  memset(Regs, 0, sizeof(Regs));
+  memset(&UARTSimStats, 0, sizeof(UARTSimStats));
+  Pending = -1;
+  Enabled = UseBurst = ReqMask = Alternate = Chis = 0;
+  RxCount = RxFirst = TxCount = TxFirst = 0;
+  InCount = InNext = OutCount = 0;
+  Shifting = TimeoutArmed = InHandler = 0;
+  LastRx = 0;
+}
+
+//------------uDMA------------
+// check the control word UART.c wrote against what the channel needs
+static void checkControl(int ch, uint32_t control, DMA_ChannelType *c){
+  uint32_t want = (ch == TX_CHANNEL) ?
+    (UDMA_CHCTL_DSTINC_NONE|UDMA_CHCTL_DSTSIZE_8|UDMA_CHCTL_SRCINC_8|UDMA_CHCTL_SRCSIZE_8) :
+    (UDMA_CHCTL_DSTINC_8|UDMA_CHCTL_DSTSIZE_8|UDMA_CHCTL_SRCINC_NONE|UDMA_CHCTL_SRCSIZE_8);
+  uintptr_t fixed = (ch == TX_CHANNEL) ? c->dstEnd : c->srcEnd;
+  if((control&0xFF000000) != want){
+    error("wrong increment or size in a control word");
+  }
+  if(fixed != (uintptr_t)&Regs[SIM_UART0_DR]){
+    error("channel not pointed at UART0_DR_R");
+  }
+}
+
+// one request of a channel, 1 if it moved data
+static int service(int ch){
+  uint32_t bit = 1u << ch, control, remaining, arb, n, i, mode;
+  DMA_ChannelType *c;
+  int burst, single;
+  uint8_t *pt;
+  if(((Enabled&bit) == 0) || (ReqMask&bit) || ((Regs[SIM_UDMA_CFG]&UDMA_CFG_MASTEN) == 0)){
+    return 0;
+  }
+  if(ch == TX_CHANNEL){
+    if((Regs[SIM_UART0_DMACTL]&UART_DMACTL_TXDMAE) == 0) return 0;
+    single = TxCount < FIFO_DEPTH;
+    burst = TxCount <= FIFO_DEPTH/2;                // IFLS TX 1/2
+  }else{
+    if((Regs[SIM_UART0_DMACTL]&UART_DMACTL_RXDMAE) == 0) return 0;
+    single = RxCount > 0;
+    burst = RxCount >= FIFO_DEPTH/2;                // IFLS RX 1/2
+  }
+  if((Regs[SIM_UART0_IFLS]&0x3F) != 0x12){
+    error("IFLS is not TX 1/2 and RX 1/2, the burst model does not apply");
+  }
+  if(!burst && (!single || (UseBurst&bit))){
+    return 0;
+  }
+  c = (Alternate&bit) ? DMA_ALTERNATE(ch) : DMA_PRIMARY(ch);
+  control = c->control;
+  mode = control&UDMA_CHCTL_XFERMODE_M;
+  if(mode == UDMA_CHCTL_XFERMODE_STOP){
+    Enabled &= ~bit;                                // nothing armed, the channel stops
+    return 0;
+  }
+  if((mode != UDMA_CHCTL_XFERMODE_BASIC) && (mode != UDMA_CHCTL_XFERMODE_PINGPONG)){
+    error("transfer mode is neither basic nor ping-pong");
+    Enabled &= ~bit;
+    return 0;
+  }
+  checkControl(ch, control, c);
+  remaining = DMA_REMAINING(control);
+  arb = 1u << ((control&UDMA_CHCTL_ARBSIZE_M) >> 14);
+  n = burst ? arb : 1;
+  if(n > remaining) n = remaining;
+  if(ch == TX_CHANNEL){
+    if(n > FIFO_DEPTH - TxCount) n = FIFO_DEPTH - TxCount;
+    pt = (uint8_t *)(c->srcEnd - (remaining - 1));
+    for(i = 0; i < n; i++){
+      TxFifo[(TxFirst + TxCount)%FIFO_DEPTH] = pt[i];
+      TxCount++;
+    }
+    UARTSimStats.dmaTx += n;
+  }else{
+    if(n > RxCount) n = RxCount;
+    pt = (uint8_t *)(c->dstEnd - (remaining - 1));
+    for(i = 0; i < n; i++){
+      pt[i] = RxFifo[RxFirst];
+      RxFirst = (RxFirst + 1)%FIFO_DEPTH;
+      RxCount--;
+    }
+    UARTSimStats.dmaRx += n;
+  }
+  remaining -= n;
+  if(remaining){
+    c->control = (control&~UDMA_CHCTL_XFERSIZE_M)|((remaining - 1) << UDMA_CHCTL_XFERSIZE_S);
+  }else{
+    c->control = control&~(UDMA_CHCTL_XFERSIZE_M|UDMA_CHCTL_XFERMODE_M);
+    Chis |= bit;
+    if(mode == UDMA_CHCTL_XFERMODE_PINGPONG){
+      Alternate ^= bit;                             // carry on with the other structure
+    }else{
+      Enabled &= ~bit;
+    }
+  }
+  return n != 0;
+}
+
+// the NVIC calls UART0_Handler() while an enabled source is pending
+static void interrupts(void){
+  int calls = 0;
+  while(!InHandler && (Regs[SIM_NVIC_EN0]&0x20) &&
+        ((Regs[SIM_UART0_RIS]&Regs[SIM_UART0_IM]) || (Chis&(RX_BIT|TX_BIT)))){
+    if(++calls > 100){
+      error("UART0_Handler() does not acknowledge its interrupt");
+      Chis = 0;
+      Regs[SIM_UART0_RIS] = 0;
+      return;
+    }
+    InHandler = 1;
+    UARTSimStats.interrupts++;
+    UART0_Handler();
+    commit();
+    InHandler = 0;
+    while(service(TX_CHANNEL) || service(RX_CHANNEL)){}
+  }
+}
+
+static void settle(void){
+  commit();
+  if((Regs[SIM_UDMA_CHMAP1]&(UDMA_CHMAP1_CH8SEL_M|UDMA_CHMAP1_CH9SEL_M)) != 0){
+    error("channels 8 and 9 are not mapped to UART0");
+  }
+  if((Enabled&(RX_BIT|TX_BIT)) && (Regs[SIM_UDMA_CTLBASE] != (uint32_t)(uintptr_t)DMA_Table)){
+    error("UDMA_CTLBASE_R is not DMA_Table");
+  }
+  while(service(TX_CHANNEL) || service(RX_CHANNEL)){}
+  interrupts();
+}
+
+//------------line------------
+void UARTSim_Send(const uint8_t *data, uint32_t n, uint32_t idleBits){
+  uint64_t t = InCount ? InTime[InCount - 1] : 0;
+  uint64_t charTime = UARTSim_CharCycles();
+  if(t < UARTSimStats.cycles) t = UARTSimStats.cycles;
+  t += (uint64_t)idleBits*UARTSim_BitCycles();
+  while(n-- && (InCount < LINE_MAX)){
+    t += charTime;
+    InTime[InCount] = t;
+    InLine[InCount++] = *data++;
+  }
+}
+
+uint64_t UARTSim_Arrived(uint32_t k){
+  return InTime[k];
+}
+
+const uint8_t *UARTSim_Received(uint32_t *n, const uint64_t **times){
+  *n = OutCount;
+  if(times) *times = OutTime;
+  return OutLine;
+}
+
+void UARTSim_Run(uint64_t cycles){
+  uint64_t end = UARTSimStats.cycles + cycles, next, timeout;
+  int enabled;
+  settle();
+  while(UARTSimStats.cycles < end){
+    enabled = (Regs[SIM_UART0_CTL]&UART_CTL_UARTEN) != 0;
+    // start shifting the next byte out
+    if(enabled && !Shifting && TxCount){
+      ShiftByte = TxFifo[TxFirst];
+      TxFirst = (TxFirst + 1)%FIFO_DEPTH;
+      TxCount--;
+      Shifting = 1;
+      ShiftDone = UARTSimStats.cycles + UARTSim_CharCycles();
+      settle();
+      continue;
+    }
+    // the next thing to happen
+    next = end;
+    if(Shifting && (ShiftDone < next)) next = ShiftDone;
+    if((InNext < InCount) && (InTime[InNext] < next)) next = InTime[InNext];
+    timeout = LastRx + 32*(uint64_t)UARTSim_BitCycles();
+    if(TimeoutArmed && RxCount && (timeout < next)) next = timeout;
+    UARTSimStats.cycles = next;
+    if(Shifting && (ShiftDone <= next)){
+      Shifting = 0;
+      if(OutCount < LINE_MAX){
+        OutTime[OutCount] = ShiftDone;
+        OutLine[OutCount++] = ShiftByte;
+      }
+    }
+    while((InNext < InCount) && (InTime[InNext] <= next)){
+      if(!enabled){
+        InNext++;                                   // nobody listens
+      }else if(RxCount == FIFO_DEPTH){
+        UARTSimStats.overruns++;
+        InNext++;
+      }else{
+        RxFifo[(RxFirst + RxCount)%FIFO_DEPTH] = InLine[InNext++];
+        RxCount++;
+        LastRx = next;
+        TimeoutArmed = 1;
+      }
+    }
+    if(TimeoutArmed && RxCount && (timeout <= next)){
+      Regs[SIM_UART0_RIS] |= 0x40;                  // RTRIS
+      TimeoutArmed = 0;
+    }
+    settle();
+  }
+}
@@ -0,0 +1,154 @@
+#ifndef UARTSIM_H
+#define UARTSIM_H
+
+#include <stdint.h>
+
+// Host-side model of UART0 and the two uDMA channels it uses, for
+// UART.c and uDMA.c built with -DUART_SIM.  Every register those files
+// touch becomes a call to UARTSim_Reg(), so the driver runs unchanged
+// against a UART with 16 entry FIFOs shifting at the programmed baud
+// rate, a receive time-out after 32 idle bits, and a uDMA controller
+// that reads and updates the real control words in DMA_Table.
+// UART0_Handler() is called the way the NVIC would, between steps of
+// the model; the driver's own code runs in no time.
+//
+// Register accesses follow the hardware: set and clear registers act on
+// the write, UDMA_CHIS_R and UART0_ICR_R clear the bits written, and a
+// UART0_DR_R access pops the receive FIFO (the driver only reads it).
+//
+// Host build of a program that uses the UART driver, e.g.
+//   gcc -std=gnu99 -O2 -DUART_SIM -I. -o uartdma tools/uartdma.c UART.c UART_FIFO.c uDMA.c UARTSim.c
+// UARTSim.c is not part of the Keil project.
+
+enum {
+  SIM_UART0_DR, SIM_UART0_FR, SIM_UART0_IBRD, SIM_UART0_FBRD, SIM_UART0_LCRH,
+  SIM_UART0_CTL, SIM_UART0_IFLS, SIM_UART0_IM, SIM_UART0_RIS, SIM_UART0_ICR,
+  SIM_UART0_DMACTL,
+  SIM_UDMA_CFG, SIM_UDMA_CTLBASE, SIM_UDMA_USEBURSTSET, SIM_UDMA_USEBURSTCLR,
+  SIM_UDMA_REQMASKSET, SIM_UDMA_REQMASKCLR, SIM_UDMA_ENASET, SIM_UDMA_ENACLR,
+  SIM_UDMA_ALTSET, SIM_UDMA_ALTCLR, SIM_UDMA_PRIOCLR, SIM_UDMA_CHIS, SIM_UDMA_CHMAP1,
+  SIM_RCGCUART, SIM_RCGCGPIO, SIM_RCGCDMA, SIM_PRDMA,
+  SIM_PORTA_AFSEL, SIM_PORTA_DEN, SIM_PORTA_PCTL, SIM_PORTA_AMSEL,
+  SIM_NVIC_PRI1, SIM_NVIC_EN0,
+  SIM_REGS
+};
+
+#undef UART0_DR_R
+#undef UART0_FR_R
+#undef UART0_IBRD_R
+#undef UART0_FBRD_R
+#undef UART0_LCRH_R
+#undef UART0_CTL_R
+#undef UART0_IFLS_R
+#undef UART0_IM_R
+#undef UART0_RIS_R
+#undef UART0_ICR_R
+#undef UART0_DMACTL_R
+#undef UDMA_CFG_R
+#undef UDMA_CTLBASE_R
+#undef UDMA_USEBURSTSET_R
+#undef UDMA_USEBURSTCLR_R
+#undef UDMA_REQMASKSET_R
+#undef UDMA_REQMASKCLR_R
+#undef UDMA_ENASET_R
+#undef UDMA_ENACLR_R
+#undef UDMA_ALTSET_R
+#undef UDMA_ALTCLR_R
+#undef UDMA_PRIOCLR_R
+#undef UDMA_CHIS_R
+#undef UDMA_CHMAP1_R
+#undef SYSCTL_RCGCUART_R
+#undef SYSCTL_RCGCGPIO_R
+#undef SYSCTL_RCGCDMA_R
+#undef SYSCTL_PRDMA_R
+#undef GPIO_PORTA_AFSEL_R
+#undef GPIO_PORTA_DEN_R
+#undef GPIO_PORTA_PCTL_R
+#undef GPIO_PORTA_AMSEL_R
+#undef NVIC_PRI1_R
+#undef NVIC_EN0_R
+#define UART0_DR_R          (*UARTSim_Reg(SIM_UART0_DR))
+#define UART0_FR_R          (*UARTSim_Reg(SIM_UART0_FR))
+#define UART0_IBRD_R        (*UARTSim_Reg(SIM_UART0_IBRD))
+#define UART0_FBRD_R        (*UARTSim_Reg(SIM_UART0_FBRD))
+#define UART0_LCRH_R        (*UARTSim_Reg(SIM_UART0_LCRH))
+#define UART0_CTL_R         (*UARTSim_Reg(SIM_UART0_CTL))
+#define UART0_IFLS_R        (*UARTSim_Reg(SIM_UART0_IFLS))
+#define UART0_IM_R          (*UARTSim_Reg(SIM_UART0_IM))
+#define UART0_RIS_R         (*UARTSim_Reg(SIM_UART0_RIS))
+#define UART0_ICR_R         (*UARTSim_Reg(SIM_UART0_ICR))
+#define UART0_DMACTL_R      (*UARTSim_Reg(SIM_UART0_DMACTL))
+#define UDMA_CFG_R          (*UARTSim_Reg(SIM_UDMA_CFG))
+#define UDMA_CTLBASE_R      (*UARTSim_Reg(SIM_UDMA_CTLBASE))
+#define UDMA_USEBURSTSET_R  (*UARTSim_Reg(SIM_UDMA_USEBURSTSET))
+#define UDMA_USEBURSTCLR_R  (*UARTSim_Reg(SIM_UDMA_USEBURSTCLR))
+#define UDMA_REQMASKSET_R   (*UARTSim_Reg(SIM_UDMA_REQMASKSET))
+#define UDMA_REQMASKCLR_R   (*UARTSim_Reg(SIM_UDMA_REQMASKCLR))
+#define UDMA_ENASET_R       (*UARTSim_Reg(SIM_UDMA_ENASET))
+#define UDMA_ENACLR_R       (*UARTSim_Reg(SIM_UDMA_ENACLR))
+#define UDMA_ALTSET_R       (*UARTSim_Reg(SIM_UDMA_ALTSET))
+#define UDMA_ALTCLR_R       (*UARTSim_Reg(SIM_UDMA_ALTCLR))
+#define UDMA_PRIOCLR_R      (*UARTSim_Reg(SIM_UDMA_PRIOCLR))
+#define UDMA_CHIS_R         (*UARTSim_Reg(SIM_UDMA_CHIS))
+#define UDMA_CHMAP1_R       (*UARTSim_Reg(SIM_UDMA_CHMAP1))
+#define SYSCTL_RCGCUART_R   (*UARTSim_Reg(SIM_RCGCUART))
+#define SYSCTL_RCGCGPIO_R   (*UARTSim_Reg(SIM_RCGCGPIO))
+#define SYSCTL_RCGCDMA_R    (*UARTSim_Reg(SIM_RCGCDMA))
+#define SYSCTL_PRDMA_R      (*UARTSim_Reg(SIM_PRDMA))
+#define GPIO_PORTA_AFSEL_R  (*UARTSim_Reg(SIM_PORTA_AFSEL))
+#define GPIO_PORTA_DEN_R    (*UARTSim_Reg(SIM_PORTA_DEN))
+#define GPIO_PORTA_PCTL_R   (*UARTSim_Reg(SIM_PORTA_PCTL))
+#define GPIO_PORTA_AMSEL_R  (*UARTSim_Reg(SIM_PORTA_AMSEL))
+#define NVIC_PRI1_R         (*UARTSim_Reg(SIM_NVIC_PRI1))
+#define NVIC_EN0_R          (*UARTSim_Reg(SIM_NVIC_EN0))
+
+#define SIM_CLOCK  80000000     // bus clock, cycles per second
+
+typedef struct {
+  uint64_t cycles;        // time since UARTSim_Reset()
+  uint32_t interrupts;    // UART0_Handler() calls
+  uint32_t dmaRx, dmaTx;  // bytes moved by uDMA
+  uint32_t cpuRx;         // bytes the CPU read from UART0_DR_R
+  uint32_t overruns;      // received bytes lost, hardware FIFO full
+  uint32_t errors;        // driver mistakes, each printed when found
+} UARTSimStatsType;
+extern UARTSimStatsType UARTSimStats;
+
+//------------UARTSim_Reg------------
+// Storage of one register for the macros above, see UARTSim.c.
+volatile uint32_t *UARTSim_Reg(int reg);
+
+//------------UARTSim_Reset------------
+// Power-on state: registers zero, FIFOs and line empty, time 0.
+void UARTSim_Reset(void);
+
+//------------UARTSim_Run------------
+// Let time pass, shifting bytes, moving them with uDMA and calling
+// UART0_Handler() as they require.
+// Input: cycles of the 80 MHz bus clock
+void UARTSim_Run(uint64_t cycles);
+
+//------------UARTSim_Send------------
+// The computer sends bytes to the board, each starting as soon as the
+// line is free after the previous one and any idle time before it.
+// Input: data points to n bytes, idleBits of quiet line before the first
+void UARTSim_Send(const uint8_t *data, uint32_t n, uint32_t idleBits);
+
+//------------UARTSim_Received------------
+// Bytes the computer received from the board so far.
+// Input: times, if not null, gets the cycle each byte's stop bit ended
+// Output: pointer to them, *n gets the count
+const uint8_t *UARTSim_Received(uint32_t *n, const uint64_t **times);
+
+//------------UARTSim_Arrived------------
+// Cycle the stop bit of the k-th byte sent with UARTSim_Send() ended,
+// the moment it reached the hardware receive FIFO.
+uint64_t UARTSim_Arrived(uint32_t k);
+
+//------------UARTSim_BitCycles------------
+// Cycles in one bit at the programmed baud rate, 0 before UART_Init().
+uint32_t UARTSim_BitCycles(void);
+// Cycles in one character, start bit, 8 data bits and stop bit.
+uint32_t UARTSim_CharCycles(void);
+
+#endif
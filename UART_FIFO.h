@@ -7,28 +7,30 @@ void EndCritical(long sr);    // restore I bit to previous value
 typedef char tx_UARTDataType;
 typedef char rx_UARTDataType;
 
-// initialize index FIFO
+#define TX_UARTFIFOSIZE 512   // must be a power of 2, at most 1024 (one uDMA transfer)
+#define RX_UARTFIFOSIZE 256   // must be a power of 2
+#define UARTFIFOSUCCESS 1
+#define UARTFIFOFAIL    0
+
+// Transmit FIFO, threads put and uDMA sends straight out of it:
+// UART.c starts the TX channel on Tx_UARTFifo_Peek() and calls
+// Tx_UARTFifo_Skip() once the transfer is done.
 void Tx_UARTFifo_Init(void);
-// add element to end of index FIFO
-// return TXFIFOSUCCESS if successful
 int Tx_UARTFifo_Put(tx_UARTDataType data);
-// remove element from front of index FIFO
-// return TXFIFOSUCCESS if successful
-int Tx_UARTFifo_Get(tx_UARTDataType *datapt);
-// number of elements in index FIFO
-// 0 to TXFIFOSIZE-1
-unsigned short Tx_UARTFifo_Size(void);
+uint32_t Tx_UARTFifo_PutN(const tx_UARTDataType *data, uint32_t n);
+tx_UARTDataType *Tx_UARTFifo_Peek(uint32_t *n);
+void Tx_UARTFifo_Skip(uint32_t n);
+// number of elements in transmit FIFO
+// 0 to TX_UARTFIFOSIZE
+uint32_t Tx_UARTFifo_Size(void);
 
-// initialize pointer FIFO
+// Receive FIFO, UART0_Handler() puts what uDMA received, threads get
 void Rx_UARTFifo_Init(void);
-// add element to end of pointer FIFO
-// return RXFIFOSUCCESS if successful
-int Rx_UARTFifo_Put(rx_UARTDataType data);
-// remove element from front of pointer FIFO
-// return RXFIFOSUCCESS if successful
+uint32_t Rx_UARTFifo_PutN(const rx_UARTDataType *data, uint32_t n);
 int Rx_UARTFifo_Get(rx_UARTDataType *datapt);
-// number of elements in pointer FIFO
-// 0 to RXFIFOSIZE-1
-unsigned short Rx_UARTFifo_Size(void);
+uint32_t Rx_UARTFifo_GetN(rx_UARTDataType *data, uint32_t n);
+// number of elements in receive FIFO
+// 0 to RX_UARTFIFOSIZE
+uint32_t Rx_UARTFifo_Size(void);
 
 #endif
@@ -0,0 +1,220 @@
+// WaveSim.c
+// Host-side model of Wide Timer 0A, uDMA channel 10 and PWM1 generator
+// 3 for wave.c built with -DWAVE_SIM, see WaveSim.h.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "tm4c123gh6pm.h"
+#include "WaveSim.h"
+#include "uDMA.h"
+
+void WideTimer0A_Handler(void);
+
+#define CHANNEL     10
+#define BIT         (1u << CHANNEL)
+#define ENCODING    3             // Wide Timer 0A
+#define TAEN        0x01          // WTIMER0_CTL_R
+#define TATO        0x01          // WTIMER0_RIS_R and WTIMER0_IMR_R
+#define M1PWM6      0x40          // PWM1_ENABLE_R
+#define INT94       0x40000000    // NVIC_EN2_R, Wide Timer 0A
+#define SAMPLES_MAX (1 << 22)
+
+WaveSimStatsType WaveSimStats;
+
+static uint32_t Regs[SIM_REGS];
+static int Pending = -1;          // register of the last access, its write not applied yet
+static uint32_t Enabled, UseBurst, ReqMask, Alternate, Chis;
+static int Running;               // Wide Timer 0A counts
+static uint64_t Timeout;          // cycle of the next timeout while running
+static uint32_t Samples[SAMPLES_MAX];
+static int InHandler;
+
+static void error(const char *what){
+  WaveSimStats.errors++;
+  if(WaveSimStats.errors <= 10){
+    printf("  WaveSim at cycle %llu: %s\n", (unsigned long long)WaveSimStats.cycles, what);
+  }
+}
+
+// the write of the previous access takes effect
+static void commit(void){
+  uint32_t v;
+  if(Pending < 0) return;
+  v = Regs[Pending];
+  switch(Pending){
+    case SIM_WTIMER0_ICR:
+      Regs[SIM_WTIMER0_RIS] &= ~v;
+      break;
+    case SIM_WTIMER0_CTL:
+      if((v&TAEN) && !Running){
+        if((Regs[SIM_WTIMER0_CFG] != TIMER_CFG_16_BIT) || ((Regs[SIM_WTIMER0_TAMR]&3) != 2) ||
+           (Regs[SIM_WTIMER0_TAPR] != 0)){
+          error("Wide Timer 0A is not a 32-bit periodic timer");
+        }
+        Running = 1;
+        Timeout = WaveSimStats.cycles + Regs[SIM_WTIMER0_TAILR] + 1;
+      }else if(!(v&TAEN)){
+        Running = 0;
+      }
+      break;
+    case SIM_UDMA_USEBURSTSET: UseBurst |= v;  break;
+    case SIM_UDMA_USEBURSTCLR: UseBurst &= ~v; break;
+    case SIM_UDMA_REQMASKSET:  ReqMask |= v;   break;
+    case SIM_UDMA_REQMASKCLR:  ReqMask &= ~v;  break;
+    case SIM_UDMA_ENASET:      Enabled |= v;   break;
+    case SIM_UDMA_ENACLR:      Enabled &= ~v;  break;
+    case SIM_UDMA_ALTSET:      Alternate |= v; break;
+    case SIM_UDMA_ALTCLR:      Alternate &= ~v; break;
+    case SIM_UDMA_CHIS:        Chis &= ~v;     break;
+  }
+  Pending = -1;
+}
+
+volatile uint32_t *WaveSim_Reg(int reg){
+  commit();
+  switch(reg){
+    case SIM_UDMA_ENASET:
+      Regs[reg] = Enabled;
+      break;
+    case SIM_UDMA_CHIS:
+      Regs[reg] = Chis;
+      break;
+    case SIM_PRGPIO:
+      Regs[reg] = Regs[SIM_RCGCGPIO];
+      break;
+    case SIM_PRWTIMER:
+      Regs[reg] = Regs[SIM_RCGCWTIMER];
+      break;
+    case SIM_PRDMA:
+      Regs[reg] = Regs[SIM_RCGCDMA]&1;
+      break;
+    case SIM_WTIMER0_ICR: case SIM_UDMA_USEBURSTSET: case SIM_UDMA_USEBURSTCLR:
+    case SIM_UDMA_REQMASKSET: case SIM_UDMA_REQMASKCLR: case SIM_UDMA_ENACLR:
+    case SIM_UDMA_ALTSET: case SIM_UDMA_ALTCLR: case SIM_UDMA_PRIOCLR:
+      Regs[reg] = 0;                // write only
+      break;
+  }
+  Pending = reg;
+  return &Regs[reg];
+}
+
+void WaveSim_Reset(void){
+  memset(Regs, 0, sizeof(Regs));
+  memset(&WaveSimStats, 0, sizeof(WaveSimStats));
+  Pending = -1;
+  Enabled = UseBurst = ReqMask = Alternate = Chis = 0;
+  Running = InHandler = 0;
+  Timeout = 0;
+}
+
+const uint32_t *WaveSim_Samples(uint32_t *n){
+  *n = WaveSimStats.timeouts < SAMPLES_MAX ? WaveSimStats.timeouts : SAMPLES_MAX;
+  return Samples;
+}
+
+// the PWM output and the channel, checked once the driver has set them up
+static void check(void){
+  uint32_t load = Regs[SIM_PWM1_3_LOAD];
+  if(Regs[SIM_RCC]&SYSCTL_RCC_USEPWMDIV){
+    error("PWM clock divided, the carrier is not what LOAD says");
+  }
+  if(!(Regs[SIM_PWM1_3_CTL]&1) || (Regs[SIM_PWM1_3_GENA] != 0xC8) ||
+     !(Regs[SIM_PWM1_ENABLE]&M1PWM6)){
+    error("M1PWM6 not running");
+  }
+  if((load == 0) || (load > 0xFFFF) || (load + 1 > Regs[SIM_WTIMER0_TAILR] + 1)){
+    error("PWM1_3_LOAD_R not a 16-bit carrier at least as fast as the samples");
+  }
+  if(!(Regs[SIM_PORTF_AFSEL]&0x04) || ((Regs[SIM_PORTF_PCTL]&0xF00) != 0x500) ||
+     !(Regs[SIM_PORTF_DEN]&0x04)){
+    error("PF2 is not M1PWM6");
+  }
+  if(((Regs[SIM_UDMA_CHMAP1]&UDMA_CHMAP1_CH10SEL_M) >> UDMA_CHMAP1_CH10SEL_S) != ENCODING){
+    error("channel 10 is not mapped to Wide Timer 0A");
+  }
+  if((Enabled&BIT) && (Regs[SIM_UDMA_CTLBASE] != (uint32_t)(uintptr_t)DMA_Table)){
+    error("UDMA_CTLBASE_R is not DMA_Table");
+  }
+}
+
+// the request of one timeout, 1 if uDMA moved a word
+static int service(void){
+  uint32_t control, remaining, mode, want, duty;
+  DMA_ChannelType *c;
+  if(((Enabled&BIT) == 0) || (ReqMask&BIT) || ((Regs[SIM_UDMA_CFG]&UDMA_CFG_MASTEN) == 0)){
+    return 0;
+  }
+  c = (Alternate&BIT) ? DMA_ALTERNATE(CHANNEL) : DMA_PRIMARY(CHANNEL);
+  control = c->control;
+  mode = control&UDMA_CHCTL_XFERMODE_M;
+  if(mode == UDMA_CHCTL_XFERMODE_STOP){
+    Enabled &= ~BIT;                                // nothing armed, the channel stops
+    return 0;
+  }
+  if(mode != UDMA_CHCTL_XFERMODE_PINGPONG){
+    error("transfer mode is not ping-pong");
+  }
+  want = UDMA_CHCTL_DSTINC_NONE|UDMA_CHCTL_DSTSIZE_32|UDMA_CHCTL_SRCINC_32|UDMA_CHCTL_SRCSIZE_32;
+  if((control&0xFF000000) != want){
+    error("wrong increment or size in a control word");
+  }
+  if(c->dstEnd != (uintptr_t)&Regs[SIM_PWM1_3_CMPA]){
+    error("channel not pointed at PWM1_3_CMPA_R");
+  }
+  remaining = DMA_REMAINING(control);
+  duty = *(uint32_t *)(c->srcEnd - 4*(remaining - 1));
+  if((duty == 0) || (duty >= Regs[SIM_PWM1_3_LOAD])){
+    error("duty cycle out of 1 to LOAD-1");
+  }
+  Regs[SIM_PWM1_3_CMPA] = duty;
+  remaining--;
+  if(remaining){
+    c->control = (control&~UDMA_CHCTL_XFERSIZE_M)|((remaining - 1) << UDMA_CHCTL_XFERSIZE_S);
+  }else{
+    c->control = control&~(UDMA_CHCTL_XFERSIZE_M|UDMA_CHCTL_XFERMODE_M);
+    Chis |= BIT;
+    Alternate ^= BIT;                               // carry on with the other structure
+  }
+  return 1;
+}
+
+// the NVIC calls WideTimer0A_Handler() while uDMA done or a timeout is pending
+static void interrupts(void){
+  commit();
+  if(!InHandler && (Regs[SIM_NVIC_EN2]&INT94) &&
+     ((Chis&BIT) || (Regs[SIM_WTIMER0_RIS]&Regs[SIM_WTIMER0_IMR]&TATO))){
+    InHandler = 1;
+    WaveSimStats.interrupts++;
+    WideTimer0A_Handler();
+    commit();
+    InHandler = 0;
+    if((Chis&BIT) || (Regs[SIM_WTIMER0_RIS]&Regs[SIM_WTIMER0_IMR]&TATO)){
+      error("WideTimer0A_Handler() does not acknowledge its interrupt");
+      Chis = 0;
+      Regs[SIM_WTIMER0_RIS] = 0;
+    }
+  }
+}
+
+void WaveSim_Run(uint64_t cycles){
+  uint64_t end = WaveSimStats.cycles + cycles;
+  interrupts();
+  while(Running && (Timeout <= end)){
+    WaveSimStats.cycles = Timeout;
+    Timeout += (uint64_t)Regs[SIM_WTIMER0_TAILR] + 1;
+    Regs[SIM_WTIMER0_RIS] |= TATO;
+    if(WaveSimStats.timeouts == 0){
+      check();
+    }
+    if(!service()){
+      WaveSimStats.starved++;
+    }
+    if(WaveSimStats.timeouts < SAMPLES_MAX){
+      Samples[WaveSimStats.timeouts] = Regs[SIM_PWM1_3_CMPA];
+    }
+    WaveSimStats.timeouts++;
+    interrupts();
+  }
+  WaveSimStats.cycles = end;
+}
@@ -0,0 +1,153 @@
+#ifndef WAVESIM_H
+#define WAVESIM_H
+
+#include <stdint.h>
+
+// Host-side model of Wide Timer 0A, uDMA channel 10 and PWM1 generator
+// 3, for wave.c and uDMA.c built with -DWAVE_SIM.  Every register those
+// files touch becomes a call to WaveSim_Reg(), so the driver runs
+// unchanged against a periodic timer counting the 80 MHz bus clock
+// whose timeouts each make uDMA move one word, through the real control
+// words in DMA_Table, into PWM1_3_CMPA_R.  The duty cycle every timeout
+// leaves is logged, one per sample.  WideTimer0A_Handler() is called
+// the way the NVIC would when uDMA finishes a block, between steps of
+// the model; the driver's own code runs in no time.
+//
+// Register accesses follow the hardware: set and clear registers act on
+// the write, UDMA_ENASET_R reads the enabled channels, UDMA_CHIS_R and
+// WTIMER0_ICR_R clear the bits written.
+//
+// Host build of a program that uses the mixer, e.g.
+//   gcc -std=gnu99 -O2 -DWAVE_SIM -I. -o wavetest tools/wavetest.c wave.c uDMA.c WaveSim.c
+// WaveSim.c is not part of the Keil project.
+
+enum {
+  SIM_PWM1_3_CTL, SIM_PWM1_3_GENA, SIM_PWM1_3_LOAD, SIM_PWM1_3_CMPA, SIM_PWM1_ENABLE,
+  SIM_WTIMER0_CTL, SIM_WTIMER0_CFG, SIM_WTIMER0_TAMR, SIM_WTIMER0_TAILR, SIM_WTIMER0_TAPR,
+  SIM_WTIMER0_IMR, SIM_WTIMER0_RIS, SIM_WTIMER0_ICR,
+  SIM_UDMA_CFG, SIM_UDMA_CTLBASE, SIM_UDMA_USEBURSTSET, SIM_UDMA_USEBURSTCLR,
+  SIM_UDMA_REQMASKSET, SIM_UDMA_REQMASKCLR, SIM_UDMA_ENASET, SIM_UDMA_ENACLR,
+  SIM_UDMA_ALTSET, SIM_UDMA_ALTCLR, SIM_UDMA_PRIOCLR, SIM_UDMA_CHIS, SIM_UDMA_CHMAP1,
+  SIM_RCGCPWM, SIM_RCGCGPIO, SIM_PRGPIO, SIM_RCGCWTIMER, SIM_PRWTIMER, SIM_RCGCDMA, SIM_PRDMA,
+  SIM_RCC,
+  SIM_PORTF_AFSEL, SIM_PORTF_PCTL, SIM_PORTF_AMSEL, SIM_PORTF_DIR, SIM_PORTF_DEN,
+  SIM_NVIC_PRI23, SIM_NVIC_EN2,
+  SIM_REGS
+};
+
+#undef PWM1_3_CTL_R
+#undef PWM1_3_GENA_R
+#undef PWM1_3_LOAD_R
+#undef PWM1_3_CMPA_R
+#undef PWM1_ENABLE_R
+#undef WTIMER0_CTL_R
+#undef WTIMER0_CFG_R
+#undef WTIMER0_TAMR_R
+#undef WTIMER0_TAILR_R
+#undef WTIMER0_TAPR_R
+#undef WTIMER0_IMR_R
+#undef WTIMER0_RIS_R
+#undef WTIMER0_ICR_R
+#undef UDMA_CFG_R
+#undef UDMA_CTLBASE_R
+#undef UDMA_USEBURSTSET_R
+#undef UDMA_USEBURSTCLR_R
+#undef UDMA_REQMASKSET_R
+#undef UDMA_REQMASKCLR_R
+#undef UDMA_ENASET_R
+#undef UDMA_ENACLR_R
+#undef UDMA_ALTSET_R
+#undef UDMA_ALTCLR_R
+#undef UDMA_PRIOCLR_R
+#undef UDMA_CHIS_R
+#undef UDMA_CHMAP1_R
+#undef SYSCTL_RCGCPWM_R
+#undef SYSCTL_RCGCGPIO_R
+#undef SYSCTL_PRGPIO_R
+#undef SYSCTL_RCGCWTIMER_R
+#undef SYSCTL_PRWTIMER_R
+#undef SYSCTL_RCGCDMA_R
+#undef SYSCTL_PRDMA_R
+#undef SYSCTL_RCC_R
+#undef GPIO_PORTF_AFSEL_R
+#undef GPIO_PORTF_PCTL_R
+#undef GPIO_PORTF_AMSEL_R
+#undef GPIO_PORTF_DIR_R
+#undef GPIO_PORTF_DEN_R
+#undef NVIC_PRI23_R
+#undef NVIC_EN2_R
+#define PWM1_3_CTL_R        (*WaveSim_Reg(SIM_PWM1_3_CTL))
+#define PWM1_3_GENA_R       (*WaveSim_Reg(SIM_PWM1_3_GENA))
+#define PWM1_3_LOAD_R       (*WaveSim_Reg(SIM_PWM1_3_LOAD))
+#define PWM1_3_CMPA_R       (*WaveSim_Reg(SIM_PWM1_3_CMPA))
+#define PWM1_ENABLE_R       (*WaveSim_Reg(SIM_PWM1_ENABLE))
+#define WTIMER0_CTL_R       (*WaveSim_Reg(SIM_WTIMER0_CTL))
+#define WTIMER0_CFG_R       (*WaveSim_Reg(SIM_WTIMER0_CFG))
+#define WTIMER0_TAMR_R      (*WaveSim_Reg(SIM_WTIMER0_TAMR))
+#define WTIMER0_TAILR_R     (*WaveSim_Reg(SIM_WTIMER0_TAILR))
+#define WTIMER0_TAPR_R      (*WaveSim_Reg(SIM_WTIMER0_TAPR))
+#define WTIMER0_IMR_R       (*WaveSim_Reg(SIM_WTIMER0_IMR))
+#define WTIMER0_RIS_R       (*WaveSim_Reg(SIM_WTIMER0_RIS))
+#define WTIMER0_ICR_R       (*WaveSim_Reg(SIM_WTIMER0_ICR))
+#define UDMA_CFG_R          (*WaveSim_Reg(SIM_UDMA_CFG))
+#define UDMA_CTLBASE_R      (*WaveSim_Reg(SIM_UDMA_CTLBASE))
+#define UDMA_USEBURSTSET_R  (*WaveSim_Reg(SIM_UDMA_USEBURSTSET))
+#define UDMA_USEBURSTCLR_R  (*WaveSim_Reg(SIM_UDMA_USEBURSTCLR))
+#define UDMA_REQMASKSET_R   (*WaveSim_Reg(SIM_UDMA_REQMASKSET))
+#define UDMA_REQMASKCLR_R   (*WaveSim_Reg(SIM_UDMA_REQMASKCLR))
+#define UDMA_ENASET_R       (*WaveSim_Reg(SIM_UDMA_ENASET))
+#define UDMA_ENACLR_R       (*WaveSim_Reg(SIM_UDMA_ENACLR))
+#define UDMA_ALTSET_R       (*WaveSim_Reg(SIM_UDMA_ALTSET))
+#define UDMA_ALTCLR_R       (*WaveSim_Reg(SIM_UDMA_ALTCLR))
+#define UDMA_PRIOCLR_R      (*WaveSim_Reg(SIM_UDMA_PRIOCLR))
+#define UDMA_CHIS_R         (*WaveSim_Reg(SIM_UDMA_CHIS))
+#define UDMA_CHMAP1_R       (*WaveSim_Reg(SIM_UDMA_CHMAP1))
+#define SYSCTL_RCGCPWM_R    (*WaveSim_Reg(SIM_RCGCPWM))
+#define SYSCTL_RCGCGPIO_R   (*WaveSim_Reg(SIM_RCGCGPIO))
+#define SYSCTL_PRGPIO_R     (*WaveSim_Reg(SIM_PRGPIO))
+#define SYSCTL_RCGCWTIMER_R (*WaveSim_Reg(SIM_RCGCWTIMER))
+#define SYSCTL_PRWTIMER_R   (*WaveSim_Reg(SIM_PRWTIMER))
+#define SYSCTL_RCGCDMA_R    (*WaveSim_Reg(SIM_RCGCDMA))
+#define SYSCTL_PRDMA_R      (*WaveSim_Reg(SIM_PRDMA))
+#define SYSCTL_RCC_R        (*WaveSim_Reg(SIM_RCC))
+#define GPIO_PORTF_AFSEL_R  (*WaveSim_Reg(SIM_PORTF_AFSEL))
+#define GPIO_PORTF_PCTL_R   (*WaveSim_Reg(SIM_PORTF_PCTL))
+#define GPIO_PORTF_AMSEL_R  (*WaveSim_Reg(SIM_PORTF_AMSEL))
+#define GPIO_PORTF_DIR_R    (*WaveSim_Reg(SIM_PORTF_DIR))
+#define GPIO_PORTF_DEN_R    (*WaveSim_Reg(SIM_PORTF_DEN))
+#define NVIC_PRI23_R        (*WaveSim_Reg(SIM_NVIC_PRI23))
+#define NVIC_EN2_R          (*WaveSim_Reg(SIM_NVIC_EN2))
+
+#define SIM_CLOCK  80000000     // bus clock, cycles per second
+
+typedef struct {
+  uint64_t cycles;        // time since WaveSim_Reset()
+  uint32_t timeouts;      // Wide Timer 0A timeouts, samples logged
+  uint32_t interrupts;    // WideTimer0A_Handler() calls
+  uint32_t starved;       // timeouts uDMA had nothing for, the duty cycle stayed
+  uint32_t errors;        // driver mistakes, each printed when found
+} WaveSimStatsType;
+extern WaveSimStatsType WaveSimStats;
+
+//------------WaveSim_Reg------------
+// Storage of one register for the macros above, see WaveSim.c.
+volatile uint32_t *WaveSim_Reg(int reg);
+
+//------------WaveSim_Reset------------
+// Power-on state: registers zero, timer and channel stopped, sample log
+// empty, time 0.
+void WaveSim_Reset(void);
+
+//------------WaveSim_Run------------
+// Let time pass, timing out Wide Timer 0A, moving a word with uDMA at
+// each timeout and calling WideTimer0A_Handler() as it requires.
+// Input: cycles of the 80 MHz bus clock
+void WaveSim_Run(uint64_t cycles);
+
+//------------WaveSim_Samples------------
+// PWM1_3_CMPA_R after each timeout so far, the duty cycle of one
+// sample out of PWM1_3_LOAD_R.
+// Output: pointer to them, *n gets the count
+const uint32_t *WaveSim_Samples(uint32_t *n);
+
+#endif
@@ -0,0 +1,134 @@
+// board.c
+// Bitboard occupancy of the 6x6 game grid, see board.h.
+
+#include <stdint.h>
+#include "board.h"
+
+#ifdef HOST_SIM
+#define StartCritical() 0
+#define EndCritical(sr) ((void)(sr))
+#else
+long StartCritical(void);    // previous I bit, disable interrupts
+void EndCritical(long sr);   // restore I bit to previous value
+#endif
+
+// cells with y = 0 and y = 5; moving up or down must not cross them
+#define ROW_TOP    0x041041041ull
+#define ROW_BOTTOM 0x820820820ull
+
+// Board_Sweep() works in 1/1280 of a cell: a pixel is 60 units across
+// (6 columns in 128 pixels) and 66 units down (6.6 rows in 128 pixels)
+#define SWEEP_CELL 1280
+#define SWEEP_X    60
+#define SWEEP_Y    66
+
+volatile uint64_t BoardTaken;
+volatile uint8_t BoardOwner[BOARD_CELLS];
+
+void Board_Init(void){
+  int i;
+  long sr = StartCritical();
+  BoardTaken = 0;
+  for(i = 0; i < BOARD_CELLS; i++){
+    BoardOwner[i] = BOARD_FREE;
+  }
+  EndCritical(sr);
+}
+
+int Board_Claim(uint8_t cell, uint8_t owner){
+  int result = 1;
+  long sr = StartCritical();
+  if(!(BoardTaken & BOARD_BIT(cell))){
+    BoardTaken |= BOARD_BIT(cell);
+    BoardOwner[cell] = owner;
+  }else if(BoardOwner[cell] != owner){
+    result = 0;
+  }
+  EndCritical(sr);
+  return result;
+}
+
+void Board_Release(uint8_t cell){
+  long sr = StartCritical();
+  BoardTaken &= ~BOARD_BIT(cell);
+  BoardOwner[cell] = BOARD_FREE;
+  EndCritical(sr);
+}
+
+int Board_Move(uint8_t from, uint8_t to, uint8_t owner){
+  int result;
+  long sr = StartCritical();
+  if(BoardTaken & BOARD_BIT(to)){
+    result = (BoardOwner[to] == owner);
+    EndCritical(sr);
+    return result;
+  }
+  if((from < BOARD_CELLS) && (BoardOwner[from] == owner)){
+    BoardTaken &= ~BOARD_BIT(from);
+    BoardOwner[from] = BOARD_FREE;
+  }
+  BoardTaken |= BOARD_BIT(to);
+  BoardOwner[to] = owner;
+  EndCritical(sr);
+  return 1;
+}
+
+uint8_t Board_Take(uint8_t from, uint8_t to, uint8_t owner){
+  uint8_t previous;
+  long sr = StartCritical();
+  previous = BoardOwner[to];
+  if((from < BOARD_CELLS) && (from != to) && (BoardOwner[from] == owner)){
+    BoardTaken &= ~BOARD_BIT(from);
+    BoardOwner[from] = BOARD_FREE;
+  }
+  BoardTaken |= BOARD_BIT(to);
+  BoardOwner[to] = owner;
+  EndCritical(sr);
+  return previous;
+}
+
+uint64_t Board_Neighbors(uint64_t cells){
+  return (((cells << 6) | (cells >> 6)              // x+1 and x-1
+         | ((cells & ~ROW_BOTTOM) << 1)             // y+1
+         | ((cells & ~ROW_TOP) >> 1)) & BOARD_ALL); // y-1
+}
+
+uint64_t Board_FreeNeighbors(uint8_t cell){
+  return Board_Neighbors(BOARD_BIT(cell)) & ~BoardTaken;
+}
+
+static int clampCell(int32_t c){
+  return (c < 0) ? 0 : ((c > 5) ? 5 : c);
+}
+
+// grid traversal: step into the next column or row, whichever
+// boundary the segment reaches first, until the end cell
+int Board_Sweep(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t *cells){
+  int32_t fx = x0*SWEEP_X, fy = y0*SWEEP_Y;
+  int32_t dx = x1*SWEEP_X - fx, dy = y1*SWEEP_Y - fy;
+  int32_t cx = fx/SWEEP_CELL, cy = fy/SWEEP_CELL;
+  int32_t sx = (dx < 0) ? -1 : 1, sy = (dy < 0) ? -1 : 1;
+  int32_t ax = (dx < 0) ? -dx : dx, ay = (dy < 0) ? -dy : dy;
+  int32_t distX, distY;                 // to the next column and row boundary
+  int n, steps, count = 0;
+  uint8_t cell;
+  steps = (x1*SWEEP_X/SWEEP_CELL - cx)*sx + (y1*SWEEP_Y/SWEEP_CELL - cy)*sy;
+  distX = (sx > 0) ? (cx + 1)*SWEEP_CELL - fx : fx - cx*SWEEP_CELL;
+  distY = (sy > 0) ? (cy + 1)*SWEEP_CELL - fy : fy - cy*SWEEP_CELL;
+  cells[count++] = BOARD_CELL(clampCell(cx), clampCell(cy));
+  for(n = 0; n < steps; n++){
+    // distX/ax against distY/ay, cross multiplied
+    if(distX*ay <= distY*ax){
+      cx += sx;
+      distX += SWEEP_CELL;
+    }else{
+      cy += sy;
+      distY += SWEEP_CELL;
+    }
+    cell = BOARD_CELL(clampCell(cx), clampCell(cy));
+    if((cell != cells[count - 1]) && (count < BOARD_SWEEPMAX)){
+      cells[count++] = cell;            // rows past the grid clamp to y = 5
+    }
+  }
+  return count;
+}
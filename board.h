@@ -0,0 +1,86 @@
+#ifndef BOARD_H
+#define BOARD_H
+
+#include <stdint.h>
+
+// Occupancy of the 6x6 game grid.  Cell x,y is bit x*6+y of a 64-bit
+// board, and BoardOwner[] holds who took each cell, so the whole grid
+// costs 8 + 36 bytes instead of 36 semaphores of 72 bytes each.
+// Claim, release and move are done with interrupts disabled, so a
+// cube thread, the game loop and the cube engine can share the board.
+// Free-neighbor queries are shifts and masks on the 64-bit board.
+//
+// Host build (for tools/boardbench.c): compile with -DHOST_SIM, which
+// replaces the critical sections with nothing.
+
+#define BOARD_CELLS   36
+#define BOARD_FREE    0xFF          // BoardOwner[] value of an empty cell
+#define BOARD_ALL     0xFFFFFFFFFull // one bit per cell
+#define BOARD_CELL(x,y) ((x)*6 + (y))
+#define BOARD_BIT(cell) (1ull << (cell))
+#define BOARD_SWEEPMAX 11            // most cells one segment can cross
+
+extern volatile uint64_t BoardTaken;           // bit set for each claimed cell
+extern volatile uint8_t BoardOwner[BOARD_CELLS]; // owner of each cell, BOARD_FREE if none
+
+//------------Board_Init------------
+// Release every cell.
+// Input: none
+// Output: none
+void Board_Init(void);
+
+//------------Board_Claim------------
+// Take a free cell.
+// Input: cell  x*6+y, 0 to 35
+//        owner thread or cube number, 0 to 254
+// Output: 1 if the cell now belongs to owner (or already did), 0 if someone else has it
+int Board_Claim(uint8_t cell, uint8_t owner);
+
+//------------Board_Release------------
+// Free a cell, whoever holds it.
+// Input: cell x*6+y, 0 to 35
+// Output: none
+void Board_Release(uint8_t cell);
+
+//------------Board_Move------------
+// Take cell to and free cell from in one step, so no other thread can
+// see the owner on both or on neither.
+// Input: from  cell held by owner, BOARD_FREE if none
+//        to    cell to take
+//        owner thread or cube number, 0 to 254
+// Output: 1 if moved (or to was already owned by owner), 0 if to is taken
+int Board_Move(uint8_t from, uint8_t to, uint8_t owner);
+
+//------------Board_Take------------
+// Give a taken cell to a new owner and free the cell that new owner
+// held, in one step.  Used when the player hits a cube.
+// Input: from  cell held by owner, BOARD_FREE if none
+//        to    cell to take over
+//        owner new owner
+// Output: previous owner of to, BOARD_FREE if it was empty
+uint8_t Board_Take(uint8_t from, uint8_t to, uint8_t owner);
+
+//------------Board_Neighbors------------
+// Cells next to the given cells, left, right, above and below,
+// without wrapping around the edges of the grid.
+// Input: cells set of cells, one bit per cell
+// Output: set of neighbor cells
+uint64_t Board_Neighbors(uint64_t cells);
+
+//------------Board_FreeNeighbors------------
+// Free cells next to one cell.
+// Input: cell x*6+y, 0 to 35
+// Output: set of free neighbor cells, one bit per cell
+uint64_t Board_FreeNeighbors(uint8_t cell);
+
+//------------Board_Sweep------------
+// Cells crossed by the crosshair moving in a straight line from x0,y0
+// to x1,y1, in order, so a fast move cannot jump over a cube.  Pixels
+// map to cells like update() in Main.c: x*6/128 and y*66/1280.
+// Input: x0,y0 previous crosshair position in pixels, 0 to 127
+//        x1,y1 new crosshair position in pixels, 0 to 127
+//        cells array of at least BOARD_SWEEPMAX entries
+// Output: number of cells written, cells[0] is the cell of x0,y0
+int Board_Sweep(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t *cells);
+
+#endif
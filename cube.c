@@ -0,0 +1,116 @@
+// cube.c
+// Single-thread cube engine, see cube.h.
+// The state of cube i is spread over one array per field, so a step
+// walks short byte arrays instead of 36 thread control blocks.  Cells
+// are claimed on the board in board.c with the cube index as owner.
+
+#include <stdint.h>
+#include "board.h"
+#include "cube.h"
+
+uint8_t CubeX[CUBE_MAX];
+uint8_t CubeY[CUBE_MAX];
+uint8_t CubeDir[CUBE_MAX];
+uint8_t CubeColor[CUBE_MAX];
+uint8_t CubeAlive[CUBE_MAX];
+uint16_t CubeWait[CUBE_MAX];
+CubeDrawType CubeDrawList[CUBE_DRAWMAX];
+uint32_t CubeDrawCount;
+uint32_t CubeBlocked;
+
+static uint32_t Count;              // cubes with CubeAlive[] != CUBE_DEAD
+
+// step of each direction, same order as addTile()
+static const int8_t DirX[4] = {1, -1, 0, 0};
+static const int8_t DirY[4] = {0, 0, 1, -1};
+
+static void queue(uint8_t cell, uint8_t color){
+  if(CubeDrawCount < CUBE_DRAWMAX){
+    CubeDrawList[CubeDrawCount].cell = cell;
+    CubeDrawList[CubeDrawCount].color = color;
+    CubeDrawCount++;
+  }
+}
+
+void Cube_Init(void){
+  int i;
+  for(i = 0; i < CUBE_MAX; i++){
+    CubeAlive[i] = CUBE_DEAD;
+  }
+  Board_Init();
+  Count = 0;
+  CubeDrawCount = 0;
+}
+
+int Cube_Spawn(uint8_t x, uint8_t y, uint8_t dir, uint8_t color){
+  uint8_t cell = x*6 + y;
+  int i;
+  if((x > 5) || (y > 5) || (BoardTaken & BOARD_BIT(cell))) return -1;
+  for(i = 0; i < CUBE_MAX; i++){
+    if((CubeAlive[i] == CUBE_DEAD) && Board_Claim(cell, i)){
+      CubeX[i] = x;
+      CubeY[i] = y;
+      CubeDir[i] = dir & 3;
+      CubeColor[i] = color;
+      CubeWait[i] = CUBE_MOVE_MS;
+      CubeAlive[i] = CUBE_LIVE;
+      Count++;
+      queue(cell, color);
+      return i;
+    }
+  }
+  return -1;
+}
+
+int Cube_Hit(uint8_t x, uint8_t y){
+  uint8_t i;
+  if((x > 5) || (y > 5)) return 0;
+  i = BoardOwner[x*6 + y];
+  if((i == BOARD_FREE) || (CubeAlive[i] != CUBE_LIVE)) return 0;
+  CubeAlive[i] = CUBE_HIT;
+  return 1;
+}
+
+uint32_t Cube_Step(uint32_t ms){
+  uint32_t removed = 0;
+  int i, nx, ny;
+  uint8_t next;
+  for(i = 0; i < CUBE_MAX; i++){
+    if(CubeAlive[i] == CUBE_DEAD) continue;
+    if(CubeAlive[i] == CUBE_HIT){
+      // the game loop clears only the middle of the tile when it scores
+      // the hit, the whole of it goes here
+      Board_Release(CubeX[i]*6 + CubeY[i]);
+      queue(CubeX[i]*6 + CubeY[i], CUBE_ERASE);
+      CubeAlive[i] = CUBE_DEAD;
+      Count--;
+      removed++;
+      continue;
+    }
+    if(CubeWait[i] > ms){
+      CubeWait[i] = CubeWait[i] - ms;
+      continue;
+    }
+    CubeWait[i] = 0;                // try again next step if blocked
+    nx = CubeX[i] + DirX[CubeDir[i]];
+    ny = CubeY[i] + DirY[CubeDir[i]];
+    CubeDir[i] = (CubeDir[i] + 1) & 3;
+    if((nx < 0) || (nx > 5) || (ny < 0) || (ny > 5)) continue;
+    next = nx*6 + ny;
+    if(!Board_Move(CubeX[i]*6 + CubeY[i], next, i)){
+      CubeBlocked++;                // the cell is held by a cube or the player
+      continue;
+    }
+    queue(CubeX[i]*6 + CubeY[i], CUBE_ERASE);
+    CubeX[i] = nx;
+    CubeY[i] = ny;
+    CubeColor[i] = (CubeColor[i] + 1) % CUBE_COLORS;  // next color, like addTile()
+    queue(next, CubeColor[i]);
+    CubeWait[i] = CUBE_MOVE_MS;
+  }
+  return removed;
+}
+
+uint32_t Cube_Count(void){
+  return Count;
+}
@@ -0,0 +1,79 @@
+#ifndef CUBE_H
+#define CUBE_H
+
+#include <stdint.h>
+
+// Cube engine: every cube of the game in one set of arrays, stepped once per
+// game frame, instead of one addTile() thread (and one 400 byte
+// stack) per cube.  Cube i is described by CubeX[i], CubeY[i],
+// CubeDir[i], CubeColor[i] and CubeAlive[i]; cells of the 6x6 grid are
+// numbered x*6+y and claimed on the board in board.c.
+// The engine does not touch the LCD.  Each spawn and move appends
+// commands to CubeDrawList[], and the caller sends the whole batch
+// under one LCDFree hold.  All calls must be made with LCDFree held,
+// the same lock that addTile() and the game loop use for the cells.
+
+#define CUBE_MAX      36    // one cube per cell at most
+#define CUBE_MOVE_MS  3000  // time a cube rests after a move, like the rest in addTile()
+#define CUBE_COLORS   20    // entries in the game color table, colors[] in Main.c
+#define CUBE_ERASE    0xFF  // CubeDrawType color that means the game background
+#define CUBE_DRAWMAX  (3*CUBE_MAX) // a spawn, or an erase and a draw per cube
+
+#define CUBE_DEAD     0     // values of CubeAlive[]
+#define CUBE_LIVE     1
+#define CUBE_HIT      2     // hit by the player, removed at the next step
+
+typedef struct {
+  uint8_t cell;             // x*6+y of the 21x21 tile to fill
+  uint8_t color;            // index into the game color table, or CUBE_ERASE
+} CubeDrawType;
+
+extern uint8_t CubeX[CUBE_MAX];      // column of each cube, 0 to 5
+extern uint8_t CubeY[CUBE_MAX];      // row of each cube, 0 to 5
+extern uint8_t CubeDir[CUBE_MAX];    // next direction to try, 0 right, 1 left, 2 down, 3 up
+extern uint8_t CubeColor[CUBE_MAX];  // index into the game color table
+extern uint8_t CubeAlive[CUBE_MAX];  // CUBE_DEAD, CUBE_LIVE or CUBE_HIT
+extern uint16_t CubeWait[CUBE_MAX];  // ms until the cube tries to move again
+extern CubeDrawType CubeDrawList[CUBE_DRAWMAX];
+extern uint32_t CubeDrawCount;       // commands in CubeDrawList[], cleared by the caller
+extern uint32_t CubeBlocked;         // moves refused because the cell was taken
+
+//------------Cube_Init------------
+// Remove every cube and empty the draw list.
+// Input: none
+// Output: none
+void Cube_Init(void);
+
+//------------Cube_Spawn------------
+// Put a new cube on a free cell and queue its first draw.
+// Input: x     column 0 to 5
+//        y     row 0 to 5
+//        dir   first direction to try, 0 to 3
+//        color index into the game color table
+// Output: cube index, -1 if the cell is taken or there is no free slot
+int Cube_Spawn(uint8_t x, uint8_t y, uint8_t dir, uint8_t color);
+
+//------------Cube_Hit------------
+// Check the cell under the crosshair.  A live cube there is marked
+// hit; it keeps the cell until the next Cube_Step(), like a hit
+// addTile() thread keeps its semaphore until it notices.
+// Input: x column 0 to 5
+//        y row 0 to 5
+// Output: 1 if a live cube was hit, 0 otherwise
+int Cube_Hit(uint8_t x, uint8_t y);
+
+//------------Cube_Step------------
+// Advance every cube by ms milliseconds.  A cube whose wait is over
+// tries the neighbor cell in its current direction and turns to the
+// next direction either way, which is the addTile() walk.  A move
+// queues an erase of the old tile and a draw of the new one.
+// Input: ms time since the last step
+// Output: number of hit cubes removed in this step
+uint32_t Cube_Step(uint32_t ms);
+
+//------------Cube_Count------------
+// Input: none
+// Output: number of cubes on the board, hit or not
+uint32_t Cube_Count(void);
+
+#endif
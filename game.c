@@ -0,0 +1,208 @@
+// game.c
+// Game state and rules, see game.h.
+
+#include <stdint.h>
+#include "board.h"
+#include "cube.h"
+#include "game.h"
+#if !CUBE_ENGINE
+#ifdef HOST_SIM
+#error "the host build needs CUBE_ENGINE 1"
+#endif
+#include "os.h"
+#endif
+
+#define POLY_MASK_32 0xB4BCD35C
+#define POLY_MASK_31 0x7A5BC2E3
+
+int game_type = 0;
+int game_mode = 0;
+int nrounds = 0;
+int scores;
+uint16_t origin[2];
+uint32_t lfsr32, lfsr31;
+
+uint32_t GameMs;
+uint32_t RoundMs;
+uint64_t HitCells;
+int16_t aimX = 63;
+int16_t aimY = 63;
+uint8_t AimPath[AIM_PATHMAX];
+int AimCount;
+GameStatsType GameStats;
+
+// moved from Main.c as it was, there is no shift
+static uint32_t shift_lfsr(uint32_t *lfsr, uint32_t polynomial_mask){
+  int feedback = *lfsr & 1;
+  if(feedback == 1){
+    *lfsr ^= polynomial_mask;
+  }
+  return *lfsr;
+}
+
+int next_rand(int bounds){
+  // using constant (lfsr32) ^ seed value to make even random number
+  return ((shift_lfsr(&lfsr32, POLY_MASK_32) ^ shift_lfsr(&lfsr31, POLY_MASK_31))&0xFFFF) % bounds;
+}
+
+// crosshair speed for one axis deflection of i*64 to i*64+63, zero
+// below JOY_DEADZONE/2 so a straight push does not drift sideways,
+// then JOY_SPEED_MIN rising on a square to JOY_SPEED_MAX
+#define JOY_AXISZONE (JOY_DEADZONE/2)
+#define JOY_CURVE(i) ((((i)*64 + 32) < JOY_AXISZONE) ? 0 : \
+  (JOY_SPEED_MIN + (JOY_SPEED_MAX - JOY_SPEED_MIN)* \
+   ((i)*64 + 32 - JOY_AXISZONE)*((i)*64 + 32 - JOY_AXISZONE)/ \
+   ((2048 - JOY_AXISZONE)*(2048 - JOY_AXISZONE))))
+const uint8_t JoyCurve[32] = {
+  JOY_CURVE(0),  JOY_CURVE(1),  JOY_CURVE(2),  JOY_CURVE(3),
+  JOY_CURVE(4),  JOY_CURVE(5),  JOY_CURVE(6),  JOY_CURVE(7),
+  JOY_CURVE(8),  JOY_CURVE(9),  JOY_CURVE(10), JOY_CURVE(11),
+  JOY_CURVE(12), JOY_CURVE(13), JOY_CURVE(14), JOY_CURVE(15),
+  JOY_CURVE(16), JOY_CURVE(17), JOY_CURVE(18), JOY_CURVE(19),
+  JOY_CURVE(20), JOY_CURVE(21), JOY_CURVE(22), JOY_CURVE(23),
+  JOY_CURVE(24), JOY_CURVE(25), JOY_CURVE(26), JOY_CURVE(27),
+  JOY_CURVE(28), JOY_CURVE(29), JOY_CURVE(30), JOY_CURVE(31)
+};
+
+static uint16_t JoyCenter[2] = {2048, 2048};
+static int32_t JoyFilter[2];      // deflection from JoyCenter, 1/16 ADC units
+
+void Game_Calibrate(uint16_t rawX, uint16_t rawY){
+  JoyCenter[0] = rawX;
+  JoyCenter[1] = rawY;
+  JoyFilter[0] = JoyFilter[1] = 0;
+  origin[0] = 63 << JOY_PIXEL;
+  origin[1] = 63 << JOY_PIXEL;
+}
+
+// one axis of the IIR filter, rounded toward zero so that a push left
+// moves exactly as far as the same push right
+static void joyFilter(int32_t *f, int32_t deflection){
+  int32_t e = deflection*16 - *f;
+  *f += (e >= 0) ? (e >> JOY_FILTER) : -((-e) >> JOY_FILTER);
+}
+
+// speed of one filtered axis, sign included
+static int32_t joySpeed(int32_t f){
+  uint32_t i = ((f < 0) ? -f : f) >> 10;     // 1/16 ADC units to 64 ADC units
+  if(i > 31) i = 31;
+  return (f < 0) ? -JoyCurve[i] : JoyCurve[i];
+}
+
+void Game_Joystick(uint16_t rawX, uint16_t rawY, int16_t *x, int16_t *y){
+  int32_t fx, fy;
+  int32_t px = origin[0], py = origin[1];
+  // deflection, y grows with the stick pulled down
+  joyFilter(&JoyFilter[0], (int32_t)rawX - JoyCenter[0]);
+  joyFilter(&JoyFilter[1], (int32_t)JoyCenter[1] - rawY);
+  fx = ((JoyFilter[0] < 0) ? -JoyFilter[0] : JoyFilter[0]) >> 4;
+  fy = ((JoyFilter[1] < 0) ? -JoyFilter[1] : JoyFilter[1]) >> 4;
+  // radial dead zone, then the speed curve on each axis
+  if(fx*fx + fy*fy >= JOY_DEADZONE*JOY_DEADZONE){
+    px += joySpeed(JoyFilter[0]);
+    py += joySpeed(JoyFilter[1]);
+  }
+  // boundary condition on all four sides of the frame
+  if(px >= 4050) px = 4050;
+  if(px <= 50) px = 50;
+  if(py <= 50) py = 50;
+  if(py >= 3550) py = 3550;
+  origin[0] = px;
+  origin[1] = py;
+  // 1/32 pixels to pixels
+  *x = px >> JOY_PIXEL;
+  *y = py >> JOY_PIXEL;
+}
+
+void Game_Start(void){
+  scores = 0;
+  if(game_mode == 0){nrounds = 50;}
+  if(game_mode == 1){nrounds = 100;}
+  if(game_mode == 2){nrounds = 200;}
+  GameMs = 0;
+  RoundMs = 0;
+  HitCells = 0;
+  AimCount = 0;
+  GameStats.frames = GameStats.steps = GameStats.swept = GameStats.hits = 0;
+#if CUBE_ENGINE
+  Cube_Init();
+#endif
+}
+
+void Game_Aim(int16_t x, int16_t y){
+  uint8_t cells[BOARD_SWEEPMAX];
+  int i, n;
+  n = Board_Sweep(aimX, aimY, x, y, cells);
+  if(AimCount == 0){
+    AimPath[AimCount++] = cells[0];
+  }
+  for(i = 1; i < n; i++){
+    // a long stall keeps the start and the newest cells
+    if(AimCount == AIM_PATHMAX){
+      AimCount--;
+    }
+    AimPath[AimCount++] = cells[i];
+  }
+  aimX = x;
+  aimY = y;
+}
+
+// a fast sweep cannot jump over a cube, every crossed cell is tested
+int Game_Update(void){
+  int i, hits = 0;
+  int newx, newy;
+  GameStats.frames++;
+  for(i = 1; i < AimCount; i++){
+    newx = AimPath[i] / 6;
+    newy = AimPath[i] % 6;
+    GameStats.swept++;
+    // a cell someone else holds is a cube, checkSemaPt() returns 0
+#if CUBE_ENGINE
+    if(Cube_Hit(newx, newy)){
+#else
+    if(!checkSemaPt(newx, newy)){
+      score(newx, newy);
+#endif
+      scores++;
+      hits++;
+      HitCells |= BOARD_BIT(AimPath[i]);
+    }
+  }
+  AimCount = 0;
+  GameStats.hits += hits;
+  return hits;
+}
+
+#if CUBE_ENGINE
+// move every cube one step, the caller draws CubeDrawList[]
+static void cubeStep(void){
+  uint32_t i, removed;
+  // five cubes mode keeps four on the board, Solus keeps one
+  uint32_t target = (game_type == 1) ? 1 : 4;
+  removed = Cube_Step(FRAME_MS);
+  // a few tries at random cells, a taken cell is refused
+  for(i = 0; (Cube_Count() < target) && (i < 8); i++){
+    Cube_Spawn(next_rand(6), next_rand(6), next_rand(4), next_rand(CUBE_COLORS));
+  }
+  // a hit addTile thread scores one more point as it exits, keep that rule
+  scores += removed;
+}
+#endif
+
+void Game_Step(void){
+  GameStats.steps++;
+  GameMs += FRAME_MS;
+  if(GameMs - RoundMs >= ROUND_MS){
+    RoundMs += ROUND_MS;
+    if(nrounds > 0){
+      nrounds--;          // ex: 50 nrounds last 25 seconds
+    }
+  }
+#if CUBE_ENGINE
+  cubeStep();
+#endif
+}
+
+int Game_Over(void){
+  return (nrounds == 0) && (game_mode != 3);
+}
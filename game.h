@@ -0,0 +1,110 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include <stdint.h>
+
+// Game state and rules, apart from the RTOS threads and the LCD: the
+// joystick integration, the random numbers, the swept hit test, the
+// round clock and (with CUBE_ENGINE) the cubes.  Main.c runs it from
+// the game loop and draws the result; tools/gamesim.c runs it headless
+// on the host with simulated time and a scripted player.
+// Game_Update() and Game_Step() must be called with LCDFree held on
+// the target, like the cube engine in cube.c.
+//
+// Host build: compile with -DHOST_SIM -DCUBE_ENGINE=1.  The addTile()
+// threads of CUBE_ENGINE 0 need the RTOS.
+
+#ifndef CUBE_ENGINE
+#define CUBE_ENGINE 0       // 1 to move all cubes from the game loop (cube.c) instead of one addTile thread each
+#endif
+#define FRAME_MS    20      // one game frame, 50 Hz
+#define ROUND_MS    500     // nrounds counts down once per ROUND_MS of game time
+#define AIM_PATHMAX 32      // cells kept in AimPath[] per frame
+
+// joystick pipeline of Game_Joystick(), see JoyCurve[] in game.c
+#define JOY_DEADZONE  320   // radius around the calibrated center that does not move, ADC units
+#define JOY_FILTER    1     // IIR smoothing, each sample moves the filter 1/2^JOY_FILTER of the way
+#define JOY_SPEED_MIN 2     // crosshair speed just past the dead zone, 1/32 pixels per sample
+#define JOY_SPEED_MAX 24    // crosshair speed at full deflection, was 6 at any deflection
+#define JOY_PIXEL     5     // origin[] is in 1/2^JOY_PIXEL pixels
+
+extern int game_type;       // 0 -> five cubes, 1 -> one cube (Solus)
+extern int game_mode;       // 0 -> 50, 1 -> 100, 2 -> 200 rounds, 3 -> endless
+extern int nrounds;         // rounds left, one per ROUND_MS
+extern int scores;          // score of the current game
+extern uint16_t origin[2];  // crosshair position, 1/32 pixels
+extern uint32_t lfsr32, lfsr31; // random number state
+
+extern uint32_t GameMs;     // game time in ms, advances FRAME_MS per step
+extern uint32_t RoundMs;    // game time of the last nrounds count down
+extern uint64_t HitCells;   // cells hit and not yet drawn, one bit per cell
+extern int16_t aimX, aimY;  // newest crosshair position, pixels
+extern uint8_t AimPath[AIM_PATHMAX]; // cells crossed since the last Game_Update(), in order
+extern int AimCount;        // entries in AimPath[], AimPath[0] is where it started
+
+typedef struct {
+  uint32_t frames;          // calls to Game_Update()
+  uint32_t steps;           // calls to Game_Step()
+  uint32_t swept;           // cells tested for a hit
+  uint32_t hits;            // cubes hit
+} GameStatsType;
+extern GameStatsType GameStats;  // cleared by Game_Start()
+
+//------------next_rand------------
+// Next pseudo random number from the two LFSRs.
+// Input: bounds number of values
+// Output: 0 to bounds-1
+int next_rand(int bounds);
+
+extern const uint8_t JoyCurve[32];  // speed for each 64 ADC units of deflection
+
+//------------Game_Calibrate------------
+// Take the joystick at rest as its center, clear the filter and put
+// the crosshair at 63,63.
+// Input: rawX,rawY joystick ADC values at rest, 0 to 4095
+// Output: none
+void Game_Calibrate(uint16_t rawX, uint16_t rawY);
+
+//------------Game_Joystick------------
+// Move the crosshair from one joystick sample: deflection from the
+// calibrated center, IIR filter, radial dead zone and the JoyCurve[]
+// speed on each axis, clamped to the game area.  Shifts and a table,
+// no divides, it runs in the ADC interrupt.
+// Input: rawX,rawY joystick ADC values, 0 to 4095
+//        x,y       crosshair position in pixels
+// Output: none
+void Game_Joystick(uint16_t rawX, uint16_t rawY, int16_t *x, int16_t *y);
+
+//------------Game_Start------------
+// Start a game of game_type and game_mode: score, rounds, clock and
+// (with CUBE_ENGINE) the cubes.  The seed and aimX,aimY are kept.
+// Input: none
+// Output: none
+void Game_Start(void);
+
+//------------Game_Aim------------
+// Add the cells crossed from aimX,aimY to x,y to AimPath[].
+// Input: x,y new crosshair position in pixels
+// Output: none
+void Game_Aim(int16_t x, int16_t y);
+
+//------------Game_Update------------
+// Hit test every cell in AimPath[] after the first, then clear it.
+// Cells hit are added to HitCells.
+// Input: none
+// Output: number of cubes hit
+int Game_Update(void);
+
+//------------Game_Step------------
+// One FRAME_MS step of the game clock, the round count down and
+// (with CUBE_ENGINE) the cubes.
+// Input: none
+// Output: none
+void Game_Step(void);
+
+//------------Game_Over------------
+// Input: none
+// Output: 1 if the rounds ran out, never in the endless mode
+int Game_Over(void);
+
+#endif
@@ -1,5 +1,6 @@
 #include <stdint.h>
 #include "joystick.h"
+#include "trace.h"
 #include "tm4c123gh6pm.h"
 
 void DisableInterrupts(void); // Disable interrupts
@@ -81,3 +82,64 @@ void BSP_Joystick_Input(uint16_t *x, uint16_t *y, uint8_t *select){
   *select = SELECT;                // return 0(pressed) or 0x10(not pressed)
   ADC0_ISC_R = 0x0002;             // 4) acknowledge completion
 }
+
+// ------------BSP_Joystick_InitTimed------------
+// Sample the joystick every period without the CPU:
+// Timer0A triggers sequencer 1, the ADC averages
+// 2^JOYSTICK_AVG conversions of each axis, and the
+// sequencer 1 interrupt hands the result to task.
+// BSP_Joystick_Input() must not be used afterwards.
+// Input: task     called from the interrupt with X and Y (0 to 4095)
+//        period   in bus cycles (12.5ns), at least 300 us
+//        priority of the ADC0 sequencer 1 interrupt, 0 is the highest
+// Output: none
+// Assumes: BSP_Joystick_Init() has been called
+static void (*JoystickTask)(uint16_t x, uint16_t y);
+static uint32_t JoystickPeriod;
+JoystickStatsType JoystickStats;
+
+void BSP_Joystick_InitTimed(void(*task)(uint16_t x, uint16_t y), uint32_t period, uint32_t priority){
+  long sr = StartCritical();
+  JoystickTask = task;
+  JoystickPeriod = period;
+  JoystickStats.samples = 0;
+  JoystickStats.latencyMin = 0xFFFFFFFF;
+  JoystickStats.latencyMax = 0;
+  JoystickStats.isrMax = 0;
+  SYSCTL_RCGCTIMER_R |= 0x01;      // 1) activate timer0
+  while((SYSCTL_PRTIMER_R&0x01) == 0){};
+  TIMER0_CTL_R = 0x00000000;       // 2) disable timer0A during setup
+  TIMER0_CFG_R = TIMER_CFG_32_BIT_TIMER;
+  TIMER0_TAMR_R = TIMER_TAMR_TAMR_PERIOD;
+  TIMER0_TAILR_R = period - 1;     // 3) reload value
+  TIMER0_TAPR_R = 0;
+  TIMER0_IMR_R = 0x00000000;       // 4) no timer interrupt, it only triggers the ADC
+  ADC0_ACTSS_R &= ~0x0002;         // 5) disable sample sequencer 1
+  ADC0_SAC_R = JOYSTICK_AVG;       // 6) hardware averaging, every sequencer of ADC0
+  ADC0_EMUX_R = (ADC0_EMUX_R&~ADC_EMUX_EM1_M)|ADC_EMUX_EM1_TIMER;// 7) seq1 is timer trigger
+  ADC0_ISC_R = 0x0002;             // 8) clear a result left by BSP_Joystick_Input()
+  ADC0_IM_R |= 0x0002;             // 9) enable SS1 interrupts
+  ADC0_ACTSS_R |= 0x0002;          // 10) enable sample sequencer 1
+  NVIC_PRI7_R = (NVIC_PRI7_R&0x00FFFFFF)|(priority << 29);// 11) bits 31-29 for interrupt 31
+  NVIC_EN0_R = NVIC_EN0_INT31;     // 12) enable interrupt 31 in NVIC
+  TIMER0_CTL_R = TIMER_CTL_TAOTE|TIMER_CTL_TAEN;// 13) enable timer0A with trigger output
+  EndCritical(sr);
+}
+
+// Timer0A counts down from the reload value the trigger
+// started, so period-1-TAV is the time since the trigger.
+void ADC0Seq1_Handler(void){
+  uint32_t start = JoystickPeriod - 1 - TIMER0_TAV_R;
+  uint16_t x, y;
+  TRACE(TRACE_ISR_ENTER, TRACE_CURRENT, TRACE_IRQ_ADC0SS1);
+  ADC0_ISC_R = 0x0002;             // acknowledge completion
+  x = ADC0_SSFIFO1_R;
+  y = ADC0_SSFIFO1_R;
+  (*JoystickTask)(x, y);
+  JoystickStats.samples++;
+  if(start < JoystickStats.latencyMin) JoystickStats.latencyMin = start;
+  if(start > JoystickStats.latencyMax) JoystickStats.latencyMax = start;
+  start = JoystickPeriod - 1 - TIMER0_TAV_R - start;
+  if(start > JoystickStats.isrMax) JoystickStats.isrMax = start;
+  TRACE(TRACE_ISR_EXIT, TRACE_CURRENT, TRACE_IRQ_ADC0SS1);
+}
@@ -1,4 +1,3 @@
-<<<<<<< HEAD
 // ------------BSP_Joystick_Init------------
 // Initialize a GPIO pin for input, which corresponds
 // with BoosterPack pin J1.5 (Select button).
@@ -20,26 +19,31 @@ void BSP_Joystick_Init(void);
 // Output: none
 // Assumes: BSP_Joystick_Init() has been called
 void BSP_Joystick_Input(uint16_t *x, uint16_t *y, uint8_t *select);
-=======
-// ------------BSP_Joystick_Init------------
-// Initialize a GPIO pin for input, which corresponds
-// with BoosterPack pin J1.5 (Select button).
-// Initialize two ADC pins, which correspond with
-// BoosterPack pins J1.2 (X) and J3.26 (Y).
-// Input: none
-// Output: none
-void BSP_Joystick_Init(void);
 
-// ------------BSP_Joystick_Input------------
-// Read and return the immediate status of the
-// joystick.  Button de-bouncing for the Select
-// button is not considered.  The joystick X- and
-// Y-positions are returned as 10-bit numbers,
-// even if the ADC on the LaunchPad is more precise.
-// Input: x is pointer to store X-position (0 to 1023)
-//        y is pointer to store Y-position (0 to 1023)
-//        select is pointer to store Select status (0 if pressed)
+#define JOYSTICK_AVG 4   // ADC0_SAC_R, 2^4 = 16 conversions averaged per result
+
+// Timing of the timer triggered samples, in bus cycles (12.5ns).
+// The latency runs from the Timer0A trigger to the interrupt and
+// includes the 2*16 conversions (256 us at 125K samples/sec),
+// latencyMax-latencyMin is the jitter of each sample's delivery.
+// The samples themselves are taken exactly one period apart.
+typedef struct {
+  uint32_t samples;      // interrupts taken
+  uint32_t latencyMin;   // earliest interrupt after its trigger
+  uint32_t latencyMax;   // latest interrupt after its trigger
+  uint32_t isrMax;       // longest ADC0Seq1_Handler(), task included
+} JoystickStatsType;
+extern JoystickStatsType JoystickStats;
+
+// ------------BSP_Joystick_InitTimed------------
+// Sample the joystick every period without the CPU:
+// Timer0A triggers sequencer 1, the ADC averages
+// 2^JOYSTICK_AVG conversions of each axis, and the
+// sequencer 1 interrupt hands the result to task.
+// BSP_Joystick_Input() must not be used afterwards.
+// Input: task     called from the interrupt with X and Y (0 to 4095)
+//        period   in bus cycles (12.5ns), at least 300 us
+//        priority of the ADC0 sequencer 1 interrupt, 0 is the highest
 // Output: none
 // Assumes: BSP_Joystick_Init() has been called
-void BSP_Joystick_Input(uint16_t *x, uint16_t *y, uint8_t *select);
->>>>>>> c04fcbc29e5c1dd4d5927ac8e56ea208d393528c
+void BSP_Joystick_InitTimed(void(*task)(uint16_t x, uint16_t y), uint32_t period, uint32_t priority);
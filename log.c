@@ -0,0 +1,117 @@
+// log.c
+// Deferred logging into LogRing, drained to UART0 in telemetry frames, see log.h.
+
+#include <stdint.h>
+#include "os.h"
+#include "telemetry.h"
+#include "log.h"
+
+long StartCritical(void);    // previous I bit, disable interrupts
+void EndCritical(long sr);    // restore I bit to previous value
+
+#define LOG_WORD(i) LogRing[(i)&(LOG_SIZE - 1)]
+#define LOG_BENCH 16                // calls timed by Log_Init()
+
+LogStatsType LogStats;
+static uint32_t LogRing[LOG_SIZE];
+static volatile uint32_t LogPutI;   // words ever stored
+static volatile uint32_t LogGetI;   // words ever sent
+static uint32_t LogTimeMs;          // OS_MsTime() of the last LOG_TIME record
+static uint32_t LogLostSent;        // LogStats.lost told in LOG_LOST records
+static uint32_t LogFrame[TELE_PAYLOAD/4];   // the payload Log_Drain() sends
+
+// the whole record goes in with interrupts disabled for a few stores,
+// a full ring drops it
+static int record(uint32_t header, uint32_t n, uint32_t a, uint32_t b, uint32_t c, uint32_t d){
+  long sr = StartCritical();
+  uint32_t i = LogPutI, used = i - LogGetI + 2 + n;
+  if(used > LOG_SIZE){
+    LogStats.lost++;
+    EndCritical(sr);
+    return 0;
+  }
+  LOG_WORD(i) = header;
+  LOG_WORD(i + 1) = OS_Time();
+  switch(n){                        // the last argument first
+    case 4: LOG_WORD(i + 5) = d;  // fall through
+    case 3: LOG_WORD(i + 4) = c;  // fall through
+    case 2: LOG_WORD(i + 3) = b;  // fall through
+    case 1: LOG_WORD(i + 2) = a;
+  }
+  LogPutI = i + 2 + n;
+  LogStats.records++;
+  if(used > LogStats.maxUsed){
+    LogStats.maxUsed = used;
+  }
+  EndCritical(sr);
+  return 1;
+}
+
+void Log0(uint32_t id){
+  record(LOG_HEADER(id, 0), 0, 0, 0, 0, 0);
+}
+
+void Log1(uint32_t id, uint32_t a){
+  record(LOG_HEADER(id, 1), 1, a, 0, 0, 0);
+}
+
+void Log2(uint32_t id, uint32_t a, uint32_t b){
+  record(LOG_HEADER(id, 2), 2, a, b, 0, 0);
+}
+
+void Log3(uint32_t id, uint32_t a, uint32_t b, uint32_t c){
+  record(LOG_HEADER(id, 3), 3, a, b, c, 0);
+}
+
+void Log4(uint32_t id, uint32_t a, uint32_t b, uint32_t c, uint32_t d){
+  record(LOG_HEADER(id, 4), 4, a, b, c, d);
+}
+
+void Log_Init(void){
+  uint32_t i, t;
+  LogPutI = LogGetI = 0;
+  t = OS_Time();
+  for(i = 0; i < LOG_BENCH; i++){
+    Log2(LOG_BOOT, i, t);
+  }
+  t = OS_TimeDifference(t, OS_Time());
+  LogPutI = LogGetI = 0;            // forget the timed records
+  LogStats.records = LogStats.lost = LogStats.sent = LogStats.maxUsed = 0;
+  LogStats.callCycles = t/LOG_BENCH;  // OS_Time() counts bus cycles
+  LogLostSent = 0;
+  LogTimeMs = OS_MsTime();
+  Log1(LOG_BOOT, LogStats.callCycles);
+}
+
+uint32_t Log_Drain(void){
+  uint32_t get, n, k, w, i, sent = 0, ms = OS_MsTime(), lost = LogStats.lost;
+  if(lost != LogLostSent){
+    if(record(LOG_HEADER(LOG_LOST, 1), 1, lost - LogLostSent, 0, 0, 0)){
+      LogLostSent = lost;
+    }
+  }
+  if(ms - LogTimeMs >= LOG_TIME_MS){
+    if(record(LOG_HEADER(LOG_TIME, 1), 1, ms, 0, 0, 0)){
+      LogTimeMs = ms;
+    }
+  }
+  // whole records, as many as fit in a frame and in Tx_UARTFifo
+  while(1){
+    get = LogGetI;
+    for(n = 0, k = LogPutI - get; n < k; n += w){
+      w = 2 + ((LOG_WORD(get + n) >> 8)&0xFF);      // the record's words
+      if(4*(n + w) > TELE_PAYLOAD) break;
+    }
+    if((n == 0) || !Telemetry_Fits(4*n)){
+      break;
+    }
+    for(i = 0; i < n; i++){
+      LogFrame[i] = LOG_WORD(get + i);
+    }
+    Telemetry_Send(TELE_LOG, LogFrame, 4*n);
+    LogGetI = get + n;
+    sent += n;
+  }
+  LogStats.sent += sent;
+  return sent;
+}
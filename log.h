@@ -0,0 +1,84 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdint.h>
+
+// Deferred logging.  A call stores a format ID, OS_Time() and up to
+// LOG_ARGS raw arguments in LogRing and returns: no formatting, no
+// waiting, safe from threads and interrupts alike.  Log_Drain(), run by
+// a low priority thread, sends the records as they are in TELE_LOG
+// frames (telemetry.h), and tools/teledecode.c formats them on the host
+// with the same table of format strings, LOG_FORMATS below.
+//
+// Record format, 32-bit words least significant byte first:
+//   header  0xA5 | args << 8 | id << 16
+//   time    OS_Time() of the call, 12.5 ns units, wraps every 53.7 s
+//   args    0 to LOG_ARGS words
+// The drain adds a LOG_TIME record with OS_MsTime() every LOG_TIME_MS so
+// the decoder can unwrap the times, and a LOG_LOST record when calls
+// found the ring full.  A record takes 8 to 24 bytes, UART0 carries
+// about 1400 of the shortest ones a second.
+//
+// Host build (for tools/teledecode.c): log.c, telemetry.c and
+// UART_FIFO.c as they are, the tool provides OS_Time(),
+// OS_TimeDifference(), OS_MsTime(), StartCritical(), EndCritical(),
+// UART_Write() and OS_Threads().
+
+#define LOG_ARGS    4
+#define LOG_SIZE    512     // words in LogRing, must be a power of 2
+#define LOG_SYNC    0xA5
+#define LOG_TIME_MS 10000
+
+// id, then the printf format of its arguments, each %u, %d or %x
+#define LOG_FORMATS(X) \
+  X(LOG_BOOT,       "boot, a log call takes %u cycles") \
+  X(LOG_TIME,       "%u ms since boot") \
+  X(LOG_LOST,       "%u records lost, the ring was full") \
+  X(LOG_STATE,      "page %u") \
+  X(LOG_GAME_START, "game start, type %u mode %u seed %x") \
+  X(LOG_GAME_OVER,  "game over, score %u high score %u after %u ms") \
+  X(LOG_FRAME_LATE, "frame %u over budget, sim %u render %u cycles") \
+  X(LOG_FRAME_DROP, "frame %u dropped %u steps") \
+  X(LOG_UART_DROP,  "%u received bytes dropped")
+
+#define LOG_ENUM(id, format) id,
+enum { LOG_FORMATS(LOG_ENUM) LOG_IDS };
+
+#define LOG_HEADER(id, args) (LOG_SYNC | ((args) << 8) | ((uint32_t)(id) << 16))
+
+typedef struct {
+  uint32_t records;         // records stored
+  uint32_t lost;            // calls that found the ring full
+  uint32_t sent;            // words sent by Log_Drain()
+  uint32_t maxUsed;         // most words waiting in the ring
+  uint32_t callCycles;      // cost of one Log2() call, measured by Log_Init()
+} LogStatsType;
+extern LogStatsType LogStats;
+
+//------------Log_Init------------
+// Empty the ring, time a few calls into LogStats.callCycles and log
+// LOG_BOOT with the result.
+// Input: none
+// Output: none
+void Log_Init(void);
+
+//------------Log0 to Log4------------
+// Store one record, drop it and count it in LogStats.lost if the ring
+// is full.  Callable from any thread or interrupt.
+// Input: id from LOG_FORMATS, then the arguments of its format
+// Output: none
+void Log0(uint32_t id);
+void Log1(uint32_t id, uint32_t a);
+void Log2(uint32_t id, uint32_t a, uint32_t b);
+void Log3(uint32_t id, uint32_t a, uint32_t b, uint32_t c);
+void Log4(uint32_t id, uint32_t a, uint32_t b, uint32_t c, uint32_t d);
+
+//------------Log_Drain------------
+// Send what the ring holds in TELE_LOG frames, as many as Tx_UARTFifo
+// has room for, and add LOG_LOST and LOG_TIME records when they are due.
+// Call it from the thread that sends the other telemetry frames.
+// Input: none
+// Output: words sent
+uint32_t Log_Drain(void);
+
+#endif
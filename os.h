@@ -1,219 +1,3 @@
-<<<<<<< HEAD
-#include <stdint.h>
-// filename **********OS.H***********
-// Real Time Operating System for Labs 2 and 3 
-// Jonathan W. Valvano 2/20/17, valvano@mail.utexas.edu
-// EE445M/EE380L.6 
-// You may use, edit, run or distribute this file 
-// You are free to change the syntax/organization of this file
-// You are required to implement the spirit of this OS
-
- 
-#ifndef _OS_H_
-#define _OS_H_
-
-// NVIC Defines
-#define NVIC_ST_CTRL_R          (*((volatile uint32_t *)0xE000E010))
-#define NVIC_ST_CTRL_CLK_SRC    0x00000004  // Clock Source
-#define NVIC_ST_CTRL_INTEN      0x00000002  // Interrupt enable
-#define NVIC_ST_CTRL_ENABLE     0x00000001  // Counter mode
-#define NVIC_ST_RELOAD_R        (*((volatile uint32_t *)0xE000E014))
-#define NVIC_ST_CURRENT_R       (*((volatile uint32_t *)0xE000E018))
-#define NVIC_INT_CTRL_R         (*((volatile uint32_t *)0xE000ED04))
-#define NVIC_INT_CTRL_PENDSTSET 0x04000000  // Set pending SysTick interrupt
-#define NVIC_SYS_PRI3_R         (*((volatile uint32_t *)0xE000ED20))  // Sys. Handlers 12 to 15 Priority
-	
-#define NVIC_EN0_INT21          0x00200000  // Interrupt 21 enable
-#define NVIC_EN1_INT35					0x00000008
-#define NVIC_EN2_INT70          0x00000040
-
-#define TIMER_CFG_32_BIT_TIMER  0x00000000  // 32-bit timer configuration
-#define TIMER_TAMR_TACDIR       0x00000010  // GPTM Timer A Count Direction
-#define TIMER_TAMR_TAMR_PERIOD  0x00000002  // Periodic Timer mode
-#define TIMER_CTL_TAEN          0x00000001  // GPTM TimerA Enable
-#define TIMER_IMR_TATOIM        0x00000001  // GPTM TimerA Time-Out Interrupt
-                                            // Mask
-#define TIMER_ICR_TATOCINT      0x00000001  // GPTM TimerA Time-Out Raw
-                                            // Interrupt
-#define TIMER_TAILR_M           0xFFFFFFFF  // GPTM Timer A Interval Load
-                                            // Register
-
-#define GPIO_PORTF2             (*((volatile uint32_t *)0x40025010))
-
-// edit these depending on your clock        
-#define TIME_1MS    80000          
-#define TIME_2MS    (2*TIME_1MS)  
-#define TIME_500US  (TIME_1MS/2)  
-#define TIME_250US  (TIME_1MS/5)  
-
-// feel free to change the type of semaphore, there are lots of good solutions
-struct  Sema4{
-  long Value;   // >0 means free, otherwise means busy        
-// add other components here, if necessary to implement blocking
-};
-typedef struct Sema4 Sema4Type;
-
-// ******** OS_Init ************
-// initialize operating system, disable interrupts until OS_Launch
-// initialize OS controlled I/O: serial, ADC, systick, LaunchPad I/O and timers 
-// input:  none
-// output: none
-void OS_Init(void);
-
-//******** OS_Launch *************** 
-// start the scheduler, enable interrupts
-// Inputs: number of 12.5ns clock cycles for each time slice
-//         you may select the units of this parameter
-// Outputs: none (does not return)
-// It is ok to limit the range of theTimeSlice to match the 24-bit SysTick
-void OS_Launch(unsigned long theTimeSlice);
-
-
-//******** OS_AddThread *************** 
-// add a foregound thread to the scheduler
-// Inputs: pointer to a void/void foreground task
-//         number of bytes allocated for its stack
-//         priority, 0 is highest, 5 is the lowest
-// Outputs: 1 if successful, 0 if this thread can not be added
-// stack size must be divisable by 8 (aligned to double word boundary)
-int OS_AddThread(void(*task)(void), 
-   unsigned long stackSize, unsigned long priority);
-
-//******** OS_Id *************** 
-// returns the thread ID for the currently running thread
-// Inputs: none
-// Outputs: Thread ID, number greater than zero 
-unsigned long OS_Id(void);
-
-//******** OS_AddPeriodicThread *************** 
-// add a background periodic task
-// typically this function receives the highest priority
-// Inputs: pointer to a void/void background function
-//         period given in system time units (12.5ns)
-//         priority 0 is the highest, 5 is the lowest
-// Outputs: 1 if successful, 0 if this thread can not be added
-// You are free to select the time resolution for this function
-// It is assumed that the user task will run to completion and return
-// This task can not spin, block, loop, sleep, or kill
-// This task can call OS_Signal  OS_bSignal	 OS_AddThread
-// This task does not have a Thread ID
-int OS_AddPeriodicThread(void(*task)(void), 
-   unsigned long period, unsigned long priority);
-
-// ******** OS_InitSemaphore ************
-// initialize semaphore 
-// input:  pointer to a semaphore
-// output: none
-void OS_InitSemaphore(Sema4Type *semaPt, long value); 
-
-// ******** OS_Wait ************
-// decrement semaphore 
-// input:  pointer to a counting semaphore
-// output: none
-void OS_Wait(Sema4Type *semaPt); 
-
-// ******** OS_Signal ************
-// increment semaphore  
-// input:  pointer to a counting semaphore
-// output: none
-void OS_Signal(Sema4Type *semaPt); 
-
-// ******** OS_bWait ************
-// input:  pointer to a binary semaphore
-// output: none
-void OS_bWait(Sema4Type *semaPt); 
-
-// ******** OS_bSignal ************ 
-// input:  pointer to a binary semaphore
-// output: none
-void OS_bSignal(Sema4Type *semaPt); 
-
-// ******** OS_Sleep ************
-// place this thread into a dormant state
-// input:  number of msec to sleep
-// output: none
-// You are free to select the time resolution for this function
-// OS_Sleep(0) implements cooperative multitasking
-void OS_Sleep(unsigned long sleepTime); 
-
-// ******** OS_Kill ************
-// kill the currently running thread, release its TCB and stack
-// input:  none
-// output: none
-void OS_Kill(void); 
-
-// ******** OS_Suspend ************
-// suspend execution of currently running thread
-// scheduler will choose another thread to execute
-// Can be used to implement cooperative multitasking 
-// Same function as OS_Sleep(0)
-// input:  none
-// output: none
-void OS_Suspend(void);
- 
-// ******** OS_Time ************
-// return the system time 
-// Inputs:  none
-// Outputs: time in 12.5ns units, 0 to 4294967295
-// The time resolution should be less than or equal to 1us, and the precision 32 bits
-// It is ok to change the resolution and precision of this function as long as 
-//   this function and OS_TimeDifference have the same resolution and precision 
-unsigned long OS_Time(void);
-
-// ******** OS_TimeDifference ************
-// Calculates difference between two times
-// Inputs:  two times measured with OS_Time
-// Outputs: time difference in 12.5ns units 
-// The time resolution should be less than or equal to 1us, and the precision at least 12 bits
-// It is ok to change the resolution and precision of this function as long as 
-//   this function and OS_Time have the same resolution and precision 
-unsigned long OS_TimeDifference(unsigned long start, unsigned long stop);
-
-// ******** OS_ClearMsTime ************
-// sets the system time to zero (from Lab 1)
-// Inputs:  none
-// Outputs: none
-// You are free to change how this works
-void OS_ClearMsTime(void);
-
-// ******** OS_MsTime ************
-// reads the current time in msec (from Lab 1)
-// Inputs:  none
-// Outputs: time in ms units
-// You are free to select the time resolution for this function
-// It is ok to make the resolution to match the first call to OS_AddPeriodicThread
-unsigned long OS_MsTime(void);
-
-//******** OS_AddSW1Task *************** 
-// add a background task to run whenever the BUTTON1 (PD6) button is pushed
-// Inputs: pointer to a void/void background function
-//         priority 0 is the highest, 5 is the lowest
-// Outputs: 1 if successful, 0 if this thread can not be added
-// It is assumed that the user task will run to completion and return
-// This task can not spin, block, loop, sleep, or kill
-// This task can call OS_Signal  OS_bSignal	 OS_AddThread
-// This task does not have a Thread ID
-int OS_AddSW1Task(void(*task)(void), unsigned long priority);
-
-//******** OS_AddSW2Task *************** 
-// add a background task to run whenever the BUTTON2 (PD7) button is pushed
-// Inputs: pointer to a void/void background function
-//         priority 0 is highest, 5 is lowest
-// Outputs: 1 if successful, 0 if this thread can not be added
-// It is assumed user task will run to completion and return
-// This task can not spin block loop sleep or kill
-// This task can call issue OS_Signal, it can call OS_AddThread
-// This task does not have a Thread ID
-int OS_AddSW2Task(void(*task)(void), unsigned long priority);
-
-void Scheduler(void);
-void InitTimer1A(unsigned long period, uint32_t priority);
-void InitTimer2A(unsigned long period); 
-void InitTimer3A(void);
-void InitTimer4A(uint32_t period, uint32_t priority);
-
-#endif
-=======
 #include <stdint.h>
 // filename **********OS.H***********
 // Real Time Operating System for Labs 2 and 3 
@@ -273,6 +57,7 @@ struct  Sema4{
   int id;	
 	int waitingThreads[MAX_WAITING_THREADS]; // list of waiting thread IDs
   int waitingCount;  // number of threads in waitingThreads
+  unsigned long waits;  // OS_Wait calls that found it taken
 // add other components here, if necessary to implement blocking
 };
 typedef struct Sema4 Sema4Type;
@@ -289,9 +74,10 @@ struct tcb {
   uint32_t WaitTime;     // Elapsed time since thread arrived till it starts execution
   uint32_t ExecCount;    // Number of times thread is executed (switched to)
 	uint32_t terminate;
+  uint32_t cycles;       // bus cycles run, charged by the Scheduler at each switch
 #ifdef blockSema
   Sema4Type *blockPt;    // Pointer to resource thread is blocked on (0 if not)
-	Sema4Type *blockid;
+	uint8_t cell;           // game grid cell held by the thread, 0xFF if none (board.c)
 #endif
 #ifdef prioritySched
 	uint32_t priority;
@@ -315,9 +101,33 @@ typedef struct tcb tcbType;
 void OS_Init(void); 
 
 extern tcbType *RunPt;
+
+// Cube threads own cells of the 6x6 game grid through board.c,
+// one cell per thread at a time.
+// ******** checkSemaPt ************
+// move the running thread to cell x,y if no other thread has it,
+// releasing the cell it held before
+// input:  x,y cell, 0 to 5
+// output: 1 if the running thread now holds the cell, 0 if taken
 int checkSemaPt(int x, int y);
+
+// ******** score ************
+// the player hit cell x,y: tell the thread there to terminate and
+// keep the cell taken by the running thread until it has exited
+// input:  x,y cell, 0 to 5
+// output: none
 void score(int x, int y);
-int OS_InitSemaphores(void);
+
+// ******** OS_InitBoard ************
+// release every cell of the game grid
+// input:  none
+// output: 1
+int OS_InitBoard(void);
+
+// ******** OS_FreePt ************
+// release cell x,y, whoever holds it
+// input:  x,y cell, 0 to 5
+// output: none
 void OS_FreePt(int x, int y);
 void flush();
 // ******** OS_InitSemaphore ************
@@ -341,7 +151,6 @@ void OS_Signal(Sema4Type *semaPt);
 // ******** OS_bWait ************
 // input:  pointer to a binary semaphore
 // output: none
-int OS_nWait(Sema4Type *semaPt); 
 void OS_bWait(Sema4Type *semaPt);
 int GetNumberOfWaitingThreads(Sema4Type *semaPt);
 // ******** OS_bSignal ************ 
@@ -365,6 +174,27 @@ int OS_AddThread(void(*task)(void),
 // Outputs: Thread ID, number greater than zero 
 unsigned long OS_Id(void);
 
+// one thread as OS_Threads sees it
+typedef struct {
+  uint8_t id;            // Thread #, index of its TCB
+  uint8_t state;         // OS_RUNNING, OS_READY, OS_SLEEPING or OS_WAITING
+  uint8_t priority;      // as given to OS_AddThread
+  uint8_t cell;          // game grid cell held, 0xFF if none (board.c)
+  uint32_t sleepMs;      // left to sleep
+  uint32_t arriveMs;     // OS_MsTime() when it was added
+  uint32_t cycles;       // bus cycles run since then, interrupts included, wraps
+  uint16_t stackUsed;    // most words of its stack ever used
+  uint16_t stackSize;    // words of its stack
+} OSThreadType;
+enum { OS_RUNNING, OS_READY, OS_SLEEPING, OS_WAITING };
+
+//******** OS_Threads *************** 
+// copy the state of the live threads, all taken at one instant but
+// the stack high water marks, which are found after
+// Inputs: list of max entries
+// Outputs: number of threads copied
+uint32_t OS_Threads(OSThreadType *list, uint32_t max);
+
 //******** OS_AddPeriodicThread *************** 
 // add a background periodic task
 // typically this function receives the highest priority
@@ -477,4 +307,3 @@ void InitTimer4A(uint32_t period, uint32_t priority);
 //extern unsigned long Button2RespTime;
 
 #endif
->>>>>>> c04fcbc29e5c1dd4d5927ac8e56ea208d393528c
@@ -0,0 +1,215 @@
+// replay.c
+// Record and replay of one game over UART0, see replay.h.
+
+#include <stdint.h>
+#include "replay.h"
+
+#ifdef HOST_SIM
+#define StartCritical() 0
+#define EndCritical(sr) ((void)(sr))
+static uint8_t *Buffer;
+static uint32_t Size, Used;
+#else
+#include "UART.h"
+long StartCritical(void);    // previous I bit, disable interrupts
+void EndCritical(long sr);   // restore I bit to previous value
+#endif
+
+#define REC_REPEAT 0x80
+#define REC_FRAME  0xA0
+#define REC_BUTTON 0xB0
+#define REC_BEGIN  0xC0
+#define REC_END    0xC1
+#define REPEAT_MAX 32               // repeats one REC_REPEAT byte can hold
+
+uint8_t ReplayMode;
+static volatile uint8_t Pressed;    // REPLAY_SW1/SW2 bits noted since the last frame
+static uint8_t LastX, LastY;        // previous sample, written or read
+static uint8_t Repeats;             // repeats of LastX,LastY not written or not read yet
+static uint8_t HaveLast;            // LastX,LastY is valid
+
+//------------stream------------
+#ifdef HOST_SIM
+static void put(uint8_t data){
+  if(Used < Size){
+    Buffer[Used] = data;
+  }
+  Used++;                           // counts past the end, see Replay_Used()
+}
+
+// 0x100 once the buffer is empty
+static uint32_t get(void){
+  if(Used >= Size){
+    return 0x100;
+  }
+  return Buffer[Used++];
+}
+
+void Replay_Init(uint8_t mode, uint8_t *buffer, uint32_t size){
+  Buffer = buffer;
+  Size = size;
+  Used = 0;
+#else
+static void put(uint8_t data){
+  UART_OutChar(data);               // waits only if 512 bytes are waiting
+}
+
+static uint32_t get(void){
+  return (uint8_t)UART_InChar();
+}
+
+void Replay_Init(uint8_t mode){
+#endif
+  ReplayMode = mode;
+  Pressed = 0;
+  Repeats = 0;
+  HaveLast = 0;
+}
+
+#ifdef HOST_SIM
+uint32_t Replay_Used(void){
+  return Used;
+}
+#endif
+
+static void put32(uint32_t data){
+  put(data);
+  put(data >> 8);
+  put(data >> 16);
+  put(data >> 24);
+}
+
+static uint32_t get32(void){
+  uint32_t data = get();
+  data |= get() << 8;
+  data |= get() << 16;
+  return data | (get() << 24);
+}
+
+//------------record------------
+static void flushRepeats(void){
+  if(Repeats){
+    put(REC_REPEAT + Repeats - 1);
+    Repeats = 0;
+  }
+}
+
+void Replay_Begin(const ReplaySessionType *session){
+  if(ReplayMode != REPLAY_RECORD) return;
+  Repeats = 0;
+  HaveLast = 0;
+  Pressed = 0;
+  put(REC_BEGIN);
+  put(REPLAY_VERSION);
+  put32(session->lfsr32);
+  put32(session->lfsr31);
+  put(session->gameType);
+  put(session->gameMode);
+  put(session->x);
+  put(session->y);
+}
+
+void Replay_Sample(int16_t x, int16_t y){
+  uint8_t px = (x < 0) ? 0 : ((x > 127) ? 127 : x);
+  uint8_t py = (y < 0) ? 0 : ((y > 127) ? 127 : y);
+  if(ReplayMode != REPLAY_RECORD) return;
+  if(HaveLast && (px == LastX) && (py == LastY)){
+    Repeats++;
+    if(Repeats == REPEAT_MAX){
+      flushRepeats();
+    }
+    return;
+  }
+  flushRepeats();
+  put(px);
+  put(py);
+  LastX = px;
+  LastY = py;
+  HaveLast = 1;
+}
+
+void Replay_Press(uint8_t button){
+  long sr = StartCritical();
+  Pressed |= button;
+  EndCritical(sr);
+}
+
+// write the pushes noted since the last frame
+static void putPressed(void){
+  uint8_t pressed;
+  long sr = StartCritical();
+  pressed = Pressed;
+  Pressed = 0;
+  EndCritical(sr);
+  flushRepeats();
+  if(pressed & REPLAY_SW1){
+    put(REC_BUTTON + REPLAY_SW1);
+  }
+  if(pressed & REPLAY_SW2){
+    put(REC_BUTTON + REPLAY_SW2);
+  }
+}
+
+void Replay_Frame(uint32_t steps){
+  if(ReplayMode != REPLAY_RECORD) return;
+  putPressed();
+  put(REC_FRAME + (steps & 0x07));
+}
+
+void Replay_End(uint16_t score){
+  if(ReplayMode != REPLAY_RECORD) return;
+  putPressed();
+  put(REC_END);
+  put(score);
+  put(score >> 8);
+}
+
+//------------play------------
+uint8_t Replay_Read(ReplayEventType *event){
+  uint32_t data;
+  if(Repeats){
+    Repeats--;
+    event->x = LastX;
+    event->y = LastY;
+    return event->type = REPLAY_SAMPLE;
+  }
+  data = get();
+  if(data < REC_REPEAT){
+    LastX = data;
+    LastY = get() & 0x7F;
+    HaveLast = 1;
+    event->x = LastX;
+    event->y = LastY;
+    return event->type = REPLAY_SAMPLE;
+  }
+  if((data < REC_FRAME) && HaveLast){
+    Repeats = data - REC_REPEAT;    // this record is the first repeat
+    event->x = LastX;
+    event->y = LastY;
+    return event->type = REPLAY_SAMPLE;
+  }
+  if((data & 0xF8) == REC_FRAME){
+    event->value = data & 0x07;
+    return event->type = REPLAY_FRAME;
+  }
+  if((data == REC_BUTTON + REPLAY_SW1) || (data == REC_BUTTON + REPLAY_SW2)){
+    event->value = data - REC_BUTTON;
+    return event->type = REPLAY_BUTTON;
+  }
+  if((data == REC_BEGIN) && (get() == REPLAY_VERSION)){
+    event->session.lfsr32 = get32();
+    event->session.lfsr31 = get32();
+    event->session.gameType = get();
+    event->session.gameMode = get();
+    event->session.x = get();
+    event->session.y = get();
+    HaveLast = 0;
+    return event->type = REPLAY_BEGIN;
+  }
+  if(data == REC_END){
+    data = get();
+    event->value = data | (get() << 8);
+    return event->type = REPLAY_END;
+  }
+  return event->type = REPLAY_ERROR;
+}
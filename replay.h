@@ -0,0 +1,112 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdint.h>
+
+// Record and replay of one game over UART0.  A recording holds the
+// random seed and settings at the start of the game, every joystick
+// sample the game loop used, the button presses, where each frame
+// ended and how many steps it ran, and the final score.  Time is the
+// position in the stream: a sample is one Producer tick (10 ms) and a
+// frame record closes one game frame, so no clock values are stored.
+//
+// Stream format, one record after another:
+//   0x00-0x7F  sample: this byte is x (0 to 127), the next byte is y
+//   0x80-0x9F  the previous sample again, 1 + (byte & 0x1F) times
+//   0xA0-0xA7  end of a frame that ran (byte & 0x07) steps
+//   0xB1,0xB2  SW1 or SW2 pushed during the frame
+//   0xC0       start of a game, then version, lfsr32 and lfsr31
+//              (4 bytes each, least significant first), game_type,
+//              game_mode and the crosshair x,y, 13 bytes after the 0xC0
+//   0xC1       end of the game, then the score (2 bytes)
+// A joystick at rest costs 1 byte per 32 ticks, a moving one 2 bytes
+// per tick, 200 bytes/s at most.
+//
+// Host build (for tools/replaytool.c): compile with -DHOST_SIM, the
+// stream then goes to and from the buffer given to Replay_Init().
+
+#define REPLAY_OFF     0    // modes of Replay_Init()
+#define REPLAY_RECORD  1
+#define REPLAY_PLAY    2
+
+#define REPLAY_VERSION 1
+
+#define REPLAY_SAMPLE  0    // ReplayEventType.type
+#define REPLAY_FRAME   1
+#define REPLAY_BUTTON  2
+#define REPLAY_BEGIN   3
+#define REPLAY_END     4
+#define REPLAY_ERROR   5    // unknown byte, or the host buffer ran out
+
+#define REPLAY_SW1     1    // ReplayEventType.value of REPLAY_BUTTON
+#define REPLAY_SW2     2
+
+typedef struct {
+  uint32_t lfsr32;          // random number state when the game started
+  uint32_t lfsr31;
+  uint8_t gameType;         // game_type in Main.c
+  uint8_t gameMode;         // game_mode in Main.c
+  uint8_t x, y;             // crosshair position the first sweep starts from
+} ReplaySessionType;
+
+typedef struct {
+  uint8_t type;             // REPLAY_SAMPLE ... REPLAY_ERROR
+  uint8_t x, y;             // REPLAY_SAMPLE position
+  uint16_t value;           // steps of REPLAY_FRAME, button of REPLAY_BUTTON, score of REPLAY_END
+  ReplaySessionType session;// REPLAY_BEGIN
+} ReplayEventType;
+
+extern uint8_t ReplayMode;  // REPLAY_OFF, REPLAY_RECORD or REPLAY_PLAY
+
+//------------Replay_Init------------
+// Choose the mode.  On the target UART_Init() must be called first.
+// Input: mode   REPLAY_OFF, REPLAY_RECORD or REPLAY_PLAY
+//        buffer host build only: stream to write or to read
+//        size   host build only: bytes in buffer
+// Output: none
+#ifdef HOST_SIM
+void Replay_Init(uint8_t mode, uint8_t *buffer, uint32_t size);
+uint32_t Replay_Used(void); // host build only: bytes written or read so far
+#else
+void Replay_Init(uint8_t mode);
+#endif
+
+//------------Replay_Begin------------
+// Record the start of a game.
+// Input: session seed and settings of the game
+// Output: none
+void Replay_Begin(const ReplaySessionType *session);
+
+//------------Replay_Sample------------
+// Record one joystick sample used by the game.
+// Input: x,y crosshair position, 0 to 127
+// Output: none
+void Replay_Sample(int16_t x, int16_t y);
+
+//------------Replay_Press------------
+// Note a button push, written with the next frame record.
+// May be called from the switch tasks.
+// Input: button REPLAY_SW1 or REPLAY_SW2
+// Output: none
+void Replay_Press(uint8_t button);
+
+//------------Replay_Frame------------
+// Record the end of a frame, after the pushes noted since the last one.
+// Input: steps fixed steps the frame ran, 0 to 7
+// Output: none
+void Replay_Frame(uint32_t steps);
+
+//------------Replay_End------------
+// Record the end of the game, after the pushes noted since the last
+// frame.
+// Input: score final score
+// Output: none
+void Replay_End(uint16_t score);
+
+//------------Replay_Read------------
+// Next record of a recording.  On the target this waits for UART0.
+// Input: event filled in
+// Output: event->type
+uint8_t Replay_Read(ReplayEventType *event);
+
+#endif
@@ -0,0 +1,423 @@
+// shell.c
+// Command shell on UART0 for live kernel and game statistics, see
+// shell.h.
+
+#include <stdint.h>
+#include <string.h>
+#include "os.h"
+#include "UART.h"
+#include "UART_FIFO.h"
+#include "FIFO.h"
+#include "LCD.h"
+#include "joystick.h"
+#include "log.h"
+#include "telemetry.h"
+#include "sound.h"
+#if SOUND_WAVE
+#include "wave.h"
+#endif
+#include "shell.h"
+
+extern Sema4Type LCDFree;
+extern Sema4Type CubeCnt;
+
+#define SHELL_OUT     128     // bytes gathered before UART_Write()
+#define SHELL_THREADS 32      // at least NUMTHREADS of os.c
+#define SHELL_WRAP_MS 53000   // OS_Time() and the thread cycles wrap after 53.7 s
+
+static char Line[SHELL_LINE];
+static uint32_t LineCount;
+static int LineLong;          // characters were refused, the line is thrown away
+static char LastEnd;          // CR or LF that ended the last line, 0 after any other byte
+static char Out[SHELL_OUT];
+static uint32_t OutCount;
+static void (*Game)(TeleGameType *g);
+
+// previous samples, the rates are taken between two commands
+typedef struct {
+  uint32_t arriveMs;          // which thread had the id
+  uint32_t cycles;
+  int valid;
+} PsSampleType;
+static PsSampleType PsLast[SHELL_THREADS];
+static uint32_t PsMs;
+static uint32_t LcdMs, LcdBytes, LcdFills;
+static OSThreadType List[SHELL_THREADS];   // static, thread stacks are 400 bytes
+
+//------------output------------
+static void send(void){
+  const char *pt = Out;
+  uint32_t k;
+  while(OutCount){
+    k = UART_Write(pt, OutCount);
+    pt += k;
+    OutCount -= k;
+    if(OutCount){
+      OS_Sleep(SHELL_WAIT_MS);        // UART0 empties Tx_UARTFifo meanwhile
+    }
+  }
+}
+
+static void put(const char *s){
+  while(*s){
+    if(OutCount == SHELL_OUT){
+      send();
+    }
+    Out[OutCount++] = *s++;
+  }
+}
+
+// s left aligned in width characters
+static void field(const char *s, int width){
+  put(s);
+  for(width -= strlen(s); width > 0; width--){
+    put(" ");
+  }
+}
+
+// n in decimal, right aligned in width characters
+static void num(uint32_t n, int width){
+  char s[12];
+  int i = sizeof(s) - 1;
+  s[i] = 0;
+  do{
+    s[--i] = '0' + n%10;
+    n /= 10;
+  }while(n);
+  while((i > 0) && (width > (int)sizeof(s) - 1 - i)){
+    s[--i] = ' ';
+  }
+  put(&s[i]);
+}
+
+// n/10 with one decimal, right aligned in width characters
+static void tenths(uint32_t n, int width){
+  num(n/10, width - 2);
+  put(".");
+  num(n%10, 1);
+}
+
+// part of whole in tenths of a percent, 0 if whole is 0
+static uint32_t permille(uint64_t part, uint64_t whole){
+  return whole ? (uint32_t)((1000*part + whole/2)/whole) : 0;
+}
+
+//------------commands------------
+static void help(int words);
+
+static void ps(int words){
+  static const char *state[] = { "running ", "ready   ", "sleeping", "waiting " };
+  uint32_t i, n, id, ms = OS_MsTime(), dt = ms - PsMs, used, total = 0;
+  int rate = PsMs && (dt > 0) && (dt < SHELL_WRAP_MS);
+  (void)words;
+  n = OS_Threads(List, SHELL_THREADS);
+  put(" id state    pri cell   cpu% stack\r\n");
+  for(i = 0; i < n; i++){
+    id = List[i].id%SHELL_THREADS;
+    num(List[i].id, 3);
+    put(" ");
+    put(state[List[i].state%4]);
+    num(List[i].priority, 4);
+    if(List[i].cell == 0xFF){
+      put("    -");
+    }else{
+      num(List[i].cell, 5);
+    }
+    if(rate && PsLast[id].valid && (PsLast[id].arriveMs == List[i].arriveMs)){
+      used = permille(List[i].cycles - PsLast[id].cycles, (uint64_t)dt*TIME_1MS);
+      total += used;
+      tenths(used, 7);
+    }else{
+      put("      -");
+    }
+    put(" ");
+    num(List[i].stackUsed, 5);
+    put("/");
+    num(List[i].stackSize, 1);
+    put("\r\n");
+  }
+  if(rate){
+    put("threads ");
+    num(n, 1);
+    put(", cpu ");
+    tenths(total, 1);
+    put("% over ");
+    num(dt, 1);
+    put(" ms\r\n");
+  }
+  for(i = 0; i < SHELL_THREADS; i++){
+    PsLast[i].valid = 0;
+  }
+  for(i = 0; i < n; i++){
+    id = List[i].id%SHELL_THREADS;
+    PsLast[id].arriveMs = List[i].arriveMs;
+    PsLast[id].cycles = List[i].cycles;
+    PsLast[id].valid = 1;
+  }
+  PsMs = ms;
+}
+
+static void sem1(const char *name, Sema4Type *s){
+  static int waiting[MAX_WAITING_THREADS];
+  int i, n;
+  long sr = StartCritical();          // value and list of one instant
+  long value = s->Value;
+  uint32_t waits = s->waits;
+  n = s->waitingCount;
+  for(i = 0; i < n; i++){
+    waiting[i] = s->waitingThreads[i];
+  }
+  EndCritical(sr);
+  field(name, 9);
+  num(value < 0 ? 0 : value, 6);
+  num(n, 8);
+  num(waits, 8);
+  put(" ");
+  for(i = 0; i < n; i++){
+    put(" ");
+    num(waiting[i], 1);
+  }
+  put("\r\n");
+}
+
+static void sem(int words){
+  (void)words;
+  put("semaphore value waiting   waits  threads waiting\r\n");
+  sem1("LCDFree", &LCDFree);
+  sem1("CubeCnt", &CubeCnt);
+}
+
+static void lcd(int words){
+  uint32_t ms = OS_MsTime(), bytes = BSP_LCD_Bytes, fills = BSP_LCD_Fills, dt = ms - LcdMs;
+  (void)words;
+  if(LcdMs && (dt > 0) && (dt < SHELL_WRAP_MS)){
+    num((uint32_t)((uint64_t)(bytes - LcdBytes)*1000/dt), 1);
+    put(" bytes/s, ");
+    num((uint32_t)((uint64_t)(fills - LcdFills)*1000/dt), 1);
+    put(" fills/s, bus ");
+    tenths(permille((uint64_t)(bytes - LcdBytes)*LCD_BYTE_TIME, (uint64_t)dt*TIME_1MS), 1);
+    put("% busy over ");
+    num(dt, 1);
+    put(" ms\r\n");
+  }else{
+    put("since the last lcd: none yet\r\n");
+  }
+  put("total ");
+  num(bytes, 1);
+  put(" bytes, ");
+  num(fills, 1);
+  put(" fills\r\n");
+  LcdMs = ms;
+  LcdBytes = bytes;
+  LcdFills = fills;
+}
+
+static void fifo(int words){
+  (void)words;
+  put("queue         used   size  lost\r\n");
+  put("uart0 tx    ");
+  num(Tx_UARTFifo_Size(), 5);
+  num(TX_UARTFIFOSIZE, 7);
+  num(TeleStats.dropped, 6);
+  put("  telemetry frames\r\nuart0 rx    ");
+  num(Rx_UARTFifo_Size(), 5);
+  num(RX_UARTFIFOSIZE, 7);
+  num(UARTStats.rxDropped, 6);
+  put("  bytes\r\nlog ring    ");
+  num(LogStats.maxUsed, 5);
+  num(LOG_SIZE, 7);
+  num(LogStats.lost, 6);
+  put("  records, used is the peak\r\njoystick    ");
+  num(RxFifo_Size(), 5);
+  num(RXFIFOSIZE, 7);
+  put("     -  ");
+  num(JoystickStats.samples, 1);
+  put(" samples\r\n");
+}
+
+static void game(int words){
+  static const char *page[] = { "main", "game", "settings" };
+  static TeleGameType g;
+  (void)words;
+  if(!Game){
+    put("no game\r\n");
+    return;
+  }
+  Game(&g);
+  put("page ");
+  put(g.state < 3 ? page[g.state] : "?");
+  put(", type ");
+  num(g.gameType, 1);
+  put(", mode ");
+  num(g.gameMode, 1);
+  put(", score ");
+  num(g.score, 1);
+  put(", high ");
+  num(g.highScore, 1);
+  put(", rounds ");
+  num(g.rounds, 1);
+  put(", cubes ");
+  num(g.cubes, 1);
+  put("\r\n");
+}
+
+static void snd(int words){
+  (void)words;
+  put("notes ");
+  num(SoundStats.notes, 1);
+  put(", dropped ");
+  num(SoundStats.dropped, 1);
+  put(", ticks ");
+  num(SoundStats.ticks, 1);
+  put(Sound_Busy() ? ", playing\r\n" : ", quiet\r\n");
+#if SOUND_WAVE
+  put("mixer ");
+  num(WAVE_RATE, 1);
+  put(" Hz, voices ");
+  num(Wave_Busy(), 1);
+  put("/");
+  num(WAVE_VOICES, 1);
+  put(", blocks ");
+  num(WaveStats.blocks, 1);
+  put(", underruns ");
+  num(WaveStats.underruns, 1);
+  put(", clipped ");
+  num(WaveStats.clipped, 1);
+  put(", dropped ");
+  num(WaveStats.dropped, 1);
+  put("\r\nmix ");
+  num(WaveStats.mixCycles, 1);
+  put(" cycles a block, most ");
+  num(WaveStats.mixMax, 1);
+  put(", cpu ");
+  tenths(permille((uint64_t)WaveStats.mixCycles*WAVE_RATE, (uint64_t)WAVE_BLOCK*TIME_1MS*1000), 1);
+  put("%\r\n");
+#endif
+}
+
+// name, most words after it, what it shows
+#define SHELL_COMMANDS(X) \
+  X(help, 0, "the commands") \
+  X(ps,   0, "threads: state, priority, cell, CPU % since the last ps, stack used") \
+  X(sem,  0, "semaphores: value, threads waiting, contended waits") \
+  X(lcd,  0, "LCD bus bytes/s, fills/s and % busy since the last lcd") \
+  X(fifo, 0, "queues: fill and losses") \
+  X(game, 0, "page, score, rounds and cubes") \
+  X(snd,  0, "sound: notes, mixer voices, underruns, mixing cycles and CPU %")
+
+typedef struct {
+  const char *name;
+  int args;
+  const char *what;
+  void (*run)(int words);
+} CommandType;
+
+#define SHELL_COMMAND(name, args, what) { #name, args, what, name },
+static const CommandType Commands[] = { SHELL_COMMANDS(SHELL_COMMAND) };
+#define SHELL_COMMAND_COUNT (sizeof(Commands)/sizeof(Commands[0]))
+
+static void help(int words){
+  uint32_t i;
+  (void)words;
+  for(i = 0; i < SHELL_COMMAND_COUNT; i++){
+    field(Commands[i].name, 6);
+    put(Commands[i].what);
+    put("\r\n");
+  }
+}
+
+//------------parser------------
+// split Line into words in place, run the command
+static void run(void){
+  char *word[SHELL_WORDS];
+  uint32_t i;
+  int words = 0;
+  char *pt = Line;
+  while(*pt){
+    while(*pt == ' '){
+      *pt++ = 0;
+    }
+    if(!*pt) break;
+    if(words == SHELL_WORDS){
+      put("too many words\r\n");
+      return;
+    }
+    word[words++] = pt;
+    while(*pt && (*pt != ' ')){
+      pt++;
+    }
+  }
+  if(words == 0) return;
+  for(i = 0; i < SHELL_COMMAND_COUNT; i++){
+    if(strcmp(word[0], Commands[i].name) == 0){
+      if(words - 1 > Commands[i].args){
+        put(Commands[i].name);
+        put(": too many arguments\r\n");
+      }else{
+        Commands[i].run(words);
+      }
+      return;
+    }
+  }
+  put(word[0]);
+  put(": unknown command, help lists them\r\n");
+}
+
+void Shell_Init(void (*snapshot)(TeleGameType *g)){
+  uint32_t i;
+  Game = snapshot;
+  LineCount = 0;
+  LineLong = 0;
+  LastEnd = 0;
+  OutCount = 0;
+  PsMs = LcdMs = 0;
+  for(i = 0; i < SHELL_THREADS; i++){
+    PsLast[i].valid = 0;
+  }
+  put("\r\nshell, help lists the commands\r\n> ");
+  send();
+}
+
+void Shell_Input(char c){
+  if((c == CR) || (c == LF)){
+    if(LastEnd && (c != LastEnd)){
+      LastEnd = 0;                    // the LF of CR LF, or the CR of LF CR
+      return;
+    }
+    LastEnd = c;
+    put("\r\n");
+    if(LineLong){
+      put("line too long, at most ");
+      num(SHELL_LINE - 1, 1);
+      put(" characters\r\n");
+    }else{
+      Line[LineCount] = 0;
+      run();
+    }
+    LineCount = 0;
+    LineLong = 0;
+    put("> ");
+    send();
+    return;
+  }
+  LastEnd = 0;
+  if((c == BS) || (c == DEL)){
+    if(LineCount){
+      LineCount--;
+      put("\b \b");
+    }
+  }else if(c == 0x03){                // Ctrl-C
+    LineCount = 0;
+    LineLong = 0;
+    put("^C\r\n> ");
+  }else if((c < SP) || (c > '~')){
+    return;                           // not printable, ignored
+  }else if(LineCount < SHELL_LINE - 1){
+    Line[LineCount++] = c;
+    Line[LineCount] = 0;
+    put(&Line[LineCount - 1]);        // echo
+  }else{
+    LineLong = 1;
+  }
+  send();
+}
@@ -0,0 +1,50 @@
+#ifndef SHELL_H
+#define SHELL_H
+
+#include <stdint.h>
+#include "telemetry.h"
+
+// Command shell on UART0, for a terminal at 115200 baud: type a command
+// and Enter, the reply ends with the prompt "> ".
+//   help  the commands
+//   ps    threads: state, priority, game cell, CPU % since the last ps,
+//         most words of stack ever used
+//   sem   LCDFree and CubeCnt: value, threads waiting, contended waits
+//   lcd   LCD bus bytes/s, fills/s and % busy since the last lcd
+//   fifo  UART0 queues, Log ring and joystick FIFO: fill and losses
+//   game  page, score, rounds and cubes
+//   snd   sound sequencer notes; with SOUND_WAVE the mixer's voices,
+//         underruns and the cycles and CPU % of mixing the last block
+// CPU % counts the interrupts a thread was preempted by as its own; the
+// first ps, and a thread added since the one before, show "-".
+//
+// The parser keeps at most SHELL_LINE-1 characters and SHELL_WORDS
+// words of a line; a longer line is refused whole.  Backspace or DEL
+// erases, Ctrl-C drops the line, other control bytes are ignored.
+// No heap and no printf: numbers are formatted here and replies go out
+// through UART_Write(), waiting while Tx_UARTFifo is full.
+//
+// Shell_Input() is not reentrant, one thread feeds it; UART0 has one
+// writer, so that thread runs in place of the Telemetry thread (Main.c
+// SHELL_UART).  Host build: the program provides UART_Write(),
+// OS_Threads() and the counters the commands read, see tools/shelltest.c.
+
+#define SHELL_LINE  40        // bytes of a line, the terminating 0 included
+#define SHELL_WORDS 3         // command and arguments
+#define SHELL_WAIT_MS 5       // sleep while Tx_UARTFifo is full
+
+//------------Shell_Init------------
+// Forget the line and the previous samples of ps and lcd, send a banner
+// and the prompt.
+// Input: snapshot, fills in the state of the game for the game command
+// Output: none
+void Shell_Init(void (*snapshot)(TeleGameType *g));
+
+//------------Shell_Input------------
+// Take one received byte; at the end of a line run the command and send
+// its reply and the prompt.
+// Input: c, the byte
+// Output: none
+void Shell_Input(char c);
+
+#endif
@@ -1,23 +1,60 @@
+// sound.c
+// Sound sequencer on M1PWM6 (PF2), stepped by Timer5A, see sound.h.
+
 #include "tm4c123gh6pm.h"
+#ifdef SOUND_SIM
+#include "SoundSim.h"
+#endif
 #include "sound.h"
 #include "os.h"
+#include "trace.h"
+#if SOUND_WAVE
+#include "wave.h"
+#endif
+
+long StartCritical(void);    // previous I bit, disable interrupts
+void EndCritical(long sr);    // restore I bit to previous value
 
-typedef struct {
-  uint16_t frequency;  //Frequency corresponding to the note
-  uint16_t duration;   //How long to play the note in millisecond
-} Note;
+#define NVIC_EN2_INT92 0x10000000  // Interrupt 92 enable, Timer5A
+#define PWM_CLOCK (80000000/64)    // PWM1 counts the bus clock divided by 64
 
-const Note GameOverTune[] = {
+SoundStatsType SoundStats;
+static SoundNote Queue[SOUND_QUEUE];
+static volatile uint32_t PutI, GetI;   // notes queued and taken, wrap
+static volatile uint32_t Remaining;    // ticks left of the note playing, 0 if none
+
+const SoundNote ScoreTune[] = {
+  {1568, 40},   // G5
+  {0, 0}
+};
+
+const SoundNote GameOverTune[] = {
   {1046, 150},  // C5
+  {0,     20},
   {987,  150},  // B4
-  {932,  150},  // A# 
+  {0,     20},
+  {932,  150},  // A#
+  {0,     20},
   {880,  150},  // A
+  {0,     20},
   {830,  150},  // G#
+  {0,     20},
   {784,  300},  // G4
   {0, 0}
 };
 
+const SoundNote BeginningTune[] = {
+  {523,  80},   // C5
+  {659,  80},   // E5
+  {784,  80},   // G5
+  {1046, 160},  // C6
+  {0, 0}
+};
+
 void Sound_Init(void){
+#if SOUND_WAVE
+  Wave_Init();                    // PF2 and PWM1 belong to the mixer
+#else
   SYSCTL_RCGCPWM_R |= 0x02;       // Activate PWM1
   SYSCTL_RCGCGPIO_R |= 0x20;      // Activate Port F
   while((SYSCTL_PRGPIO_R & 0x20) == 0){}; // Ready
@@ -29,69 +66,167 @@ void Sound_Init(void){
   GPIO_PORTF_DIR_R |= 0x04;       // PF2 output
   GPIO_PORTF_DEN_R |= 0x04;       // enable digital I/O on PF2
 
-  SYSCTL_RCC_R |= SYSCTL_RCC_USEPWMDIV;     
-  SYSCTL_RCC_R = (SYSCTL_RCC_R & ~SYSCTL_RCC_PWMDIV_M) + SYSCTL_RCC_PWMDIV_64; 
+  SYSCTL_RCC_R |= SYSCTL_RCC_USEPWMDIV;
+  SYSCTL_RCC_R = (SYSCTL_RCC_R & ~SYSCTL_RCC_PWMDIV_M) + SYSCTL_RCC_PWMDIV_64;
 
   PWM1_3_CTL_R = 0;               // Generator 3 disable
   PWM1_3_GENA_R = 0xC8;           // low on LOAD, high on CMPA down
   PWM1_3_LOAD_R = 1000;           // Set period (1.25kHz)
   PWM1_3_CMPA_R = 500;            // 50% duty
   PWM1_3_CTL_R |= 0x01;           // enable generator
-
- // PWM1_ENABLE_R |= 0x40;          // enable M1PWM6 (bit 6)
+  PWM1_ENABLE_R &= ~0x40;         // M1PWM6 off until a note plays
+#endif
+
+  SYSCTL_RCGCTIMER_R |= 0x20;     // Activate Timer5
+  while((SYSCTL_PRTIMER_R & 0x20) == 0){};
+  TIMER5_CTL_R &= ~TIMER_CTL_TAEN; // stopped until a note is queued
+  TIMER5_CFG_R = TIMER_CFG_32_BIT_TIMER;
+  TIMER5_TAMR_R = TIMER_TAMR_TAMR_PERIOD;
+  TIMER5_TAILR_R = SOUND_TICK_MS*TIME_1MS - 1;
+  TIMER5_TAPR_R = 0;
+  TIMER5_ICR_R = TIMER_ICR_TATOCINT;
+  TIMER5_IMR_R |= TIMER_IMR_TATOIM;
+  NVIC_PRI23_R = (NVIC_PRI23_R&0xFFFFFF00)|(SOUND_PRIORITY << 5); // bits 7-5
+  NVIC_EN2_R = NVIC_EN2_INT92;
+  PutI = GetI = Remaining = 0;
 }
 
-
-//******************* Test Buzzer **********
-//void Sound_On(void){
-//  PWM1_ENABLE_R |= 0x40; // Enable M1PWM6
-//}
-
-//void Sound_Off(void){
-//  PWM1_ENABLE_R &= ~0x40; // Disable M1PWM6
-//}
-
 void PlaySound(uint32_t frequency){
-  uint32_t period = 80000000 / 64 / frequency;
+#if SOUND_WAVE
+  Wave_Square(frequency);
+#else
+  uint32_t period = PWM_CLOCK / frequency;
 
-  PWM1_3_LOAD_R = period;
+  PWM1_3_LOAD_R = period - 1;    // counts LOAD down to 0, LOAD+1 clocks
   PWM1_3_CMPA_R = period / 2;
   PWM1_ENABLE_R |= 0x40; // Enable M1PWM6 (PF2)
+#endif
 }
 
 void StopSound(void){
+#if SOUND_WAVE
+  Wave_Square(0);
+#else
   PWM1_ENABLE_R &= ~0x40;         // Disable M1PWM6
+#endif
+}
+
+// start the next queued note, or stop the buzzer and Timer5A if there
+// is none; interrupts disabled or in Timer5A_Handler()
+static void next(void){
+  SoundNote note;
+  if(GetI == PutI){
+    StopSound();
+    TIMER5_CTL_R &= ~TIMER_CTL_TAEN;
+    TIMER5_ICR_R = TIMER_ICR_TATOCINT; // a timeout not yet taken is void
+    Remaining = 0;
+    return;
+  }
+  note = Queue[GetI&(SOUND_QUEUE - 1)];
+  GetI++;
+  if(note.frequency){
+    PlaySound(note.frequency);
+  }else{
+    StopSound();
+  }
+  Remaining = note.duration/SOUND_TICK_MS;
+  SoundStats.notes++;
+}
+
+void Timer5A_Handler(void){
+  TRACE(TRACE_ISR_ENTER, TRACE_CURRENT, TRACE_IRQ_TIMER5A);
+  TIMER5_ICR_R = TIMER_ICR_TATOCINT; // acknowledge timer5A timeout
+  SoundStats.ticks++;
+  if(Remaining && (--Remaining == 0)){   // 0, stopped while the interrupt was pending
+    next();
+  }
+  TRACE(TRACE_ISR_EXIT, TRACE_CURRENT, TRACE_IRQ_TIMER5A);
+}
+
+// queue n notes, interrupts disabled; start them if nothing plays
+static int put(const SoundNote *notes, uint32_t n){
+  uint32_t i;
+  if(SOUND_QUEUE - (PutI - GetI) < n){
+    SoundStats.dropped += n;
+    return 0;
+  }
+  for(i = 0; i < n; i++){
+    Queue[PutI&(SOUND_QUEUE - 1)] = notes[i];
+    PutI++;
+  }
+  if(Remaining == 0){
+    next();
+    TIMER5_TAV_R = SOUND_TICK_MS*TIME_1MS - 1;  // the first tick one period from now
+    TIMER5_CTL_R |= TIMER_CTL_TAEN;
+  }
+  return 1;
+}
+
+int Sound_Note(uint32_t frequency, uint32_t duration){
+  SoundNote note;
+  int ok;
+  long sr;
+  if(duration < SOUND_TICK_MS){
+    return 1;                     // nothing to play
+  }
+  note.frequency = frequency;
+  note.duration = duration;
+  sr = StartCritical();
+  ok = put(&note, 1);
+  EndCritical(sr);
+  return ok;
+}
+
+int Sound_Tune(const SoundNote *tune){
+  uint32_t n = 0;
+  int ok;
+  long sr;
+  while(tune[n].duration){
+    n++;
+  }
+  if(n == 0){
+    return 1;
+  }
+  sr = StartCritical();
+  ok = put(tune, n);
+  EndCritical(sr);
+  return ok;
+}
+
+void Sound_Stop(void){
+  long sr = StartCritical();
+  GetI = PutI;
+  next();                         // nothing left, silence
+#if SOUND_WAVE
+  Wave_Stop();                    // and the samples over it
+#endif
+  EndCritical(sr);
+}
+
+int Sound_Busy(void){
+  return Remaining != 0;
 }
 
+//******************* Test Buzzer **********
+//void Sound_On(void){
+//  PWM1_ENABLE_R |= 0x40; // Enable M1PWM6
+//}
 
-//void PlayGameOverTune(void){
-//  int i = 0;
-//  while (GameOverTune[i].frequency != 0){
-//    PlaySound(GameOverTune[i].frequency);
-//    OS_Sleep(GameOverTune[i].duration);
-//    StopSound();
-//    OS_Sleep(20);
-//    i++;
-//  }
+//void Sound_Off(void){
+//  PWM1_ENABLE_R &= ~0x40; // Disable M1PWM6
 //}
 
 void GetScoreSound(void){
-  PlaySound(1568);            //G5,1568Hz
-  for(volatile int i = 0; i < 400000; i++){} 
-  StopSound();
+  Sound_Tune(ScoreTune);
+#if SOUND_WAVE
+  Wave_Tone(&WaveSine, 3136, 120, WAVE_GAIN/2); // a sine an octave up rings on
+#endif
 }
 
 void PlayGameOverSound(void){
-  int i = 0;
-  while (GameOverTune[i].frequency != 0){
-    PlaySound(GameOverTune[i].frequency);
-
-    for(int j = 0; j < 800000; j++){}
-
-    StopSound();
-			
-    for(int k = 0; k < 400000; k++){}
+  Sound_Tune(GameOverTune);
+}
 
-    i++;
-  }
+void BeginningSound(void){
+  Sound_Tune(BeginningTune);
 }
@@ -3,14 +3,87 @@
 
 #include <stdint.h>
 
+// Sound sequencer on the buzzer at PF2 (M1PWM6).  Callers queue notes
+// and return at once, from threads or interrupts; Timer5A interrupts
+// every SOUND_TICK_MS while something plays, counts down the note
+// playing and starts the next by reprogramming PWM1_3_LOAD_R and
+// PWM1_3_CMPA_R.  With the queue empty Timer5A stops, so silence costs
+// no interrupts.  A note starts on the tick its predecessor ends, the
+// first as soon as it is queued.
+//
+// SOUND_WAVE 1 hands the buzzer to the sample mixer of wave.c: the
+// notes play as its square voice and effects can add samples over them.
+//
+// Host build (for tools/soundtest.c): compile with -DSOUND_SIM, the
+// registers become SoundSim.c's model of PWM1 and Timer5A, and the
+// notes drive PWM1 directly.
+
+#ifndef SOUND_WAVE
+#ifdef SOUND_SIM
+#define SOUND_WAVE 0
+#else
+#define SOUND_WAVE 1
+#endif
+#endif
+
+#define SOUND_QUEUE    32     // notes queued, must be a power of 2
+#define SOUND_TICK_MS  1      // Timer5A period while playing
+#define SOUND_PRIORITY 5      // Timer5A, below the buttons and the OS timers
+
+typedef struct {
+  uint16_t frequency;         // Hz, 0 a rest
+  uint16_t duration;          // ms, a tune ends with a note of 0 ms
+} SoundNote;
+
+typedef struct {
+  uint32_t notes;             // notes started
+  uint32_t dropped;           // notes not queued, the queue was full
+  uint32_t ticks;             // Timer5A interrupts
+} SoundStatsType;
+extern SoundStatsType SoundStats;
+
+//------------Sound_Init------------
+// PWM1 generator 3 on PF2 at 50 % duty, output off, and Timer5A ready
+// but stopped; the queue empty.
+// Input: none
+// Output: none
 void Sound_Init(void);
 
+//------------Sound_Note------------
+// Queue one note, or a rest, after those queued before.
+// Input: frequency in Hz (0 for a rest, at least 20 otherwise),
+//        duration in ms (1 to 65535)
+// Output: 1 if queued, 0 if the queue was full
+int Sound_Note(uint32_t frequency, uint32_t duration);
+
+//------------Sound_Tune------------
+// Queue a tune, all of it or none of it.
+// Input: tune, notes ending with a note of 0 ms
+// Output: 1 if queued, 0 if the queue had no room for all of it
+int Sound_Tune(const SoundNote *tune);
+
+//------------Sound_Stop------------
+// Silence the buzzer now and empty the queue, and with SOUND_WAVE stop
+// the samples playing.
+// Input: none
+// Output: none
+void Sound_Stop(void);
+
+//------------Sound_Busy------------
+// Input: none
+// Output: 1 while a note plays or waits in the queue
+int Sound_Busy(void);
+
 void Sound_On(void);
 void Sound_Off(void);
 
+// the buzzer, at once and until the next call; the sequencer uses them,
+// with SOUND_WAVE they set the mixer's square voice
 void PlaySound(uint32_t frequency);
 void StopSound(void);
 
+// effects, queued and returning at once
 void GetScoreSound(void);
 void PlayGameOverSound(void);
+void BeginningSound(void);
 #endif
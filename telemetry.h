@@ -0,0 +1,104 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+// Telemetry frames on UART0.  Everything the board sends while replay
+// does not use UART0 goes out as frames: the Log records of log.h and
+// periodic snapshots of the game and the kernel.  tools/teledecode.c
+// reads them from a file, a serial device or a pty and writes text or
+// CSV.
+//
+// A frame is COBS encoded and ends with a 0x00 byte, the only 0x00 on
+// the line, so a decoder that starts late or loses bytes picks up at the
+// next frame.  Decoded, it holds
+//   type    1 byte, TELE_LOG ... TELE_TRACE
+//   seq     2 bytes, one more for every frame, sent or dropped
+//   payload 0 to TELE_PAYLOAD bytes
+//   crc     2 bytes, CRC-16/CCITT (0x1021, starting at 0xFFFF) of the above
+// Numbers are least significant byte first.  A gap in seq is frames the
+// board dropped because Tx_UARTFifo had no room; they are counted in
+// TeleStats.dropped too and reported in the next TELE_KERNEL record.
+//
+// Payloads are 32-bit words:
+//   TELE_LOG      whole Log records, see log.h
+//   TELE_GAME     one TeleGameType
+//   TELE_KERNEL   one TeleKernelType
+//   TELE_THREADS  OS_MsTime(), then two words per live thread:
+//                 id | state << 8 | priority << 16 | cell << 24, sleepMs
+//   TELE_TRACE    part of a kernel trace dump, see trace.h
+//
+// Budget at 115200 baud, 11520 bytes/s: the three snapshots take about
+// 250 bytes with 10 threads, 2500 bytes/s at 10 a second, which leaves
+// room for 500 Log records a second.
+//
+// Telemetry_Send() is not reentrant, one thread sends all frames.
+// Host build: telemetry.c and UART_FIFO.c as they are, the program
+// provides UART_Write() and OS_Threads().
+
+#define TELE_PAYLOAD  240     // bytes, a frame then never needs a second COBS code
+#define TELE_OVERHEAD 7       // COBS code, type, seq, crc and the 0x00 added to a payload
+
+#define TELE_LOG      1
+#define TELE_GAME     2
+#define TELE_KERNEL   3
+#define TELE_THREADS  4
+#define TELE_TRACE    5
+
+// fields of the records, in order; X(name, what)
+#define TELE_GAME_FIELDS(X) \
+  X(ms,        "OS_MsTime()") \
+  X(state,     "page, 0 main, 1 game, 2 settings") \
+  X(gameType,  "game_type") \
+  X(gameMode,  "game_mode") \
+  X(score,     "scores") \
+  X(highScore, "HighScore") \
+  X(rounds,    "nrounds left") \
+  X(cubes,     "cubeCount")
+
+#define TELE_KERNEL_FIELDS(X) \
+  X(ms,          "OS_MsTime()") \
+  X(threads,     "live threads") \
+  X(lcdValue,    "LCDFree value") \
+  X(lcdWaiting,  "threads waiting for LCDFree") \
+  X(lcdWaits,    "OS_Wait calls that found LCDFree taken") \
+  X(cubeValue,   "CubeCnt value") \
+  X(cubeWaiting, "threads waiting for CubeCnt") \
+  X(cubeWaits,   "OS_Wait calls that found CubeCnt taken") \
+  X(teleDropped, "frames dropped, Tx_UARTFifo full") \
+  X(logLost,     "Log records lost, LogRing full") \
+  X(rxDropped,   "bytes received and dropped by UART0")
+
+#define TELE_FIELD(name, what) uint32_t name;
+typedef struct { TELE_GAME_FIELDS(TELE_FIELD) } TeleGameType;
+typedef struct { TELE_KERNEL_FIELDS(TELE_FIELD) } TeleKernelType;
+
+#define TELE_THREADS_MAX ((TELE_PAYLOAD/4 - 1)/2)
+
+typedef struct {
+  uint32_t frames;          // frames sent
+  uint32_t bytes;           // bytes sent, after COBS
+  uint32_t dropped;         // frames dropped, no room in Tx_UARTFifo
+} TeleStatsType;
+extern TeleStatsType TeleStats;
+
+//------------Telemetry_Fits------------
+// Whether Tx_UARTFifo has room for a frame now.
+// Input: bytes of payload
+// Output: 1 if Telemetry_Send() would send it
+int Telemetry_Fits(uint32_t bytes);
+
+//------------Telemetry_Send------------
+// Frame a payload and hand it to UART0, or drop it and count it if
+// Tx_UARTFifo has no room.  Never waits.
+// Input: type TELE_LOG ... TELE_TRACE, payload of at most TELE_PAYLOAD bytes
+// Output: 1 if sent, 0 if dropped
+int Telemetry_Send(uint32_t type, const void *payload, uint32_t bytes);
+
+//------------Telemetry_Threads------------
+// Send a TELE_THREADS frame of the live threads from OS_Threads().
+// Input: ms, OS_MsTime() of the snapshot
+// Output: 1 if sent, 0 if dropped
+int Telemetry_Threads(uint32_t ms);
+
+#endif
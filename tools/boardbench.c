@@ -0,0 +1,151 @@
+// boardbench.c
+// Host tool: claim/move throughput of the bitboard in board.c against
+// the 36-semaphore cell path it replaced (semaArray[], OS_nWait() and
+// OS_bSignal1() from the old os.c, copied below with the critical
+// sections removed, as board.c is built here).
+//
+// build: gcc -std=gnu99 -O2 -DHOST_SIM -I. -o boardbench tools/boardbench.c board.c
+// usage: ./boardbench
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include "board.h"
+
+#define OWNERS 20          // NUMTHREADS in os.c
+#define MOVES  10000000
+
+//------------old semaphore path------------
+#define MAX_WAITING_THREADS 15
+typedef struct {
+  long Value;
+  int id;
+  int waitingThreads[MAX_WAITING_THREADS];
+  int waitingCount;
+} Sema4Type;
+typedef struct {
+  uint32_t id;
+  Sema4Type *blockid;
+} tcbType;
+
+static Sema4Type semaArray[36];
+static tcbType tcbs[OWNERS];
+static tcbType *RunPt;
+
+static void OS_bSignal1(Sema4Type *semaPt){
+  semaPt->Value = 1;
+  if(RunPt->blockid == semaPt){
+    RunPt->blockid = 0;
+    semaPt->id = 0;
+  }
+}
+
+static int OS_nWait(Sema4Type *semaPt){
+  if(semaPt->Value == 0 && RunPt->blockid != semaPt) return 0;
+  if(RunPt->blockid == semaPt) return 1;
+  if(RunPt->blockid != 0) OS_bSignal1(RunPt->blockid);
+  semaPt->Value = 0;
+  semaPt->id = RunPt->id;
+  RunPt->blockid = semaPt;
+  return 1;
+}
+
+static int semaCheck(int x, int y){
+  return OS_nWait(&semaArray[x*6 + y]);
+}
+
+//------------new board path------------
+static uint8_t Cell[OWNERS];
+
+static int boardCheck(int x, int y){
+  uint8_t cell = BOARD_CELL(x, y);
+  if(!Board_Move(Cell[RunPt->id], cell, RunPt->id)) return 0;
+  Cell[RunPt->id] = cell;
+  return 1;
+}
+
+static double now(void){
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec*1e9 + t.tv_nsec;
+}
+
+// the same pseudo random walk for both paths: owner i tries a
+// neighbor of the cell it is aiming at, like addTile()
+static double run(int (*check)(int, int), uint32_t *granted){
+  uint32_t lfsr = 0xACE1u;
+  int x[OWNERS], y[OWNERS];
+  int i, k;
+  double t0;
+  *granted = 0;
+  for(i = 0; i < OWNERS; i++){
+    x[i] = i % 6;
+    y[i] = i / 6;
+  }
+  t0 = now();
+  for(k = 0; k < MOVES; k++){
+    lfsr = (lfsr >> 1) ^ (-(lfsr & 1u) & 0xB400u);
+    i = k % OWNERS;
+    RunPt = &tcbs[i];
+    switch(lfsr & 3){
+      case 0: if(x[i] < 5) x[i]++; break;
+      case 1: if(x[i] > 0) x[i]--; break;
+      case 2: if(y[i] < 5) y[i]++; break;
+      default: if(y[i] > 0) y[i]--; break;
+    }
+    *granted += check(x[i], y[i]);
+  }
+  return (now() - t0)/MOVES;
+}
+
+// free cells next to every cell: four semaphore reads per cell
+// against one shift-and-mask on the board
+static uint32_t semaFree(int cell){
+  int x = cell/6, y = cell%6;
+  uint32_t n = 0;
+  if(x < 5 && semaArray[cell + 6].Value) n++;
+  if(x > 0 && semaArray[cell - 6].Value) n++;
+  if(y < 5 && semaArray[cell + 1].Value) n++;
+  if(y > 0 && semaArray[cell - 1].Value) n++;
+  return n;
+}
+
+static uint32_t boardFree(int cell){
+  return __builtin_popcountll(Board_FreeNeighbors(cell));
+}
+
+static double scan(uint32_t (*query)(int), uint32_t *found){
+  int k;
+  double t0;
+  *found = 0;
+  t0 = now();
+  for(k = 0; k < MOVES; k++){
+    *found += query(k % BOARD_CELLS);
+  }
+  return (now() - t0)/MOVES;
+}
+
+int main(void){
+  uint32_t granted;
+  double ns;
+  int i;
+  for(i = 0; i < 36; i++){
+    semaArray[i].Value = 1;
+  }
+  for(i = 0; i < OWNERS; i++){
+    tcbs[i].id = i;
+    Cell[i] = BOARD_FREE;
+  }
+  ns = run(semaCheck, &granted);
+  printf("semaphores %5.2f ns/claim  %4.1f M claims/s  %u granted  %u bytes\n",
+         ns, 1e3/ns, granted, (unsigned)sizeof(semaArray));
+  Board_Init();
+  ns = run(boardCheck, &granted);
+  printf("bitboard   %5.2f ns/claim  %4.1f M claims/s  %u granted  %u bytes\n",
+         ns, 1e3/ns, granted, (unsigned)(sizeof(BoardTaken) + sizeof(BoardOwner)));
+  ns = scan(semaFree, &granted);
+  printf("semaphores %5.2f ns/free-neighbor query  %u found\n", ns, granted);
+  ns = scan(boardFree, &granted);
+  printf("bitboard   %5.2f ns/free-neighbor query  %u found\n", ns, granted);
+  return 0;
+}
@@ -0,0 +1,56 @@
+// cubebench.c
+// Host tool: time Cube_Step() from cube.c for 4, 16 and 36 cubes.
+// On the target the step is part of the sim time in FrameLog[] in
+// Main.c when game.h has CUBE_ENGINE 1.
+//
+// build: gcc -std=gnu99 -O2 -DHOST_SIM -I. -o cubebench tools/cubebench.c cube.c board.c
+// usage: ./cubebench
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include "cube.h"
+
+#define STEPS 200000
+
+static double now(void){
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec*1e9 + t.tv_nsec;
+}
+
+// ns per step when every cube is due (a move attempt each) and when
+// every cube is resting (the usual 50 ms tick)
+static void bench(int n){
+  double t0, busy, idle;
+  int i, moves = 0;
+  Cube_Init();
+  for(i = 0; i < n; i++){
+    Cube_Spawn(i/6, i%6, i&3, i%CUBE_COLORS);  // fill the grid column by column
+  }
+  CubeDrawCount = 0;
+  t0 = now();
+  for(i = 0; i < STEPS; i++){
+    Cube_Step(CUBE_MOVE_MS);
+    moves += CubeDrawCount/2;
+    CubeDrawCount = 0;
+  }
+  busy = (now() - t0)/STEPS;
+  for(i = 0; i < CUBE_MAX; i++){
+    CubeWait[i] = CUBE_MOVE_MS;
+  }
+  t0 = now();
+  for(i = 0; i < STEPS; i++){
+    Cube_Step(0);                  // a 0 ms step never ends a wait
+  }
+  idle = (now() - t0)/STEPS;
+  printf("%2d cubes  %7.1f ns/step all due (%.2f moves/step)  %7.1f ns/step resting\n",
+         n, busy, (double)moves/STEPS, idle);
+}
+
+int main(void){
+  bench(4);
+  bench(16);
+  bench(36);
+  return 0;
+}
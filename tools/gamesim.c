@@ -0,0 +1,534 @@
+// gamesim.c
+// Headless host build of the game: game.c, cube.c and board.c run
+// without the RTOS or the LCD, one frame after another with no real
+// time in between, and a scripted player moves the joystick.  Reports
+// the score distribution, the per-frame work and the refused cell
+// claims (the board's stand-in for lock contention), or replays
+// recordings from replay.c and checks their scores.  Built with
+// -DLCD_SIM it can also draw every frame the way render() in Main.c
+// does, through LCD.c into the panel model of ST7735Sim.c, and count
+// the SPI bytes of each part of the screen.
+//
+// build: gcc -std=gnu99 -O2 -DHOST_SIM -DCUBE_ENGINE=1 -I. -o gamesim tools/gamesim.c game.c cube.c board.c replay.c
+//   or:  gcc -std=gnu99 -O2 -DHOST_SIM -DCUBE_ENGINE=1 -DLCD_SIM -I. -o gamesim tools/gamesim.c game.c cube.c board.c replay.c widget.c LCD.c ST7735Sim.c
+// usage: ./gamesim [-games n] [-player idle|random|bot] [-type t] [-mode m]
+//                  [-seconds s] [-seed n] [-record file] [-hud message|widgets]
+//                  [-erase flat|shadow]
+//        ./gamesim -replay file [-hud message|widgets] [-erase flat|shadow]
+//   -type     game_type, 0 five cubes, 1 Solus
+//   -mode     game_mode, 0 to 2 for 50/100/200 rounds, 3 endless (stopped after -seconds)
+//   -record   also write the games in the replay.c format
+//   -hud      (LCD_SIM) draw the frames, the rounds and score line with
+//             BSP_LCD_Message() on every frame as the game did before
+//             widget.c, or with the widgets of Main.c; report its bytes/s
+//   -erase    (LCD_SIM) draw the frames, erasing the old crosshair in the
+//             background color as the game did before the tile shadow, or
+//             from the tile shadow as Main.c does; count the pixels of
+//             cubes the erase spoils and the tile redraws that repair them
+// Exit status 1 also if -erase shadow spoils a pixel.
+// Exit status 1 if a replayed game does not end with its recorded score.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "board.h"
+#include "cube.h"
+#include "game.h"
+#include "replay.h"
+#ifdef LCD_SIM
+#include "LCD.h"
+#include "ST7735Sim.h"
+#include "widget.h"
+#endif
+
+#define STREAM_MAX (16 << 20)
+#define GAMES_MAX  100000
+#define TICKS_PER_FRAME 2       // Producer samples per frame, 10 ms and 20 ms
+
+static uint8_t Stream[STREAM_MAX];
+static int Scores[GAMES_MAX];
+
+typedef struct {
+  uint64_t frames, swept, hits, draws, blocked;
+  double ns, nsMax;             // host time per frame
+} WorkType;
+static WorkType Work;
+
+static double now(void){
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec*1e9 + t.tv_nsec;
+}
+
+//------------players------------
+// each returns one joystick sample, 0 to 4095 on each axis
+static uint32_t Lfsr = 0xACE1u;
+static uint16_t HoldX, HoldY;
+static int Hold;
+
+static void playIdle(uint16_t *rx, uint16_t *ry){
+  *rx = *ry = 2048;
+}
+
+// the stick pushed somewhere at random, held for 0.1 to 1 s
+static void playRandom(uint16_t *rx, uint16_t *ry){
+  static const uint16_t level[3] = {0, 2048, 4095};
+  if(Hold-- <= 0){
+    Lfsr = (Lfsr >> 1) ^ (-(Lfsr & 1u) & 0xB400u);
+    HoldX = level[Lfsr % 3];
+    HoldY = level[(Lfsr >> 4) % 3];
+    Hold = 10 + (Lfsr >> 8) % 90;
+  }
+  *rx = HoldX;
+  *ry = HoldY;
+}
+
+// steer to the middle of the nearest cube
+static void playBot(uint16_t *rx, uint16_t *ry){
+  int i, d, best = 1 << 30, tx = aimX, ty = aimY;
+  for(i = 0; i < CUBE_MAX; i++){
+    if(CubeAlive[i] != CUBE_LIVE) continue;
+    d = abs(CubeX[i]*21 + 10 - aimX) + abs(CubeY[i]*19 + 9 - aimY);
+    if(d < best){
+      best = d;
+      tx = CubeX[i]*21 + 10;
+      ty = CubeY[i]*19 + 9;
+    }
+  }
+  *rx = (tx > aimX) ? 4095 : ((tx < aimX) ? 0 : 2048);
+  *ry = (ty > aimY) ? 0 : ((ty < aimY) ? 4095 : 2048);   // y grows with the stick pulled down
+}
+
+#ifdef LCD_SIM
+//------------the screen------------
+// render() of Main.c with CUBE_ENGINE 1, drawn into the panel model
+#define BG          0x1AA6      // game background
+#define HUD_MESSAGE 1           // Hud
+#define HUD_WIDGETS 2
+#define ERASE_FLAT   1          // Erase
+#define ERASE_SHADOW 2
+
+static const uint16_t Colors[CUBE_COLORS] = {   // colors[] in Main.c
+  0xF647, 0xF500, 0xF493, 0xF69B, 0xFD00, 0xF800, 0xF68C, 0xF493, 0xBFFF, 0xFF7F,
+  0xDFFF, 0x7F00, 0xFF00, 0xFBC1, 0xF500, 0x2CD3, 0xFD00, 0xF5FA, 0xA52A, 0xF4A3
+};
+static int Hud, Erase;          // both 0 draws nothing
+static uint16_t TileShadow[36], TileLow[36];
+static uint16_t Ref[118][128];  // the play field as it should look without the crosshair
+static int16_t PrevX, PrevY;
+static WidgetType RoundsLabel, RoundsField, ScoreLabel, ScoreField;
+
+typedef struct {
+  uint64_t frames;
+  uint64_t hud;                 // bytes of the rounds and score line
+  uint64_t erase;               // bytes of the crosshair erase
+  uint64_t spoiled;             // pixels the erase left different from Ref
+  uint64_t redraws, redrawn;    // tiles redrawn to repair them, and their bytes
+} ScreenType;
+static ScreenType Screen;
+
+static uint32_t bytes(void){
+  SimStatsType s;
+  ST7735Sim_Stats(&s);
+  return s.commands + s.data;
+}
+
+// a rectangle on the LCD and in Ref
+static void fill(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color){
+  int16_t i, j;
+  BSP_LCD_FillRect(x, y, w, h, color);
+  for(j = y; (j < y + h) && (j < 118); j++){
+    for(i = x; (i < x + w) && (i < 128); i++){
+      Ref[j][i] = color;
+    }
+  }
+}
+
+// TileDrawn() and TileColorAt() of Main.c
+static void tileDrawn(uint8_t cell, uint16_t color){
+  TileShadow[cell] = color;
+  TileLow[cell] = color;
+  if(cell%6) TileLow[cell - 1] = color;
+}
+
+static uint16_t tileColorAt(int16_t px, int16_t py){
+  int cx = px/21, cy = py/19;
+  if(py >= 118) return LCD_BLACK;
+  if(cx > 5) return BG;
+  if((cy >= 1) && (py < cy*19 + 2)) return TileLow[cx*6 + cy - 1];
+  if(cy <= 5) return TileShadow[cx*6 + cy];
+  return BG;
+}
+
+// the screen Updater() leaves at the start of a game
+static void screenStart(void){
+  int i;
+  BSP_LCD_FillScreen(LCD_BLACK);
+  fill(0, 0, 128, 118, BG);
+  for(i = 0; i < 36; i++){
+    tileDrawn(i, BG);
+  }
+  Widget_Invalidate(&RoundsLabel);
+  Widget_Invalidate(&RoundsField);
+  Widget_Invalidate(&ScoreLabel);
+  Widget_Invalidate(&ScoreField);
+  PrevX = aimX;
+  PrevY = aimY;
+  BSP_LCD_DrawCrosshair(aimX, aimY, LCD_WHITE);
+}
+
+// a pixel the crosshair erase left different from Ref: mark the tile
+// that was drawn there, the one a cube thread had to draw again
+static void spoiled(int16_t px, int16_t py, uint64_t *tiles){
+  int cx = px/21, cy;
+  if((py >= 118) || (ST7735Sim_GetPixel(px, py) == Ref[py][px])) return;
+  Screen.spoiled++;
+  for(cy = py/19; (cy >= 0) && (cy*19 + 21 > py); cy--){
+    if((cx <= 5) && (cy <= 5) && (TileShadow[cx*6 + cy] == Ref[py][px])){
+      *tiles |= BOARD_BIT(cx*6 + cy);
+      return;
+    }
+  }
+}
+
+// erase the crosshair at PrevX,PrevY, then repair what it spoiled
+static void erase(void){
+  uint64_t tiles = 0;
+  uint32_t b = bytes();
+  int16_t i;
+  uint8_t cell;
+  if(Erase == ERASE_FLAT){
+    BSP_LCD_DrawCrosshair(PrevX, PrevY, BG);
+  }else{
+    BSP_LCD_EraseCrosshair(PrevX, PrevY, tileColorAt);
+  }
+  Screen.erase += bytes() - b;
+  for(i = PrevY - 5; i < PrevY + 5; i++){      // the lines of BSP_LCD_DrawCrosshair()
+    if((i >= 0) && (PrevX >= 0) && (PrevX < 128)) spoiled(PrevX, i, &tiles);
+  }
+  for(i = PrevX - 5; i < PrevX + 5; i++){
+    if((i >= 0) && (i < 128) && (PrevY >= 0)) spoiled(i, PrevY, &tiles);
+  }
+  b = bytes();
+  for(cell = 0; tiles; cell++){
+    if(tiles & BOARD_BIT(cell)){
+      fill((cell/6)*21, (cell%6)*19, 21, 21, TileShadow[cell]);
+      tileDrawn(cell, TileShadow[cell]);
+      Screen.redraws++;
+      tiles &= ~BOARD_BIT(cell);
+    }
+  }
+  Screen.redrawn += bytes() - b;
+}
+
+static void screenFrame(int hit){
+  uint32_t i, b;
+  uint16_t color;
+  uint8_t cell;
+  for(cell = 0; cell < 36; cell++){
+    if(HitCells & BOARD_BIT(cell)){
+      fill((cell/6)*21, (cell%6)*19, 17, 17, BG);
+      TileShadow[cell] = BG;
+    }
+  }
+  for(i = 0; i < CubeDrawCount; i++){
+    cell = CubeDrawList[i].cell;
+    color = (CubeDrawList[i].color == CUBE_ERASE) ? BG : Colors[CubeDrawList[i].color];
+    fill((cell/6)*21, (cell%6)*19, 21, 21, color);
+    tileDrawn(cell, color);
+  }
+  if(!hit){
+    erase();
+    BSP_LCD_DrawCrosshair(aimX, aimY, LCD_WHITE);
+    PrevX = aimX;
+    PrevY = aimY;
+  }
+  b = bytes();
+  if(Hud == HUD_MESSAGE){
+    BSP_LCD_Message(1, 0, 1, "X > ", nrounds);
+    BSP_LCD_Message(1, 0, 13, "s > ", scores);
+  }else{
+    Widget_Label(&RoundsLabel, "X > ");
+    Widget_Number(&RoundsField, nrounds);
+    Widget_Label(&ScoreLabel, "s > ");
+    Widget_Number(&ScoreField, scores);
+  }
+  Screen.hud += bytes() - b;
+  Screen.frames++;
+}
+
+static void screenReport(void){
+  double s = Screen.frames*FRAME_MS/1000.0;
+  printf("screen: %llu frames, %.0f s of game time, %.0f bytes/s to the LCD in all\n",
+         (unsigned long long)Screen.frames, s, bytes()/s);
+  printf("  HUD (%s)  %llu bytes, %.0f bytes/s\n", (Hud == HUD_MESSAGE) ? "BSP_LCD_Message" : "widgets",
+         (unsigned long long)Screen.hud, Screen.hud/s);
+  printf("  crosshair erase (%s)  %.1f bytes/frame, %llu cube pixels spoiled, %llu tile redraws"
+         " (%llu bytes, %.0f bytes/s)\n", (Erase == ERASE_FLAT) ? "background" : "tile shadow",
+         (double)Screen.erase/Screen.frames, (unsigned long long)Screen.spoiled,
+         (unsigned long long)Screen.redraws, (unsigned long long)Screen.redrawn, Screen.redrawn/s);
+}
+#endif
+
+//------------one frame------------
+// what the render phase would draw, then forgotten
+static void render(int hit){
+#ifdef LCD_SIM
+  if(Hud || Erase) screenFrame(hit);
+#endif
+  Work.draws += CubeDrawCount + __builtin_popcountll(HitCells) + (hit ? 0 : 2);
+  CubeDrawCount = 0;
+  HitCells = 0;
+}
+
+static void frame(uint32_t steps){
+  double t = now();
+  uint32_t i;
+  int hit = Game_Update();
+  for(i = 0; i < steps; i++){
+    Game_Step();
+  }
+  render(hit);
+  t = now() - t;
+  Work.ns += t;
+  if(t > Work.nsMax) Work.nsMax = t;
+  Work.frames++;
+}
+
+static void endGame(void){
+  Work.swept += GameStats.swept;
+  Work.hits += GameStats.hits;
+}
+
+//------------play------------
+static int play(int games, void (*player)(uint16_t *, uint16_t *), int seconds, uint32_t seed, int record){
+  ReplaySessionType s;
+  uint16_t rx, ry;
+  int16_t x, y;
+  int g, k;
+  double t0 = now();
+  if(record){
+    Replay_Init(REPLAY_RECORD, Stream, STREAM_MAX);
+  }
+  for(g = 0; g < games; g++){
+    lfsr32 = 0xABCDEFAB;              // as init_lfsr() in Main.c, lfsr31 is an ADC value
+    lfsr31 = (seed + g) & 0xFFF;
+    Game_Calibrate(2048, 2048);
+    aimX = aimY = 63;
+    s.lfsr32 = lfsr32;
+    s.lfsr31 = lfsr31;
+    s.gameType = game_type;
+    s.gameMode = game_mode;
+    s.x = aimX;
+    s.y = aimY;
+    Replay_Begin(&s);
+    Game_Start();
+#ifdef LCD_SIM
+    if(Hud || Erase) screenStart();
+#endif
+    CubeBlocked = 0;
+    while(!Game_Over() && (GameMs < seconds*1000u)){
+      for(k = 0; k < TICKS_PER_FRAME; k++){
+        player(&rx, &ry);
+        Game_Joystick(rx, ry, &x, &y);
+        Game_Aim(x, y);
+        Replay_Sample(x, y);
+      }
+      frame(1);
+      Replay_Frame(1);
+    }
+    Replay_End(scores);
+    Work.blocked += CubeBlocked;
+    endGame();
+    Scores[g] = scores;
+  }
+  return (int)(games/((now() - t0)*1e-9));
+}
+
+//------------replay------------
+static int replay(const char *name, int *games){
+  ReplayEventType e;
+  FILE *f = fopen(name, "rb");
+  uint32_t size;
+  int failed = 0, pushed = 0, over = 1;
+  if(!f){
+    perror(name);
+    exit(1);
+  }
+  size = fread(Stream, 1, STREAM_MAX, f);
+  fclose(f);
+  Replay_Init(REPLAY_PLAY, Stream, size);
+  *games = 0;
+  while(Replay_Used() < size){
+    switch(Replay_Read(&e)){
+      case REPLAY_BEGIN:
+        lfsr32 = e.session.lfsr32;
+        lfsr31 = e.session.lfsr31;
+        game_type = e.session.gameType;
+        game_mode = e.session.gameMode;
+        aimX = e.session.x;
+        aimY = e.session.y;
+        Game_Start();
+#ifdef LCD_SIM
+        if(Hud || Erase) screenStart();
+#endif
+        CubeBlocked = 0;
+        pushed = 0;
+        over = 0;
+        break;
+      case REPLAY_SAMPLE:
+        Game_Aim(e.x, e.y);
+        break;
+      case REPLAY_BUTTON:
+        pushed |= e.value;
+        break;
+      case REPLAY_FRAME:
+        if(!over){
+          frame(e.value);
+          // Updater() stops the game after the frame, SW2 does too
+          over = Game_Over() || (pushed & REPLAY_SW2);
+        }
+        pushed = 0;
+        break;
+      case REPLAY_END:
+        Work.blocked += CubeBlocked;
+        endGame();
+        if(*games < GAMES_MAX){
+          Scores[*games] = scores;
+        }
+        if(e.value != (uint16_t)scores){
+          printf("game %d: score %d, recorded %u\n", *games + 1, scores, e.value);
+          failed++;
+        }
+        (*games)++;
+        over = 1;
+        break;
+      default:
+        printf("%s: bad record at byte %u\n", name, Replay_Used() - 1);
+        return failed + 1;
+    }
+  }
+  printf("%s: %d games replayed, %d with a different score\n", name, *games, failed);
+  return failed;
+}
+
+//------------report------------
+static int compare(const void *a, const void *b){
+  return *(const int *)a - *(const int *)b;
+}
+
+static void report(int games){
+  int i, buckets[10] = {0}, top, b;
+  double sum = 0;
+  if(games == 0) return;
+  qsort(Scores, games, sizeof(int), compare);
+  for(i = 0; i < games; i++){
+    sum += Scores[i];
+  }
+  top = Scores[games - 1] + 1;
+  printf("score  min %d  p10 %d  median %d  p90 %d  max %d  mean %.1f\n",
+         Scores[0], Scores[games/10], Scores[games/2], Scores[games*9/10],
+         Scores[games - 1], sum/games);
+  for(i = 0; i < games; i++){
+    buckets[Scores[i]*10/top]++;
+  }
+  for(b = 0; b < 10; b++){
+    printf("  %4d-%-4d %6d ", b*top/10, (b + 1)*top/10 - 1, buckets[b]);
+    for(i = 0; i < buckets[b]*50/games; i++) putchar('#');
+    putchar('\n');
+  }
+  printf("per frame  %.2f cells swept  %.3f hits  %.2f draws  %.0f ns host (max %.0f)\n",
+         (double)Work.swept/Work.frames, (double)Work.hits/Work.frames,
+         (double)Work.draws/Work.frames, Work.ns/Work.frames, Work.nsMax);
+  printf("refused cell claims  %llu  (%.2f per game, %.3f per frame)\n",
+         (unsigned long long)Work.blocked, (double)Work.blocked/games,
+         (double)Work.blocked/Work.frames);
+}
+
+int main(int argc, char **argv){
+  void (*player)(uint16_t *, uint16_t *) = playRandom;
+  const char *recordName = 0, *replayName = 0;
+  int games = 1000, seconds = 120, rate, i;
+  uint32_t seed = 1;
+  FILE *f;
+  for(i = 1; i < argc; i++){
+    if(!strcmp(argv[i], "-replay") && (i + 1 < argc)){
+      replayName = argv[++i];
+#ifdef LCD_SIM
+    }else if(!strcmp(argv[i], "-hud") && (i + 1 < argc)){
+      i++;
+      Hud = !strcmp(argv[i], "message") ? HUD_MESSAGE : HUD_WIDGETS;
+    }else if(!strcmp(argv[i], "-erase") && (i + 1 < argc)){
+      i++;
+      Erase = !strcmp(argv[i], "flat") ? ERASE_FLAT : ERASE_SHADOW;
+#endif
+    }else if(!strcmp(argv[i], "-games") && (i + 1 < argc)){
+      games = atoi(argv[++i]);
+    }else if(!strcmp(argv[i], "-type") && (i + 1 < argc)){
+      game_type = atoi(argv[++i]);
+    }else if(!strcmp(argv[i], "-mode") && (i + 1 < argc)){
+      game_mode = atoi(argv[++i]);
+    }else if(!strcmp(argv[i], "-seconds") && (i + 1 < argc)){
+      seconds = atoi(argv[++i]);
+    }else if(!strcmp(argv[i], "-seed") && (i + 1 < argc)){
+      seed = strtoul(argv[++i], 0, 0);
+    }else if(!strcmp(argv[i], "-record") && (i + 1 < argc)){
+      recordName = argv[++i];
+    }else if(!strcmp(argv[i], "-player") && (i + 1 < argc)){
+      i++;
+      player = !strcmp(argv[i], "idle") ? playIdle : (!strcmp(argv[i], "bot") ? playBot : playRandom);
+    }else{
+      fprintf(stderr, "%s: unknown option %s\n", argv[0], argv[i]);
+      return 1;
+    }
+  }
+#ifdef LCD_SIM
+  if(Hud || Erase){
+    BSP_LCD_Init();
+    Widget_Init(&RoundsLabel, 1, 12, 4, LCD_WHITE, LCD_BLACK);   // as in main()
+    Widget_Init(&RoundsField, 5, 12, 4, LCD_WHITE, LCD_BLACK);
+    Widget_Init(&ScoreLabel, 13, 12, 4, LCD_WHITE, LCD_BLACK);
+    Widget_Init(&ScoreField, 17, 12, 4, LCD_WHITE, LCD_BLACK);
+    ST7735Sim_ClearStats();
+  }
+#endif
+  if(replayName){
+    rate = replay(replayName, &games);
+    report(games);
+#ifdef LCD_SIM
+    if(Hud || Erase) screenReport();
+    rate += (Erase == ERASE_SHADOW) && Screen.spoiled;
+#endif
+    return rate != 0;
+  }
+  if(games > GAMES_MAX) games = GAMES_MAX;
+  rate = play(games, player, seconds, seed, recordName != 0);
+  printf("%d games, type %d, mode %d: %d games/s, %llu frames (%.0f s of game time)\n",
+         games, game_type, game_mode, rate, (unsigned long long)Work.frames,
+         Work.frames*FRAME_MS/1000.0);
+  report(games);
+#ifdef LCD_SIM
+  if(Hud || Erase) screenReport();
+#endif
+  if(recordName){
+    if(Replay_Used() > STREAM_MAX){
+      fprintf(stderr, "%s: recording too long\n", recordName);
+      return 1;
+    }
+    f = fopen(recordName, "wb");
+    if(!f){
+      perror(recordName);
+      return 1;
+    }
+    fwrite(Stream, 1, Replay_Used(), f);
+    fclose(f);
+    printf("%s: %u bytes\n", recordName, Replay_Used());
+  }
+#ifdef LCD_SIM
+  return (Erase == ERASE_SHADOW) && Screen.spoiled;
+#else
+  return 0;
+#endif
+}
@@ -0,0 +1,195 @@
+#!/usr/bin/env python3
+# imgpack.py
+# Host tool: convert a PPM (P3/P6) or PNG image into a palette plus a
+# run-length coded index stream for BSP_LCD_DrawPacked().  The data goes
+# in name.c, to add to the project, and name.h declares it, so any
+# number of images can be included next to LCD.h.  Only the Python
+# standard library is used.
+#
+# usage: python3 imgpack.py image.png name            writes name.c and name.h
+#        python3 imgpack.py --quantize image.ppm name
+#
+# Stream format, one control byte followed by palette indices:
+#   0x00-0x7F  literal: the next (c+1) bytes are indices, 1 to 128 pixels
+#   0x80-0xFF  run:     the next byte is repeated (c&0x7F)+2 times, 2 to 129 pixels
+# Pixels are stored top row first, left to right, like bitmaps.h.
+
+import struct
+import sys
+import zlib
+
+
+def read_ppm(data):
+    # tokens of the header, skipping comments
+    tokens = []
+    i = 0
+    while len(tokens) < 4:
+        while data[i:i+1].isspace():
+            i += 1
+        if data[i:i+1] == b'#':
+            while data[i:i+1] not in (b'\n', b''):
+                i += 1
+            continue
+        j = i
+        while not data[j:j+1].isspace():
+            j += 1
+        tokens.append(data[i:j])
+        i = j
+    magic, w, h, maxval = tokens[0], int(tokens[1]), int(tokens[2]), int(tokens[3])
+    if magic == b'P6':
+        raw = data[i+1:]
+        if maxval > 255:
+            vals = struct.unpack('>%dH' % (w*h*3), raw[:w*h*6])
+        else:
+            vals = raw[:w*h*3]
+    elif magic == b'P3':
+        vals = [int(v) for v in data[i:].split()[:w*h*3]]
+    else:
+        raise ValueError('not a P3/P6 PPM file')
+    scale = 255.0 / maxval
+    pixels = [(int(vals[k]*scale + 0.5), int(vals[k+1]*scale + 0.5), int(vals[k+2]*scale + 0.5))
+              for k in range(0, w*h*3, 3)]
+    return w, h, pixels
+
+
+def read_png(data):
+    # minimal decoder: 8-bit truecolor or truecolor+alpha, not interlaced
+    if data[:8] != b'\x89PNG\r\n\x1a\n':
+        raise ValueError('not a PNG file')
+    pos = 8
+    idat = b''
+    while pos < len(data):
+        length, kind = struct.unpack('>I4s', data[pos:pos+8])
+        body = data[pos+8:pos+8+length]
+        pos += 12 + length
+        if kind == b'IHDR':
+            w, h, depth, ctype, _, _, interlace = struct.unpack('>IIBBBBB', body)
+            if depth != 8 or ctype not in (2, 6) or interlace:
+                raise ValueError('only 8-bit RGB/RGBA non-interlaced PNG is supported')
+        elif kind == b'IDAT':
+            idat += body
+        elif kind == b'IEND':
+            break
+    bpp = 3 if ctype == 2 else 4
+    raw = zlib.decompress(idat)
+    stride = w * bpp
+    prev = bytearray(stride)
+    pixels = []
+    pos = 0
+    for _ in range(h):
+        ftype = raw[pos]
+        line = bytearray(raw[pos+1:pos+1+stride])
+        pos += 1 + stride
+        for k in range(stride):
+            a = line[k-bpp] if k >= bpp else 0
+            b = prev[k]
+            c = prev[k-bpp] if k >= bpp else 0
+            if ftype == 1:
+                line[k] = (line[k] + a) & 0xFF
+            elif ftype == 2:
+                line[k] = (line[k] + b) & 0xFF
+            elif ftype == 3:
+                line[k] = (line[k] + ((a + b) >> 1)) & 0xFF
+            elif ftype == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                pred = a if (pa <= pb and pa <= pc) else (b if pb <= pc else c)
+                line[k] = (line[k] + pred) & 0xFF
+        pixels.extend(tuple(line[k:k+3]) for k in range(0, stride, bpp))
+        prev = line
+    return w, h, pixels
+
+
+def rgb565(r, g, b, drop=0):
+    mask = 0xFF & ~((1 << drop) - 1)
+    r, g, b = r & mask, g & mask, b & mask
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3)
+
+
+def make_palette(pixels, quantize):
+    drop = 0
+    while True:
+        colors = [rgb565(r, g, b, drop) for (r, g, b) in pixels]
+        palette = sorted(set(colors), key=colors.count, reverse=True)
+        if len(palette) <= 256:
+            return palette, colors
+        if not quantize or drop >= 7:
+            raise ValueError('%d colors, more than 256 (try --quantize)' % len(palette))
+        drop += 1
+
+
+def rle(indices):
+    out = bytearray()
+    literal = bytearray()
+    i = 0
+    n = len(indices)
+    while i < n:
+        run = 1
+        while i + run < n and run < 129 and indices[i+run] == indices[i]:
+            run += 1
+        if run >= 2:
+            if literal:
+                out.append(len(literal) - 1)
+                out += literal
+                literal = bytearray()
+            out.append(0x80 | (run - 2))
+            out.append(indices[i])
+            i += run
+        else:
+            literal.append(indices[i])
+            if len(literal) == 128:
+                out.append(127)
+                out += literal
+                literal = bytearray()
+            i += 1
+    if literal:
+        out.append(len(literal) - 1)
+        out += literal
+    return out
+
+
+def main(argv):
+    quantize = '--quantize' in argv
+    args = [a for a in argv[1:] if a != '--quantize']
+    if len(args) != 2:
+        sys.stderr.write('usage: imgpack.py [--quantize] image.(ppm|png) name\n')
+        return 1
+    path, name = args
+    data = open(path, 'rb').read()
+    w, h, pixels = read_png(data) if data[:4] == b'\x89PNG' else read_ppm(data)
+    palette, colors = make_palette(pixels, quantize)
+    lookup = dict((c, i) for i, c in enumerate(palette))
+    stream = rle([lookup[c] for c in colors])
+    packed = 2*len(palette) + len(stream)
+    sys.stderr.write('%s: %dx%d, %d colors, %d bytes raw, %d bytes packed, ratio %.2f:1\n'
+                     % (name, w, h, len(palette), 2*w*h, packed, 2.0*w*h/packed))
+
+    source = path.split('/')[-1]
+    guard = '%s_H' % name.upper()
+    with open(name + '.h', 'w') as out:
+        out.write('#ifndef %s\n#define %s\n\n' % (guard, guard))
+        out.write('// %s.h\n' % name)
+        out.write('// generated by tools/imgpack.py from %s, do not edit\n' % source)
+        out.write('// %dx%d pixels, %d colors, %d bytes (raw RGB565 would be %d bytes)\n\n'
+                  % (w, h, len(palette), packed, 2*w*h))
+        out.write('#include "LCD.h"\n\n')
+        out.write('extern const LCD_PackedImage %s;\n\n#endif\n' % name)
+    with open(name + '.c', 'w') as out:
+        out.write('// %s.c\n' % name)
+        out.write('// generated by tools/imgpack.py from %s, do not edit\n\n' % source)
+        out.write('#include <stdint.h>\n#include "%s.h"\n\n' % name)
+        out.write('static const uint16_t Palette[] = {\n')
+        for k in range(0, len(palette), 8):
+            out.write('  ' + ',  '.join('0x%04X' % c for c in palette[k:k+8]) + ',\n')
+        out.write('};\n\n')
+        out.write('static const uint8_t Data[] = {\n')
+        for k in range(0, len(stream), 12):
+            out.write('  ' + ', '.join('0x%02X' % b for b in stream[k:k+12]) + ',\n')
+        out.write('};\n\n')
+        out.write('const LCD_PackedImage %s = {\n  %d, %d, %d, Palette, %d, Data\n};\n'
+                  % (name, w, h, len(palette), len(stream)))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,140 @@
+// inputlag.c
+// Host model of the joystick input latency, from the ADC sample to the
+// crosshair drawn on the LCD, with RxFifo and with RxMail from FIFO.c.
+// The Producer puts a sample every 10 ms, the game loop runs a frame
+// every 20 ms the way frame() in Main.c does, and a loader like
+// INPUT_LOAD_MS holds LCDFree for a while every 100 ms:
+//   fifo  aim() drains RxFifo before taking LCDFree, a full RxFifo
+//         drops the newest samples
+//   mail  aim() reads the newest sample from RxMail after taking LCDFree
+// Times are in microseconds.  The target measures the same latency in
+// FrameLog[].latency and InputLatencyMax.
+//
+// build: gcc -std=gnu99 -O2 -I. -o inputlag tools/inputlag.c FIFO.c
+// usage: ./inputlag [-render us] [-seconds s]
+//   -render  sim + render time of one frame up to the crosshair, 3000 by default
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FIFO.h"
+
+#define SAMPLE_US   10000   // Producer period
+#define ADC_US      256     // 2*16 averaged conversions before the interrupt
+#define FRAME_US    20000   // FRAME_MS
+#define LOAD_US     100000  // the loader sleeps this long between holds
+#define LATENCY_MAX 100000  // latencies kept
+
+long StartCritical(void){ return 0; }
+void EndCritical(long sr){ (void)sr; }
+
+static uint32_t Latency[LATENCY_MAX];
+static int Latencies;
+static uint32_t NextSample, Dropped;
+static int Mailbox;
+
+// every sample the Producer interrupt puts up to time t
+static void produce(uint32_t t){
+  rxDataType data;
+  while(NextSample + ADC_US <= t){
+    data.x = data.y = 0;
+    data.time = NextSample;
+    if(Mailbox){
+      RxMail_Put(data);
+    }else if(RxFifo_Put(data) != RXFIFOSUCCESS){
+      Dropped++;
+    }
+    NextSample += SAMPLE_US;
+  }
+}
+
+// newest sample aim() takes at time t, 0 if none
+static uint32_t aim(uint32_t t){
+  static rxMailType mail;
+  rxDataType data;
+  uint32_t newest = 0;
+  produce(t);
+  if(Mailbox){
+    if(RxMail_Get(&mail)){
+      newest = mail.data.time + 1;
+    }
+  }else{
+    while(RxFifo_Size()){
+      RxFifo_Get(&data);
+      newest = data.time + 1;
+    }
+  }
+  return newest;
+}
+
+static int compare(const void *a, const void *b){
+  uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+  return (x > y) - (x < y);
+}
+
+static void run(uint32_t hold, uint32_t render, uint32_t seconds){
+  uint32_t due = FRAME_US, now, lock, newest, end = seconds*1000000u;
+  uint32_t loadAt = LOAD_US, released = 0;
+  double sum = 0;
+  int i;
+  Latencies = 0;
+  NextSample = 0;
+  Dropped = 0;
+  RxFifo_Init();
+  RxMail_Init();
+  while(due < end){
+    now = due;
+    newest = Mailbox ? 0 : aim(now);
+    // the loader takes LCDFree when it wakes up and the frame does not hold it
+    lock = now;
+    while(hold && (loadAt <= lock)){
+      uint32_t start = (loadAt > released) ? loadAt : released;
+      if(start + hold > lock){
+        lock = start + hold;
+      }
+      loadAt = start + hold + LOAD_US;
+    }
+    if(Mailbox){
+      newest = aim(lock);
+    }
+    now = lock + render;
+    released = now;
+    if(newest && (Latencies < LATENCY_MAX)){
+      Latency[Latencies++] = now - (newest - 1);
+    }
+    // waitFrame(): the next step, or catch up from now
+    due += FRAME_US;
+    if(due < now){
+      due = now;
+    }
+  }
+  qsort(Latency, Latencies, sizeof(uint32_t), compare);
+  for(i = 0; i < Latencies; i++){
+    sum += Latency[i];
+  }
+  printf("  %-4s %6d frames  latency mean %6.1f  p50 %6.1f  p99 %6.1f  max %6.1f ms  %u samples dropped\n",
+         Mailbox ? "mail" : "fifo", Latencies, sum/Latencies/1000, Latency[Latencies/2]/1000.0,
+         Latency[Latencies*99/100]/1000.0, Latency[Latencies - 1]/1000.0, Dropped);
+}
+
+int main(int argc, char **argv){
+  static const uint32_t hold[] = {0, 5000, 15000, 40000, 400000};
+  uint32_t render = 3000, seconds = 60;
+  unsigned i;
+  for(i = 1; i < (unsigned)argc; i++){
+    if(!strcmp(argv[i], "-render") && (i + 1 < (unsigned)argc)){
+      render = atoi(argv[++i]);
+    }else if(!strcmp(argv[i], "-seconds") && (i + 1 < (unsigned)argc)){
+      seconds = atoi(argv[++i]);
+    }
+  }
+  for(i = 0; i < sizeof(hold)/sizeof(hold[0]); i++){
+    printf("LCDFree held %u ms every %u ms, %u us to the crosshair\n", hold[i]/1000,
+           LOAD_US/1000, render);
+    for(Mailbox = 0; Mailbox < 2; Mailbox++){
+      run(hold[i], render, seconds);
+    }
+  }
+  return 0;
+}
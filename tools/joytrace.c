@@ -0,0 +1,302 @@
+// joytrace.c
+// Host test of the joystick pipeline in game.c: replay joystick traces
+// through Game_Joystick() and through the fixed-step integration
+// Producer() had before, and compare how far the crosshair moves, how
+// many samples it takes to start and to stop after the stick is pushed
+// and released, and how smooth the speed is.  The built-in traces also
+// check the pipeline:
+//   rest, offcenter  noise around the calibrated center never moves it
+//   push             starts within 1 sample, stops within 3, and a push
+//                    right then left by the same amount comes back
+//   ramp             more deflection is never slower
+// and every trace must keep the crosshair in the game area.
+//
+// A trace file has one Producer sample per line, "rawX rawY" from the
+// ADC (0 to 4095), # starts a comment, as in tools/sweeptrace.c.  A
+// "# center x y" line gives the stick at rest, 2048 2048 otherwise.
+//
+// build: gcc -std=gnu99 -O2 -DHOST_SIM -DCUBE_ENGINE=1 -I. -o joytrace tools/joytrace.c game.c cube.c board.c -lm
+// usage: ./joytrace [-v] [trace ...]   -v prints every sample of the new pipeline
+// Exit status 1 if a check fails.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "game.h"
+
+#define TRACE_MAX 20000     // samples in one trace
+#define RATE      100       // Producer samples per second
+
+static uint16_t RawX[TRACE_MAX], RawY[TRACE_MAX];
+static int32_t PathX[TRACE_MAX], PathY[TRACE_MAX];   // 1/32 pixels
+static int Samples;
+static uint16_t CenterX, CenterY;
+static int Verbose;
+
+typedef struct {
+  double distance;          // pixels moved
+  double jerk;              // mean change of speed between samples, pixels
+  int pushes;               // times the stick left the dead zone
+  int startLag, stopLag;    // samples to start and to stop, summed over the pushes
+  int maxStartLag, maxStopLag;
+  int outside;              // samples outside the game area
+} ResultType;
+
+//------------built-in traces------------
+static uint32_t Lfsr = 0xACE1u;
+
+static int noise(int amplitude){
+  Lfsr = (Lfsr >> 1) ^ (-(Lfsr & 1u) & 0xB400u);
+  return (int)(Lfsr % (2*amplitude + 1)) - amplitude;
+}
+
+static void add(int x, int y, int n){
+  while(n-- && (Samples < TRACE_MAX)){
+    RawX[Samples] = (x < 0) ? 0 : ((x > 4095) ? 4095 : x);
+    RawY[Samples] = (y < 0) ? 0 : ((y > 4095) ? 4095 : y);
+    Samples++;
+  }
+}
+
+// a stick at rest, ADC noise of +-200
+static void traceRest(void){
+  int i;
+  for(i = 0; i < 2000; i++){
+    add(2048 + noise(200), 2048 + noise(200), 1);
+  }
+}
+
+// a stick that rests away from 2048, calibrated at that point
+static void traceOffcenter(void){
+  int i;
+  CenterX = 1900;
+  CenterY = 2200;
+  for(i = 0; i < 2000; i++){
+    add(1900 + noise(150), 2200 + noise(150), 1);
+  }
+}
+
+// full and half pushes right, left, down and up with rests between
+static void tracePush(void){
+  static const int level[2] = {2047, 1024};
+  int i;
+  for(i = 0; i < 2; i++){
+    add(2048, 2048, 20);
+    add(2048 + level[i], 2048, 50); add(2048, 2048, 30);
+    add(2048 - level[i], 2048, 50); add(2048, 2048, 30);
+    add(2048, 2048 + level[i], 50); add(2048, 2048, 30);
+    add(2048, 2048 - level[i], 50); add(2048, 2048, 30);
+  }
+}
+
+// the stick pushed further right a little at a time
+static void traceRamp(void){
+  int i;
+  for(i = 0; i <= 2047; i += 4){
+    add(2048 + i, 2048, 1);
+  }
+}
+
+// random flicks, each held for a random time
+static void traceFlicks(void){
+  static const uint16_t level[3] = {0, 2048, 4095};
+  int i;
+  for(i = 0; i < 200; i++){
+    Lfsr = (Lfsr >> 1) ^ (-(Lfsr & 1u) & 0xB400u);
+    add(level[Lfsr % 3] + noise(100), level[(Lfsr >> 4) % 3] + noise(100), 10 + (Lfsr >> 8) % 90);
+  }
+}
+
+static int load(const char *name){
+  FILE *f = fopen(name, "r");
+  char line[80];
+  unsigned x, y;
+  if(!f){
+    perror(name);
+    return 0;
+  }
+  while(fgets(line, sizeof(line), f) && (Samples < TRACE_MAX)){
+    if(sscanf(line, "# center %u %u", &x, &y) == 2){
+      CenterX = x;
+      CenterY = y;
+    }else if((line[0] != '#') && (sscanf(line, "%u %u", &x, &y) == 2)){
+      add(x, y, 1);
+    }
+  }
+  fclose(f);
+  return 1;
+}
+
+//------------pipelines------------
+// the thresholds, step, clamps and scale Producer() had
+static void runOld(void){
+  int i, ox = 2048, oy = 2048;
+  for(i = 0; i < Samples; i++){
+    if(RawX[i] > 3000) ox += 6;
+    if(RawY[i] < 1800) oy += 6;
+    if(RawX[i] < 1400) ox -= 6;
+    if(RawY[i] > 3000) oy -= 6;
+    ox = (ox >= 4050) ? 4050 : ((ox <= 50) ? 50 : ox);
+    oy = (oy >= 3550) ? 3550 : ((oy <= 50) ? 50 : oy);
+    PathX[i] = ox*4096/4095;        // ADC units are 128/4095 pixels
+    PathY[i] = oy*4096/4095;
+  }
+}
+
+static void runNew(void){
+  int i;
+  int16_t x, y;
+  Game_Calibrate(CenterX, CenterY);
+  for(i = 0; i < Samples; i++){
+    Game_Joystick(RawX[i], RawY[i], &x, &y);
+    PathX[i] = origin[0];
+    PathY[i] = origin[1];
+    if(Verbose){
+      printf("  %4u %4u  %3d %3d  %4u %4u\n", RawX[i], RawY[i], x, y, origin[0], origin[1]);
+    }
+  }
+}
+
+//------------measure------------
+static int pushed(int i){
+  int dx = RawX[i] - CenterX, dy = RawY[i] - CenterY;
+  return dx*dx + dy*dy >= JOY_DEADZONE*JOY_DEADZONE;
+}
+
+static int moved(int i){
+  return (i > 0) && ((PathX[i] != PathX[i - 1]) || (PathY[i] != PathY[i - 1]));
+}
+
+// the crosshair has not moved for 3 samples from i on
+static int still(int i){
+  return (i + 3 >= Samples) || (!moved(i) && !moved(i + 1) && !moved(i + 2));
+}
+
+static void measure(ResultType *r){
+  int i, k, vx, vy, lastVx = 0, lastVy = 0;
+  memset(r, 0, sizeof(*r));
+  for(i = 1; i < Samples; i++){
+    vx = PathX[i] - PathX[i - 1];
+    vy = PathY[i] - PathY[i - 1];
+    r->distance += __builtin_sqrt(vx*vx + vy*vy)/32;
+    r->jerk += abs(vx - lastVx) + abs(vy - lastVy);
+    lastVx = vx;
+    lastVy = vy;
+    if(((PathX[i] >> 5) < 1) || ((PathX[i] >> 5) > 126) || ((PathY[i] >> 5) < 1) || ((PathY[i] >> 5) > 110)){
+      r->outside++;
+    }
+    if(pushed(i) && !pushed(i - 1)){
+      r->pushes++;
+      // a push into a screen edge cannot move, no lag to count
+      for(k = i; (k < Samples) && (k < i + RATE/2) && pushed(k) && !moved(k); k++){}
+      if((k < Samples) && (k < i + RATE/2) && pushed(k)){
+        r->startLag += k - i;
+        if(k - i > r->maxStartLag) r->maxStartLag = k - i;
+      }
+    }
+    if(!pushed(i) && pushed(i - 1)){
+      for(k = i; (k < Samples) && !pushed(k) && !still(k); k++){}
+      r->stopLag += k - i;
+      if(k - i > r->maxStopLag) r->maxStopLag = k - i;
+    }
+  }
+  r->jerk = r->jerk/32/(Samples ? Samples : 1);
+}
+
+static void print(const char *pipeline, const ResultType *r){
+  printf("  %-4s %7.0f px moved  %4d pushes  start %.2f (max %d)  stop %.2f (max %d) samples"
+         "  jerk %.3f px  %d outside\n", pipeline, r->distance, r->pushes,
+         r->pushes ? (double)r->startLag/r->pushes : 0, r->maxStartLag,
+         r->pushes ? (double)r->stopLag/r->pushes : 0, r->maxStopLag, r->jerk, r->outside);
+}
+
+//------------checks------------
+static int Failed;
+
+static void check(int ok, const char *name, const char *what){
+  if(!ok){
+    printf("  FAIL %s: %s\n", name, what);
+    Failed++;
+  }
+}
+
+static void checkTable(void){
+  int i;
+  for(i = 1; i < 32; i++){
+    check(JoyCurve[i] >= JoyCurve[i - 1], "JoyCurve", "speed falls with more deflection");
+  }
+  check(JoyCurve[0] == 0, "JoyCurve", "moves inside the dead zone");
+  check(JoyCurve[31] <= JOY_SPEED_MAX, "JoyCurve", "faster than JOY_SPEED_MAX");
+  printf("JoyCurve, 1/32 pixels per sample for each 64 ADC units:");
+  for(i = 0; i < 32; i++){
+    printf(" %u", JoyCurve[i]);
+  }
+  printf("\n");
+}
+
+static void run(const char *name, int builtin){
+  ResultType old, r;
+  int i, last;
+  printf("%s: %d samples (%.1f s), center %u,%u\n", name, Samples, (double)Samples/RATE, CenterX, CenterY);
+  runOld();
+  measure(&old);
+  print("old", &old);
+  runNew();
+  measure(&r);
+  print("new", &r);
+  check(r.outside == 0, name, "crosshair left the game area");
+  if(!builtin) return;
+  if(!strcmp(name, "rest") || !strcmp(name, "offcenter")){
+    check(r.distance == 0, name, "moved with the stick at rest");
+  }
+  if(!strcmp(name, "push")){
+    check(r.maxStartLag <= 1, name, "more than 1 sample to start");
+    check(r.maxStopLag <= 3, name, "more than 3 samples to stop");
+    // each push is followed by the opposite one, at rest in between
+    check((PathX[Samples - 1] == PathX[0]) && (PathY[Samples - 1] == PathY[0]), name,
+          "opposite pushes did not come back to the start");
+  }
+  if(!strcmp(name, "ramp")){
+    // the filter settles within a few samples of each small step,
+    // up to the right edge of the game area
+    for(i = 8, last = 0; (i < Samples) && (PathX[i] < 4050); i++){
+      check(PathX[i] - PathX[i - 1] >= last, name, "more deflection moved slower");
+      last = PathX[i] - PathX[i - 1];
+    }
+  }
+}
+
+int main(int argc, char **argv){
+  static const struct {
+    const char *name;
+    void (*make)(void);
+  } builtin[] = {
+    {"rest", traceRest}, {"offcenter", traceOffcenter}, {"push", tracePush},
+    {"ramp", traceRamp}, {"flicks", traceFlicks}
+  };
+  int i, files = 0;
+  checkTable();
+  for(i = 1; i < argc; i++){
+    if(!strcmp(argv[i], "-v")){
+      Verbose = 1;
+      continue;
+    }
+    files++;
+    Samples = 0;
+    CenterX = CenterY = 2048;
+    if(!load(argv[i])){
+      Failed++;
+      continue;
+    }
+    run(argv[i], 0);
+  }
+  for(i = 0; (files == 0) && (i < (int)(sizeof(builtin)/sizeof(builtin[0]))); i++){
+    Samples = 0;
+    CenterX = CenterY = 2048;
+    builtin[i].make();
+    run(builtin[i].name, 1);
+  }
+  printf("%d checks failed\n", Failed);
+  return Failed != 0;
+}
@@ -0,0 +1,264 @@
+// lcdbench.c
+// Host tool: run each LCD drawing primitive against the emulated panel
+// in ST7735Sim.c, print the SPI traffic it generates, and save or check
+// a snapshot of the screen after each step.
+//
+// build: gcc -std=gnu99 -O2 -DLCD_SIM -I. -o lcdbench tools/lcdbench.c LCD.c ST7735Sim.c
+// usage: ./lcdbench [-clock hz] [-save dir] [-check dir]
+//   -clock  SPI bit rate used for the bus time column, default 4000000
+//   -save   write dir/NN_name.ppm and dir/NN_name.png after each step
+//   -check  compare each step with dir/NN_name.ppm, exit 1 on any difference
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "LCD.h"
+#include "ST7735Sim.h"
+#include "bitmaps.h"
+
+#define BG 0x1AA6   // game background in Main.c
+
+static void fillScreen(void){ BSP_LCD_FillScreen(BG); }
+static void fillRect(void){ BSP_LCD_FillRect(10, 10, 40, 30, LCD_RED); }
+static void drawPixel(void){ BSP_LCD_DrawPixel(64, 64, LCD_WHITE); }
+static void hLine(void){ BSP_LCD_DrawFastHLine(0, 70, 128, LCD_YELLOW); }
+static void vLine(void){ BSP_LCD_DrawFastVLine(70, 0, 128, LCD_CYAN); }
+static void drawChar(void){ BSP_LCD_DrawChar(0, 120, 'A', LCD_WHITE, LCD_BLACK, 1); }
+static void drawString(void){ BSP_LCD_DrawString(0, 11, "Score:  1234", LCD_WHITE); }
+static void drawBitmap(void){ BSP_LCD_DrawBitmap(84, 100, bg1, 17, 17); }
+static void drawSprite(void){ BSP_LCD_DrawSprite(84, 80, bg1, 17, 17); }
+static void drawSpriteKey(void){ BSP_LCD_DrawSpriteKey(100, 80, bg1, 17, 17, bg1[0]); }
+static void moveSprite(void){ BSP_LCD_MoveSprite(84, 80, 87, 82, bg1, 17, 17, BG); }
+static void crosshair(void){ BSP_LCD_DrawCrosshair(30, 90, BG); }
+static uint16_t under(int16_t x, int16_t y){ (void)x; (void)y; return BG; }
+static void eraseCrosshair(void){ BSP_LCD_EraseCrosshair(30, 90, under); }
+static void plot(void){
+  int i;
+  BSP_LCD_Drawaxes(LCD_WHITE, LCD_BLACK, "t", "y", LCD_GREEN, "", 0, 100, 0);
+  for(i = 0; i < 100; i++){
+    BSP_LCD_PlotPoint(50 + (i%20) - 10, LCD_GREEN);
+    BSP_LCD_PlotIncrement();
+  }
+}
+
+static void clear(void){ BSP_LCD_FillScreen(LCD_BLACK); }
+static void lines(void){
+  BSP_LCD_DrawLine(0, 0, 127, 15, LCD_WHITE);     // shallow
+  BSP_LCD_DrawLine(0, 127, 127, 0, LCD_RED);      // 45 degrees
+  BSP_LCD_DrawLine(60, -10, 70, 140, LCD_GREEN);  // steep, clipped
+}
+static void circle(void){ BSP_LCD_DrawCircle(64, 64, 40, LCD_YELLOW); }
+static void fillCircle(void){ BSP_LCD_FillCircle(64, 64, 20, LCD_BLUE); }
+static void triangle(void){ BSP_LCD_FillTriangle(10, 100, 40, 70, 60, 120, LCD_MAGENTA); }
+static const int16_t StarX[10] = {100, 105, 120, 108, 112, 100, 88, 92, 80, 95};
+static const int16_t StarY[10] = { 80,  95,  95, 104, 120, 110, 120, 104, 95, 95};
+static void polygon(void){ BSP_LCD_FillPolygon(StarX, StarY, 10, LCD_CYAN); }
+static void strip(void){
+  int i;
+  BSP_LCD_StripInit(20, 100, 0, 100, LCD_BLACK);
+  for(i = 0; i < 150; i++){
+    BSP_LCD_StripPlot(50 + (i%20) - 10, LCD_GREEN);
+  }
+}
+static void logLines(void){
+  char line[22];
+  int i;
+  BSP_LCD_LogInit(2, 8, LCD_BLACK);
+  for(i = 0; i < 11; i++){
+    snprintf(line, sizeof(line), "log line %d", i);
+    BSP_LCD_LogLine(line, LCD_WHITE);
+  }
+}
+
+// 32x16 packed image: 12 rows of a run, a literal and a run, then one
+// run of 128 pixels across the last 4 rows, as tools/imgpack.py codes it
+static const uint16_t PackedPalette[3] = {LCD_RED, LCD_WHITE, LCD_BLUE};
+#define PACKED_ROW 0x88, 0, 0x03, 1, 2, 1, 2, 0x90, 2
+static const uint8_t PackedData[] = {
+  PACKED_ROW, PACKED_ROW, PACKED_ROW, PACKED_ROW, PACKED_ROW, PACKED_ROW,
+  PACKED_ROW, PACKED_ROW, PACKED_ROW, PACKED_ROW, PACKED_ROW, PACKED_ROW,
+  0xFE, 1
+};
+static const LCD_PackedImage Packed = {32, 16, 3, PackedPalette, sizeof(PackedData), PackedData};
+static void packed(void){ BSP_LCD_DrawPacked(90, 20, &Packed); }
+static void packedClip(void){ BSP_LCD_DrawPacked(-5, 120, &Packed); }
+
+// the pixel of Packed at column i, row j
+static uint16_t packedPixel(int i, int j){
+  static const uint8_t middle[4] = {1, 2, 1, 2};
+  if(j >= 12) return LCD_WHITE;
+  if(i < 10) return LCD_RED;
+  if(i < 14) return PackedPalette[middle[i - 10]];
+  return LCD_BLUE;
+}
+
+// BSP_LCD_DrawPacked() whole and clipped: every pixel on the glass, and
+// the pixel rate with the SPI bus as the only limit
+static int packedCheck(void){
+  int i, j, ok = 1;
+  uint32_t us;
+  BSP_LCD_FillScreen(LCD_BLACK);
+  ST7735Sim_ClearStats();
+  BSP_LCD_DrawPacked(10, 10, &Packed);
+  us = ST7735Sim_BusTime();
+  BSP_LCD_DrawPacked(-5, 120, &Packed);
+  for(j = 0; j < 16; j++){
+    for(i = 0; i < 32; i++){
+      ok = ok && (ST7735Sim_GetPixel(10 + i, 10 + j) == packedPixel(i, j));
+      if((i >= 5) && (j < 8)){
+        ok = ok && (ST7735Sim_GetPixel(i - 5, 120 + j) == packedPixel(i, j));
+      }
+    }
+  }
+  ok = ok && (ST7735Sim_GetPixel(27, 120) == LCD_BLACK) && (ST7735Sim_GetPixel(42, 10) == LCD_BLACK);
+  printf("packed: %u bytes for %u pixels, %u us, %.0f pixels/ms, %s\n",
+         (unsigned)sizeof(PackedData), 32*16, us, 1000.0*32*16/us, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+#define SAMPLES 1000
+static void rate(const char *name){
+  SimStatsType s;
+  ST7735Sim_Stats(&s);
+  printf("%-12s %5u bytes/sample %8.0f samples/s\n", name,
+         (s.commands + s.data)/SAMPLES, 1e6*SAMPLES/ST7735Sim_BusTime());
+}
+
+// check one recorded command against the expected code and arguments
+static int expect(uint32_t i, uint8_t command, uint32_t count, const uint8_t *args){
+  const SimTraceType *t = ST7735Sim_TraceGet(i);
+  uint32_t k;
+  if((t == NULL) || (t->command != command) || (t->count != count)) return 0;
+  for(k = 0; (k < count) && (k < SIM_TRACE_ARGS); k++){
+    if(t->args[k] != args[k]) return 0;
+  }
+  return 1;
+}
+
+// frame rate and partial mode: exact command sequence and the effect
+// on the emulated glass
+static int timing(void){
+  static const uint8_t ptlar[4] = {0x00, 0x03, 0x00, 0x78};  // rows 0-117 plus RowStart
+  const SimTraceType *t;
+  uint8_t frame[6];
+  uint32_t rate;
+  int ok = 1;
+  int k;
+  BSP_LCD_SetScrollArea(0, 128);
+  BSP_LCD_FillScreen(LCD_WHITE);
+  ST7735Sim_TraceClear();
+  rate = BSP_LCD_SetFrameRate(90);
+  BSP_LCD_SetPartialArea(0, 118);
+  t = ST7735Sim_TraceGet(0);
+  if(t == NULL) return 0;
+  for(k = 0; k < 6; k++){
+    frame[k] = t->args[k%3];       // FRMCTR3 repeats the FRMCTR1 values
+  }
+  ok = ok && expect(0, 0xB1, 3, frame);
+  ok = ok && expect(1, 0xB3, 6, frame);
+  ok = ok && expect(2, 0x30, 4, ptlar);
+  ok = ok && expect(3, 0x12, 0, NULL);
+  ok = ok && (ST7735Sim_TraceCount() == 4);
+  ok = ok && (ST7735Sim_FrameRate() == rate);
+  ok = ok && (ST7735Sim_GetPixel(0, 117) == LCD_WHITE) && (ST7735Sim_GetPixel(0, 118) == 0);
+  printf("timing: SetFrameRate(90) gave %u.%u Hz, partial rows 0-117, %s\n",
+         rate/10, rate%10, ok ? "ok" : "FAIL");
+  BSP_LCD_NormalMode();
+  ok = ok && expect(4, 0x13, 0, NULL) && (ST7735Sim_GetPixel(0, 118) == LCD_WHITE);
+  for(k = 20; k <= 120; k += 20){
+    rate = BSP_LCD_SetFrameRate(k);
+    ok = ok && (ST7735Sim_FrameRate() == rate);
+    printf("  SetFrameRate(%3d) -> %u.%u Hz\n", k, rate/10, rate%10);
+  }
+  rate = BSP_LCD_SetFrameRate(60);
+  printf("timing sequence %s\n", ok ? "ok" : "FAIL");
+  return ok;
+}
+
+typedef struct {
+  const char *name;
+  void (*draw)(void);
+} StepType;
+
+static const StepType Steps[] = {
+  {"fillscreen", fillScreen},     {"fillrect", fillRect},
+  {"pixel", drawPixel},           {"hline", hLine},
+  {"vline", vLine},               {"char", drawChar},
+  {"string", drawString},         {"bitmap", drawBitmap},
+  {"sprite", drawSprite},         {"spritekey", drawSpriteKey},
+  {"movesprite", moveSprite},     {"crosshair", crosshair},
+  {"erasecross", eraseCrosshair}, {"plot100", plot},
+  {"clear", clear},               {"lines", lines},
+  {"circle", circle},             {"fillcircle", fillCircle},
+  {"triangle", triangle},         {"polygon", polygon},
+  {"strip150", strip},            {"log11", logLines},
+  {"packed", packed},             {"packedclip", packedClip},
+};
+
+int main(int argc, char **argv){
+  const char *save = NULL, *check = NULL;
+  char path[256];
+  SimStatsType s;
+  int failed = 0;
+  int i;
+  for(i = 1; i + 1 < argc; i += 2){
+    if(strcmp(argv[i], "-clock") == 0) ST7735Sim_SetClock(strtoul(argv[i+1], NULL, 0));
+    else if(strcmp(argv[i], "-save") == 0) save = argv[i+1];
+    else if(strcmp(argv[i], "-check") == 0) check = argv[i+1];
+  }
+  BSP_LCD_Init();
+  ST7735Sim_Stats(&s);
+  // "perpixel" is what the same pixels would cost with BSP_LCD_DrawPixel()
+  printf("%-12s %8s %8s %8s %8s %10s %9s\n", "step", "cmds", "data", "pixels", "windows", "bus us", "perpixel");
+  printf("%-12s %8u %8u %8u %8u %10u  (+%u ms delays)\n", "init", s.commands, s.data,
+         s.pixels, s.windows, ST7735Sim_BusTime(), s.delayms);
+  for(i = 0; i < (int)(sizeof(Steps)/sizeof(Steps[0])); i++){
+    ST7735Sim_ClearStats();
+    Steps[i].draw();
+    ST7735Sim_Stats(&s);
+    printf("%-12s %8u %8u %8u %8u %10u %9u", Steps[i].name, s.commands, s.data,
+           s.pixels, s.windows, ST7735Sim_BusTime(), 13*s.pixels);
+    if(save){
+      snprintf(path, sizeof(path), "%s/%02d_%s.ppm", save, i, Steps[i].name);
+      ST7735Sim_SavePPM(path);
+      snprintf(path, sizeof(path), "%s/%02d_%s.png", save, i, Steps[i].name);
+      ST7735Sim_SavePNG(path);
+    }
+    if(check){
+      int32_t diff;
+      snprintf(path, sizeof(path), "%s/%02d_%s.ppm", check, i, Steps[i].name);
+      diff = ST7735Sim_Compare(path);
+      if(diff){
+        failed = 1;
+        printf("  FAIL %d", diff);
+      }else{
+        printf("  ok");
+      }
+    }
+    printf("\n");
+  }
+
+  // sustained sample rate with the SPI bus as the only limit
+  BSP_LCD_Drawaxes(LCD_WHITE, LCD_BLACK, "t", "y", LCD_GREEN, "", 0, 100, 0);
+  ST7735Sim_ClearStats();
+  for(i = 0; i < SAMPLES; i++){
+    BSP_LCD_PlotPoint(i%100, LCD_GREEN);
+    BSP_LCD_PlotIncrement();
+  }
+  rate("sweep plot");
+  BSP_LCD_StripInit(0, 128, 0, 100, LCD_BLACK);
+  ST7735Sim_ClearStats();
+  for(i = 0; i < SAMPLES; i++){
+    BSP_LCD_StripPlot(i%100, LCD_GREEN);
+  }
+  rate("strip chart");
+  BSP_LCD_SetScrollArea(0, 128);
+  if(!timing()){
+    failed = 1;
+  }
+  if(!packedCheck()){
+    failed = 1;
+  }
+  return failed;
+}
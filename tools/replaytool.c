@@ -0,0 +1,172 @@
+// replaytool.c
+// Host tool for the game recordings of replay.c: list one, check that
+// it decodes and encodes back to the same bytes, or turn a joystick
+// trace (the tools/sweeptrace.c format) into a recording that the
+// target can play with REPLAY_MODE REPLAY_PLAY.
+//
+// build: gcc -std=gnu99 -O2 -DHOST_SIM -DCUBE_ENGINE=1 -I. -o replaytool tools/replaytool.c replay.c game.c cube.c board.c
+// usage: ./replaytool [-v] recording         list games, frames and samples (-v every record)
+//        ./replaytool -make trace recording  2 Producer samples per frame, seed 0xABCDEFAB/1
+// A recording is the raw UART0 byte stream, e.g. captured with
+//   stty -F /dev/ttyACM0 115200 raw && cat /dev/ttyACM0 > game.rec
+// Exit status 1 if a recording does not decode or does not encode back
+// to the same bytes.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "game.h"
+#include "replay.h"
+
+#define STREAM_MAX (1 << 20)
+
+static uint8_t In[STREAM_MAX], Out[STREAM_MAX];
+
+static uint32_t readFile(const char *name, uint8_t *buffer){
+  FILE *f = fopen(name, "rb");
+  uint32_t size;
+  if(!f){
+    perror(name);
+    exit(1);
+  }
+  size = fread(buffer, 1, STREAM_MAX, f);
+  if((size == STREAM_MAX) && (fgetc(f) != EOF)){
+    fprintf(stderr, "%s: longer than %u bytes\n", name, STREAM_MAX);
+    exit(1);
+  }
+  fclose(f);
+  return size;
+}
+
+// decode the whole stream, print it, and encode it again into Out[]
+static int list(const char *name, int verbose){
+  ReplayEventType e;
+  uint32_t size = readFile(name, In);
+  uint32_t games = 0, frames = 0, samples = 0, steps = 0, buttons = 0;
+  uint32_t pos, encoded;
+  int fail = 0;
+  // the decoder and the encoder each keep their own state, so run the
+  // encoder over the whole stream after decoding it; a run of the same
+  // sample is kept once with its count, so there is at most one event
+  // per byte of the stream
+  static ReplayEventType events[STREAM_MAX];
+  static uint32_t counts[STREAM_MAX];
+  uint32_t n = 0, i, k;
+  Replay_Init(REPLAY_PLAY, In, size);
+  while(1){
+    pos = Replay_Used();
+    if(pos >= size) break;
+    if(Replay_Read(&e) == REPLAY_ERROR){
+      printf("%s: bad record 0x%02X at byte %u\n", name, In[pos], pos);
+      return 1;
+    }
+    if((e.type == REPLAY_SAMPLE) && n && (events[n - 1].type == REPLAY_SAMPLE) &&
+       (events[n - 1].x == e.x) && (events[n - 1].y == e.y)){
+      counts[n - 1]++;
+      continue;
+    }
+    if(n == STREAM_MAX){
+      printf("%s: more than %u records\n", name, STREAM_MAX);
+      return 1;
+    }
+    events[n] = e;
+    counts[n++] = 1;
+  }
+  Replay_Init(REPLAY_RECORD, Out, STREAM_MAX);
+  for(i = 0; i < n; i++){
+    e = events[i];
+    switch(e.type){
+      case REPLAY_BEGIN:
+        games++;
+        printf("game %u: seed %08X %08X  type %u  mode %u  crosshair %u,%u\n", games,
+               e.session.lfsr32, e.session.lfsr31, e.session.gameType,
+               e.session.gameMode, e.session.x, e.session.y);
+        Replay_Begin(&e.session);
+        break;
+      case REPLAY_SAMPLE:
+        for(k = 0; k < counts[i]; k++){
+          samples++;
+          if(verbose) printf("  %4u,%4u\n", e.x, e.y);
+          Replay_Sample(e.x, e.y);
+        }
+        break;
+      case REPLAY_BUTTON:
+        buttons++;
+        if(verbose) printf("  SW%u\n", e.value);
+        Replay_Press(e.value);
+        break;
+      case REPLAY_FRAME:
+        frames++;
+        steps += e.value;
+        if(verbose) printf("  frame %u, %u steps\n", frames, e.value);
+        Replay_Frame(e.value);
+        break;
+      case REPLAY_END:
+        printf("  end: score %u  %u frames  %u steps (%.1f s)  %u samples  %u buttons\n",
+               e.value, frames, steps, steps*0.02, samples, buttons);
+        Replay_End(e.value);
+        frames = samples = steps = buttons = 0;
+        break;
+    }
+  }
+  encoded = Replay_Used();
+  if((encoded != size) || memcmp(In, Out, size)){
+    printf("%s: encodes back to %u bytes, not the same %u\n", name, encoded, size);
+    fail = 1;
+  }
+  printf("%s: %u games in %u bytes\n", name, games, size);
+  return fail;
+}
+
+// Game_Joystick() of a raw ADC trace as Producer() runs it, 2 samples
+// per 1-step frame
+static int make(const char *traceName, const char *name){
+  ReplaySessionType s = {0xABCDEFAB, 1, 0, 0, 63, 63};
+  FILE *f = fopen(traceName, "r");
+  char line[80];
+  unsigned rx, ry;
+  int16_t x, y;
+  int n = 0;
+  if(!f){
+    perror(traceName);
+    return 1;
+  }
+  Replay_Init(REPLAY_RECORD, Out, STREAM_MAX);
+  Replay_Begin(&s);
+  Game_Calibrate(2048, 2048);
+  while(fgets(line, sizeof(line), f)){
+    if((line[0] == '#') || (sscanf(line, "%u %u", &rx, &ry) != 2)) continue;
+    Game_Joystick(rx, ry, &x, &y);
+    Replay_Sample(x, y);
+    if(++n % 2 == 0){
+      Replay_Frame(1);
+    }
+  }
+  fclose(f);
+  Replay_Frame(1);
+  Replay_End(0);                    // unknown, the replayed game reports it
+  f = fopen(name, "wb");
+  if(!f){
+    perror(name);
+    return 1;
+  }
+  fwrite(Out, 1, Replay_Used(), f);
+  fclose(f);
+  printf("%s: %d samples in %u bytes\n", name, n, Replay_Used());
+  return 0;
+}
+
+int main(int argc, char **argv){
+  if((argc == 4) && !strcmp(argv[1], "-make")){
+    return make(argv[2], argv[3]);
+  }
+  if((argc == 3) && !strcmp(argv[1], "-v")){
+    return list(argv[2], 1);
+  }
+  if(argc == 2){
+    return list(argv[1], 0);
+  }
+  fprintf(stderr, "usage: %s [-v] recording | -make trace recording\n", argv[0]);
+  return 1;
+}
@@ -0,0 +1,221 @@
+// ringtest.c
+// Host stress test and throughput benchmark of AddRingFifo in FIFO.h.
+// Stress: a producer thread and a consumer thread move a counting
+// sequence through one ring, each side picking Put, PutN or
+// Reserve/Commit (Get, GetN or Peek/Skip) at random, and the consumer
+// checks every element arrives once and in order.  Benchmark: elements
+// per second through the ring with single and bulk calls, on one
+// thread and across two, next to the AddIndexFifo and AddPointerFifo
+// macros it replaces.
+//
+// build: gcc -std=gnu99 -O2 -pthread -I. -o ringtest tools/ringtest.c
+// usage: ./ringtest [-n elements]
+// Exit status 1 if an element is lost, repeated or out of order.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include "FIFO.h"
+
+long StartCritical(void){ return 0; }
+void EndCritical(long sr){ (void)sr; }
+
+#define SIZE  64
+#define BATCH 16            // elements per PutN/GetN in the benchmark
+
+AddRingFifo(Stress, SIZE, uint32_t, 1, 0)
+AddRingFifo(Bench, SIZE, uint32_t, 1, 0)
+AddIndexFifo(Index, SIZE, uint32_t, 1, 0)
+AddPointerFifo(Pointer, SIZE, uint32_t, 1, 0)
+
+static uint32_t Elements = 20000000;
+static volatile int Errors;
+
+static double now(void){
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec*1e-9;
+}
+
+static uint32_t next(uint32_t *lfsr){
+  *lfsr ^= *lfsr << 13;
+  *lfsr ^= *lfsr >> 17;
+  *lfsr ^= *lfsr << 5;
+  return *lfsr;
+}
+
+//------------stress------------
+static void *stressProducer(void *arg){
+  uint32_t lfsr = 0x12345678, v = 0, buffer[SIZE], n, i, *span;
+  (void)arg;
+  while(v < Elements){
+    if(StressFifo_Size() == SIZE){
+      sched_yield();          // full, let the consumer run on a single core
+    }
+    switch(next(&lfsr) % 3){
+      case 0:
+        if(StressFifo_Put(v)) v++;
+        break;
+      case 1:
+        n = 1 + next(&lfsr) % SIZE;
+        if(n > Elements - v) n = Elements - v;
+        for(i = 0; i < n; i++) buffer[i] = v + i;
+        v += StressFifo_PutN(buffer, n);
+        break;
+      default:
+        span = StressFifo_Reserve(&n);
+        if(n > Elements - v) n = Elements - v;
+        for(i = 0; i < n; i++) span[i] = v + i;
+        StressFifo_Commit(n);
+        v += n;
+        break;
+    }
+  }
+  return 0;
+}
+
+static void *stressConsumer(void *arg){
+  uint32_t lfsr = 0x87654321, v = 0, buffer[SIZE], n, i, *span;
+  (void)arg;
+  while(v < Elements){
+    switch(next(&lfsr) % 3){
+      case 0:
+        if(StressFifo_Get(buffer)){
+          n = 1;
+        }else{
+          n = 0;
+        }
+        break;
+      case 1:
+        n = StressFifo_GetN(buffer, 1 + next(&lfsr) % SIZE);
+        break;
+      default:
+        span = StressFifo_Peek(&n);
+        if(n){
+          n = 1 + next(&lfsr) % n;
+          memcpy(buffer, span, n*sizeof(uint32_t));
+          StressFifo_Skip(n);
+        }
+        break;
+    }
+    if(n == 0){
+      sched_yield();          // empty, let the producer run
+    }
+    for(i = 0; i < n; i++, v++){
+      if(buffer[i] != v){
+        if(Errors++ < 10){
+          printf("  element %u arrived as %u\n", v, buffer[i]);
+        }
+        v = buffer[i];
+      }
+    }
+    if(StressFifo_Size() > SIZE){
+      Errors++;
+    }
+  }
+  return 0;
+}
+
+static void stress(void){
+  pthread_t p, c;
+  double t = now();
+  StressFifo_Init();
+  pthread_create(&c, 0, stressConsumer, 0);
+  pthread_create(&p, 0, stressProducer, 0);
+  pthread_join(p, 0);
+  pthread_join(c, 0);
+  printf("stress: %u elements through a %d element ring in %.2f s, %d errors\n",
+         Elements, SIZE, now() - t, Errors);
+}
+
+//------------benchmark------------
+// fill with SIZE/2 then empty, one thread
+#define ONE_THREAD(NAME, PUT, GET) \
+static double NAME(void){ \
+  uint32_t i, k, v = 0, sum = 0; \
+  double t = now(); \
+  for(i = 0; i < Elements; i += SIZE/2){ \
+    for(k = 0; k < SIZE/2; k++) PUT(v++); \
+    for(k = 0; k < SIZE/2; k++){ uint32_t d = 0; GET(&d); sum += d; } \
+  } \
+  if(sum == 1) printf(" "); \
+  return Elements/(now() - t); \
+}
+ONE_THREAD(benchIndex, IndexFifo_Put, IndexFifo_Get)
+ONE_THREAD(benchPointer, PointerFifo_Put, PointerFifo_Get)
+ONE_THREAD(benchRing, BenchFifo_Put, BenchFifo_Get)
+
+static double benchRingN(void){
+  uint32_t i, k, v = 0, sum = 0, buffer[BATCH];
+  double t = now();
+  for(i = 0; i < Elements; i += SIZE/2){
+    for(k = 0; k < SIZE/2; k += BATCH){
+      buffer[0] = v;
+      v += BATCH;
+      BenchFifo_PutN(buffer, BATCH);
+    }
+    for(k = 0; k < SIZE/2; k += BATCH){
+      BenchFifo_GetN(buffer, BATCH);
+      sum += buffer[0];
+    }
+  }
+  if(sum == 1) printf(" ");
+  return Elements/(now() - t);
+}
+
+// producer and consumer threads, single or bulk calls
+static int Bulk;
+
+static void *benchProducer(void *arg){
+  uint32_t v = 0, n, buffer[BATCH] = {0};
+  (void)arg;
+  while(v < Elements){
+    if(Bulk){
+      n = BenchFifo_PutN(buffer, BATCH);
+    }else{
+      n = BenchFifo_Put(v);
+    }
+    if(n == 0) sched_yield();
+    v += n;
+  }
+  return 0;
+}
+
+static double twoThreads(int bulk){
+  pthread_t p;
+  uint32_t v = 0, n, d, buffer[BATCH];
+  double t = now();
+  Bulk = bulk;
+  BenchFifo_Init();
+  pthread_create(&p, 0, benchProducer, 0);
+  while(v < Elements){
+    if(bulk){
+      n = BenchFifo_GetN(buffer, BATCH);
+    }else{
+      n = BenchFifo_Get(&d);
+    }
+    if(n == 0) sched_yield();
+    v += n;
+  }
+  pthread_join(p, 0);
+  return Elements/(now() - t);
+}
+
+int main(int argc, char **argv){
+  if((argc == 3) && !strcmp(argv[1], "-n")){
+    Elements = strtoul(argv[2], 0, 0);
+  }
+  stress();
+  IndexFifo_Init();
+  PointerFifo_Init();
+  BenchFifo_Init();
+  printf("one thread, M elements/s:  AddIndexFifo %.0f  AddPointerFifo %.0f  AddRingFifo %.0f  PutN/GetN %.0f\n",
+         benchIndex()*1e-6, benchPointer()*1e-6, benchRing()*1e-6, benchRingN()*1e-6);
+  printf("two threads, M elements/s: Put/Get %.0f  PutN/GetN %.0f\n",
+         twoThreads(0)*1e-6, twoThreads(1)*1e-6);
+  return Errors != 0;
+}
@@ -0,0 +1,304 @@
+// shelltest.c
+// Host test of the UART0 command shell, shell.c as it is, over a
+// pseudo terminal: a child process runs Shell_Input() on the bytes of
+// the pty master, as the Shell thread in Main.c does with UART_Read(),
+// and the test types at the slave like a terminal would.  The kernel,
+// LCD and queue counters the commands read are made up here and move
+// with OS_MsTime(), which steps 1 s a call, so every number the
+// commands print is known: CPU % of threads that run 10, 20 and 30 %
+// of the time, a thread that comes back with the same id, LCD rates,
+// semaphore waiters, queue losses, the game, the sound mixer.  Then the parser: echo,
+// backspace, Ctrl-C, CR LF, empty lines, unknown commands, too many
+// words or arguments, a line longer than SHELL_LINE, binary garbage.
+// UART_Write() takes at most 48 bytes a call, so every long reply
+// waits for Tx_UARTFifo like it does on the board.
+//
+// -pty serves the same shell on a pty until killed and prints its
+// name, to try it with screen or minicom.
+//
+// build: gcc -std=gnu99 -O2 -I. -o shelltest tools/shelltest.c shell.c UART_FIFO.c
+// usage: ./shelltest [-pty]
+// Exit status 1 if the test fails.
+
+#define _GNU_SOURCE
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "os.h"
+#include "UART.h"
+#include "UART_FIFO.h"
+#include "FIFO.h"
+#include "LCD.h"
+#include "joystick.h"
+#include "log.h"
+#include "telemetry.h"
+#include "sound.h"
+#include "wave.h"
+#include "shell.h"
+
+//------------host build of shell.c------------
+#define WRITE_MAX 48          // bytes UART_Write() takes at once, Tx_UARTFifo filling up
+static int Fd;                // pty master, the shell's UART0
+static uint32_t Ms;           // OS_MsTime(), 1 s more every call
+static uint32_t ThreadCalls;  // OS_Threads() calls
+static uint32_t Sleeps;       // OS_Sleep() calls, UART_Write() took part of a reply
+
+Sema4Type LCDFree, CubeCnt;
+uint32_t BSP_LCD_Bytes, BSP_LCD_Fills;
+JoystickStatsType JoystickStats;
+LogStatsType LogStats;
+TeleStatsType TeleStats;
+UARTStatsType UARTStats;
+SoundStatsType SoundStats;
+WaveStatsType WaveStats;
+
+long StartCritical(void){ return 0; }
+void EndCritical(long sr){ (void)sr; }
+void OS_Sleep(unsigned long sleepTime){ (void)sleepTime; Sleeps++; }
+unsigned long OS_MsTime(void){
+  Ms += 1000;
+  BSP_LCD_Bytes = 25*Ms;      // 25000 bytes/s, 5 % of the LCD bus
+  BSP_LCD_Fills = Ms/25;      // 40 fills/s
+  return Ms;
+}
+uint32_t RxFifo_Size(void){ return 3; }
+int Sound_Busy(void){ return 1; }
+uint32_t Wave_Busy(void){ return 2; }
+
+uint32_t UART_Write(const char *pt, uint32_t n){
+  ssize_t k = write(Fd, pt, n < WRITE_MAX ? n : WRITE_MAX);
+  return k > 0 ? k : 0;
+}
+
+// threads 0 to 3 run 0, 10, 20 and 30 % of the time; from the third
+// call on thread 3 is a new thread with the same id
+uint32_t OS_Threads(OSThreadType *list, uint32_t max){
+  uint32_t i, n = max < 4 ? max : 4;
+  ThreadCalls++;
+  for(i = 0; i < n; i++){
+    list[i].id = i;
+    list[i].state = i == 0 ? OS_RUNNING : OS_READY + (i - 1)%3;
+    list[i].priority = i + 1;
+    list[i].cell = i == 2 ? 17 : 0xFF;
+    list[i].sleepMs = 0;
+    list[i].arriveMs = (i == 3) && (ThreadCalls >= 3) ? 5 : 0;
+    list[i].cycles = (Ms/100)*10*i*TIME_1MS;
+    list[i].stackUsed = 30 + i;
+    list[i].stackSize = 100;
+  }
+  return n;
+}
+
+static void snapshot(TeleGameType *g){
+  g->ms = 0;
+  g->state = 1;
+  g->gameType = 1;
+  g->gameMode = 2;
+  g->score = 17;
+  g->highScore = 40;
+  g->rounds = 3;
+  g->cubes = 4;
+}
+
+// the Shell thread of Main.c on the pty master
+static void serve(void){
+  char in[16];
+  ssize_t i, n;
+  LCDFree.Value = 0;
+  LCDFree.waitingCount = 2;
+  LCDFree.waitingThreads[0] = 1;
+  LCDFree.waitingThreads[1] = 3;
+  LCDFree.waits = 7;
+  CubeCnt.Value = 1;
+  TeleStats.dropped = 3;
+  UARTStats.rxDropped = 5;
+  LogStats.maxUsed = 100;
+  LogStats.lost = 2;
+  JoystickStats.samples = 1234;
+  SoundStats.notes = 12;
+  SoundStats.ticks = 1150;
+  WaveStats.blocks = 250;
+  WaveStats.underruns = 1;
+  WaveStats.mixCycles = 2936;   // 0.9 % at 16 kHz
+  WaveStats.mixMax = 3100;
+  Tx_UARTFifo_Init();
+  Rx_UARTFifo_Init();
+  Shell_Init(&snapshot);
+  while((n = read(Fd, in, sizeof(in))) > 0){
+    for(i = 0; i < n; i++){
+      Shell_Input(in[i]);
+    }
+  }
+  fprintf(stderr, "shell: %u replies waited for UART_Write()\n", Sleeps);
+  exit(0);
+}
+
+//------------test------------
+static int Term;              // pty slave, the terminal
+static int Failed;
+static char Reply[16384];
+
+// type the bytes, read what comes back up to the last prompt: up to a
+// prompt, then until nothing more comes for 50 ms
+static const char *type(const char *in, size_t n){
+  struct pollfd p = { Term, POLLIN, 0 };
+  size_t got = 0;
+  ssize_t k;
+  if(write(Term, in, n) != (ssize_t)n){
+    perror("write");
+  }
+  Reply[0] = 0;
+  while(got < sizeof(Reply) - 1){
+    if((poll(&p, 1, (got >= 4) && !strcmp(&Reply[got - 4], "\r\n> ") ? 50 : 2000) <= 0) ||
+       ((k = read(Term, &Reply[got], sizeof(Reply) - 1 - got)) <= 0)){
+      break;
+    }
+    got += k;
+    Reply[got] = 0;
+  }
+  Reply[got] = 0;
+  return Reply;
+}
+
+static void expect(int ok, const char *what, const char *reply){
+  if(!ok){
+    printf("  FAIL %s, reply:\n%s\n", what, reply);
+    Failed++;
+  }
+}
+
+#define TYPE(s) type(s, sizeof(s) - 1)
+static int has(const char *reply, const char *s){ return strstr(reply, s) != 0; }
+
+static int prompts(const char *reply){
+  int n = 0;
+  while((reply = strstr(reply, "> "))){
+    n++;
+    reply += 2;
+  }
+  return n;
+}
+
+static void commands(void){
+  const char *r;
+  r = TYPE("help\r");
+  expect(!strncmp(r, "help\r\n", 6), "no echo", r);
+  expect(has(r, "ps ") && has(r, "sem ") && has(r, "lcd ") && has(r, "fifo ") && has(r, "game ") &&
+         has(r, "snd "),
+         "help misses a command", r);
+  r = TYPE("ps\r");
+  expect(has(r, "  0 running    1    -      -    30/100\r\n") &&
+         has(r, "  2 sleeping   3   17      -    32/100\r\n") && !has(r, "% over"),
+         "first ps", r);
+  r = TYPE("ps\r");
+  printf("%s\n", r);
+  expect(has(r, "  0 running    1    -    0.0    30/100\r\n") && has(r, "   10.0 ") &&
+         has(r, "   20.0 ") && has(r, "  3 waiting    4    -   30.0    33/100\r\n") &&
+         has(r, "threads 4, cpu 60.0% over 1000 ms"), "CPU %", r);
+  r = TYPE("ps\r");
+  expect(has(r, "  3 waiting    4    -      -    33/100\r\n") && has(r, "   10.0 ") &&
+         has(r, "cpu 30.0%"), "a new thread with the same id", r);
+  r = TYPE("sem\r");
+  printf("%s\n", r);
+  expect(has(r, "LCDFree       0       2       7  1 3\r\n") && has(r, "CubeCnt       1       0       0"),
+         "sem", r);
+  r = TYPE("lcd\r");
+  expect(has(r, "none yet"), "first lcd", r);
+  TYPE("ps\r");                       // 1 s on
+  r = TYPE("lcd\r");
+  printf("%s\n", r);
+  expect(has(r, "25000 bytes/s, 40 fills/s, bus 5.0% busy over 2000 ms"), "lcd rates", r);
+  r = TYPE("fifo\r");
+  printf("%s\n", r);
+  expect(has(r, "uart0 tx        0    512     3") && has(r, "uart0 rx        0    256     5") &&
+         has(r, "log ring      100    512     2") && has(r, "joystick        3     32     -  1234 samples"),
+         "fifo", r);
+  r = TYPE("game\r");
+  printf("%s\n", r);
+  expect(has(r, "page game, type 1, mode 2, score 17, high 40, rounds 3, cubes 4\r\n"), "game", r);
+  r = TYPE("snd\r");
+  printf("%s\n", r);
+  expect(has(r, "notes 12, dropped 0, ticks 1150, playing\r\n") &&
+         has(r, "mixer 16000 Hz, voices 2/4, blocks 250, underruns 1, clipped 0, dropped 0\r\n") &&
+         has(r, "mix 2936 cycles a block, most 3100, cpu 0.9%\r\n"), "snd", r);
+}
+
+static void parser(void){
+  static char longLine[300 + 2];
+  const char *r;
+  r = TYPE("foo\r");
+  expect(has(r, "foo: unknown command"), "unknown command", r);
+  r = TYPE("ps now\r");
+  expect(has(r, "ps: too many arguments") && !has(r, "stack"), "too many arguments", r);
+  r = TYPE("  a   b c  d\r");
+  expect(has(r, "too many words"), "too many words", r);
+  memset(longLine, 'x', 300);
+  longLine[300] = '\r';
+  r = type(longLine, 301);
+  expect(has(r, "line too long, at most 39 characters") && (strspn(r, "x") == SHELL_LINE - 1),
+         "long line", r);
+  r = TYPE("gz\bame\r");
+  expect(has(r, "gz\b \bame") && has(r, "page game"), "backspace", r);
+  r = TYPE("x\x7f\x7f\x7fhelp\r");
+  expect(has(r, "help\r\n") && has(r, "fifo "), "DEL past the start of the line", r);
+  r = TYPE("sem\x03");
+  expect(has(r, "^C\r\n> ") && !has(r, "LCDFree"), "Ctrl-C", r);
+  r = TYPE("\r");
+  expect(!strcmp(r, "\r\n> "), "empty line", r);
+  r = TYPE("game\r\n");
+  expect(prompts(r) == 1, "CR LF is one line", r);
+  r = TYPE("\n\r\n\r");
+  expect(prompts(r) == 2, "LF CR twice is two lines", r);
+  r = TYPE("\x80\xff\x01\x1b[A\x00game\r");
+  expect(has(r, "[Agame: unknown command") , "control bytes dropped, printable kept", r);
+  r = TYPE("\x80\xff\x01\x00game\r");
+  expect(has(r, "page game"), "binary garbage", r);
+}
+
+static int openPty(void){
+  struct termios tty;
+  int master = posix_openpt(O_RDWR|O_NOCTTY);
+  if((master < 0) || grantpt(master) || unlockpt(master)){
+    perror("pty");
+    exit(1);
+  }
+  Term = open(ptsname(master), O_RDWR|O_NOCTTY);
+  if((Term < 0) || tcgetattr(Term, &tty)){
+    perror(ptsname(master));
+    exit(1);
+  }
+  cfmakeraw(&tty);              // bytes as typed, no echo or CR LF mapping by the pty
+  tcsetattr(Term, TCSANOW, &tty);
+  return master;
+}
+
+int main(int argc, char **argv){
+  pid_t child;
+  const char *r;
+  Fd = openPty();
+  if((argc == 2) && !strcmp(argv[1], "-pty")){
+    printf("shell on %s, for example: screen %s 115200\n", ptsname(Fd), ptsname(Fd));
+    fflush(stdout);
+    serve();                    // Term stays open so the master does not see a hang up
+  }
+  child = fork();
+  if(child == 0){
+    close(Term);
+    serve();
+  }
+  r = TYPE("");
+  expect(has(r, "shell, help lists the commands\r\n> "), "banner", r);
+  commands();
+  parser();
+  kill(child, SIGTERM);
+  waitpid(child, 0, 0);
+  printf("%d checks failed\n", Failed);
+  return Failed != 0;
+}
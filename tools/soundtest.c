@@ -0,0 +1,250 @@
+// soundtest.c
+// Host test of the sound sequencer: sound.c runs unchanged against the
+// model of PWM1 generator 3 and Timer5A in SoundSim.c, which logs every
+// change of the buzzer with the cycle it happened.
+//   init     PF2, PWM1 and Timer5A set up, buzzer off, timer stopped
+//   score    GetScoreSound() returns at once; 1568 Hz from that cycle
+//            for exactly 40 ms, then silence and the timer stopped
+//   tunes    the game over and the beginning tune: every tone within
+//            0.5 % of its note, every change on its exact ms
+//   queue    a note queued while a tune plays starts the tick the tune
+//            ends; a tune that does not fit is dropped whole
+//   stop     Sound_Stop() silences on the cycle it is called, also with
+//            a Timer5A timeout pending
+// One Timer5A interrupt per ms of sound, none in silence.  Then the CPU
+// time the effects cost, next to the busy-wait sound.c this replaced.
+//
+// build: gcc -std=gnu99 -O2 -DSOUND_SIM -I. -o soundtest tools/soundtest.c sound.c SoundSim.c
+// usage: ./soundtest
+// Exit status 1 if a check fails.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "tm4c123gh6pm.h"
+#include "SoundSim.h"
+#include "sound.h"
+
+// cycles of the Cortex-M4 at 80 MHz assumed for the load estimate:
+// entry, exit and Timer5A_Handler() counting down, a few more when it
+// starts the next note
+#define IRQ_CYCLES 60
+#define MS         (SIM_CLOCK/1000)
+
+static int Failed;
+
+void Timer5A_Handler(void);
+
+long StartCritical(void){ return 0; }
+void EndCritical(long sr){ (void)sr; }
+
+static void expect(int ok, const char *what){
+  if(!ok){
+    printf("  FAIL %s\n", what);
+    Failed++;
+  }
+}
+
+// the buzzer changes logged since entry first
+static const SoundSimToneType *since(uint32_t first, uint32_t *n){
+  uint32_t count;
+  const SoundSimToneType *t = SoundSim_Tones(&count);
+  *n = count > first ? count - first : 0;
+  return &t[first];
+}
+
+static uint32_t tones(void){
+  uint32_t n;
+  SoundSim_Tones(&n);
+  return n;
+}
+
+static double hz(uint32_t load){
+  return SIM_CLOCK/64.0/(load + 1);
+}
+
+// the log from entry first on plays tune from cycle start: each note a
+// change at the exact cycle, tones within 0.5 %, silence at the end
+static void heard(const char *name, uint32_t first, const SoundNote *tune, uint64_t start){
+  uint32_t n, i = 0, k;
+  const SoundSimToneType *t = since(first, &n);
+  uint64_t at = start;
+  char what[100];
+  for(k = 0; tune[k].duration; k++){
+    if((k > 0) && (tune[k].frequency == 0) == (tune[k - 1].frequency == 0) &&
+       (tune[k].frequency == tune[k - 1].frequency)){
+      at += tune[k].duration*(uint64_t)MS;  // same sound, no change to see
+      continue;
+    }
+    snprintf(what, sizeof(what), "%s, note %u: %s", name, k, i < n ? "" : "missing");
+    if(i >= n){
+      expect(0, what);
+      return;
+    }
+    if(t[i].cycle != at){
+      snprintf(what, sizeof(what), "%s, note %u at cycle %llu, not %llu", name, k,
+               (unsigned long long)t[i].cycle, (unsigned long long)at);
+      expect(0, what);
+    }
+    if(tune[k].frequency){
+      snprintf(what, sizeof(what), "%s, note %u: %.1f Hz, not %u Hz", name, k,
+               t[i].on ? hz(t[i].load) : 0.0, tune[k].frequency);
+      expect(t[i].on && (abs((int)(hz(t[i].load)*1000) - 1000*tune[k].frequency) <
+                         5*tune[k].frequency), what);
+    }else{
+      snprintf(what, sizeof(what), "%s, note %u: not a rest", name, k);
+      expect(!t[i].on, what);
+    }
+    at += tune[k].duration*(uint64_t)MS;
+    i++;
+  }
+  snprintf(what, sizeof(what), "%s: silence at cycle %llu", name, (unsigned long long)at);
+  expect((i + 1 == n) && !t[i].on && (t[i].cycle == at), what);
+}
+
+static const SoundNote Score[] = { {1568, 40}, {0, 0} };
+static const SoundNote GameOver[] = {
+  {1046, 150}, {0, 20}, {987, 150}, {0, 20}, {932, 150}, {0, 20},
+  {880, 150}, {0, 20}, {830, 150}, {0, 20}, {784, 300}, {0, 0}
+};
+static const SoundNote Beginning[] = { {523, 80}, {659, 80}, {784, 80}, {1046, 160}, {0, 0} };
+static const SoundNote Short[] = { {440, 30}, {0, 0} };
+
+static uint32_t tuneMs(const SoundNote *tune){
+  uint32_t ms = 0;
+  while(tune->duration){
+    ms += (tune++)->duration;
+  }
+  return ms;
+}
+
+static void init(void){
+  uint32_t n;
+  SoundSim_Reset();
+  Sound_Init();
+  SoundSim_Run(MS);
+  expect(!SoundSim_TimerOn() && (SoundSimStats.interrupts == 0), "Timer5A runs after Sound_Init");
+  expect((TIMER5_TAILR_R == MS - 1) && (NVIC_EN2_R == 0x10000000) &&
+         ((NVIC_PRI23_R&0xE0) == SOUND_PRIORITY << 5), "Timer5A period or interrupt");
+  since(0, &n);
+  expect((n == 1) && !Sound_Busy(), "the buzzer sounds after Sound_Init");
+}
+
+// an effect from a random cycle, the log afterwards
+static void effect(const char *name, void (*play)(void), const SoundNote *tune){
+  uint32_t first, ticks = SoundStats.ticks, ms = tuneMs(tune);
+  uint64_t start;
+  char what[80];
+  SoundSim_Run(rand()%MS + 1);
+  start = SoundSimStats.cycles;
+  first = tones();
+  play();
+  snprintf(what, sizeof(what), "%s: not busy when it returns", name);
+  expect(Sound_Busy(), what);
+  SoundSim_Run(ms*(uint64_t)MS + 10*MS);
+  heard(name, first, tune, start);
+  snprintf(what, sizeof(what), "%s: %u ticks for %u ms, timer %s", name,
+           SoundStats.ticks - ticks, ms, SoundSim_TimerOn() ? "on" : "off");
+  expect((SoundStats.ticks - ticks == ms) && !SoundSim_TimerOn() && !Sound_Busy(), what);
+}
+
+static void queue(void){
+  static SoundNote both[5 + 1];
+  uint32_t i, first, notes, dropped;
+  uint64_t start;
+  // a note queued during a tune follows it without a gap
+  SoundSim_Run(MS/3);
+  start = SoundSimStats.cycles;
+  first = tones();
+  BeginningSound();
+  SoundSim_Run(50*MS + 123);
+  expect(Sound_Note(440, 30), "Sound_Note refused with room in the queue");
+  SoundSim_Run(600*MS);
+  for(i = 0; i < 4; i++){
+    both[i] = Beginning[i];
+  }
+  both[4] = Short[0];
+  both[5].duration = 0;
+  heard("note after the beginning tune", first, both, start);
+  // a full queue drops a tune whole
+  dropped = SoundStats.dropped;
+  for(i = 0; i < SOUND_QUEUE + 1; i++){
+    expect(Sound_Note(1000 + 10*i, 5), "Sound_Note refused with room in the queue");
+  }
+  expect(!Sound_Note(2000, 5), "Sound_Note queued past SOUND_QUEUE");
+  notes = SoundStats.notes;
+  expect(!Sound_Tune(GameOver) && (SoundStats.dropped == dropped + 12), "a tune that does not fit");
+  SoundSim_Run(6*MS);                 // the first note ends, one place free
+  expect(Sound_Tune(Short), "a short tune with room made");
+  SoundSim_Run(300*MS);
+  expect((SoundStats.notes == notes + SOUND_QUEUE + 1) && !Sound_Busy(),
+         "notes played from a full queue");
+}
+
+static void stop(void){
+  uint32_t n, ticks;
+  uint64_t at;
+  const SoundSimToneType *t;
+  PlayGameOverSound();
+  SoundSim_Run(75*MS + 4567);
+  at = SoundSimStats.cycles;
+  Sound_Stop();
+  SoundSim_Run(0);
+  t = since(tones() - 1, &n);
+  expect(!t->on && (t->cycle == at) && !SoundSim_TimerOn() && !Sound_Busy(), "Sound_Stop");
+  // stopped with the timeout already pending: no tick, nothing starts
+  GetScoreSound();
+  SoundSim_Run(10*MS - 1);
+  ticks = SoundStats.ticks;
+  TIMER5_RIS_R |= 1;
+  Sound_Stop();
+  SoundSim_Run(MS);
+  expect((SoundStats.ticks == ticks) && !SoundSim_TimerOn(), "a timeout pending at Sound_Stop");
+  // taken anyway, as the NVIC would once it latched it
+  Timer5A_Handler();
+  SoundSim_Run(100*MS);
+  expect(!Sound_Busy() && !SoundSim_TimerOn() && (SoundSimStats.interrupts == SoundStats.ticks - 1),
+         "a late interrupt after Sound_Stop");
+  GetScoreSound();
+  SoundSim_Run(100*MS);
+  t = since(tones() - 2, &n);
+  expect((n == 2) && t[0].on && !t[1].on && (t[1].cycle - t[0].cycle == 40*MS),
+         "a tune after Sound_Stop");
+}
+
+// the CPU time of the effects, interrupts against the busy-wait
+static void load(void){
+  uint32_t i, irqs = SoundSimStats.interrupts, played = 0;
+  clock_t c = clock();
+  double ns;
+  for(i = 0; i < 1000; i++){
+    PlayGameOverSound();
+    SoundSim_Run((tuneMs(GameOver) + 1)*(uint64_t)MS);
+    played += tuneMs(GameOver);
+  }
+  irqs = SoundSimStats.interrupts - irqs;
+  ns = 1e9*(clock() - c)/CLOCKS_PER_SEC/irqs;
+  printf("game over tune, %u ms: %u Timer5A interrupts, %.0f ns each on the host with the model\n",
+         tuneMs(GameOver), irqs/1000, ns);
+  printf("  estimate at %u cycles each: %.3f ms of CPU, %.3f %% while it plays; "
+         "the busy-wait took all %u ms\n", IRQ_CYCLES, (double)irqs/1000*IRQ_CYCLES/MS,
+         100.0*IRQ_CYCLES*irqs/((double)played*MS), tuneMs(GameOver));
+  expect(irqs == played, "one interrupt per ms played");
+}
+
+int main(void){
+  srand(49);
+  init();
+  effect("score", &GetScoreSound, Score);
+  effect("game over", &PlayGameOverSound, GameOver);
+  effect("beginning", &BeginningSound, Beginning);
+  queue();
+  stop();
+  load();
+  printf("%u notes, %u dropped, %u ticks; model: %u interrupts, %u errors\n", SoundStats.notes,
+         SoundStats.dropped, SoundStats.ticks, SoundSimStats.interrupts, SoundSimStats.errors);
+  expect(SoundSimStats.errors == 0, "errors found by the model");
+  printf("%d checks failed\n", Failed);
+  return Failed != 0;
+}
@@ -0,0 +1,188 @@
+// sweeptrace.c
+// Host tool: replay joystick traces through the fixed-step integration
+// Producer() used before game.c's joystick pipeline and count the grid cells the crosshair crosses, then how
+// many of them a hit test finds when it looks only at the newest
+// sample of each frame (the old update()) and when it sweeps the
+// segment between samples with Board_Sweep() from board.c.  Every
+// crossed cell counts as a cube, so "missed" is a cube a fast sweep
+// would have passed through without scoring.
+//
+// A trace file has one Producer sample per line, "rawX rawY" from
+// BSP_Joystick_Input() (0 to 4095), # starts a comment.  Without files
+// the built-in traces are replayed.
+//
+// build: gcc -std=gnu99 -O2 -DHOST_SIM -I. -o sweeptrace tools/sweeptrace.c board.c
+// usage: ./sweeptrace [-step n] [-ticks n] [trace ...]
+//   -step n   ADC units the crosshair moves per tick, it was 6
+//   -ticks n  Producer samples per game frame, 2 at 100 Hz and 50 Hz
+// Exit status 1 if the sweep misses any crossed cell.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "board.h"
+
+#define TRACE_MAX 20000     // samples in one trace
+#define DENSE     64        // points per segment of the reference path
+
+static uint16_t RawX[TRACE_MAX], RawY[TRACE_MAX];
+static int Samples;
+static int Step = 6;
+static int Ticks = 2;
+
+typedef struct {
+  uint32_t crossed, oldFound, sweepFound;
+} ResultType;
+
+static int cellOf(int x, int y){
+  int cx = x*6/128, cy = y*66/1280;
+  return BOARD_CELL(cx, (cy > 5) ? 5 : cy);
+}
+
+//------------built-in traces------------
+static void add(uint16_t x, uint16_t y, int n){
+  while(n-- && (Samples < TRACE_MAX)){
+    RawX[Samples] = x;
+    RawY[Samples] = y;
+    Samples++;
+  }
+}
+
+// stick held right, then down, left and up: the edges of the screen
+static void traceBox(void){
+  add(4095, 2048, 800); add(2048, 4095, 800);
+  add(0, 2048, 800); add(2048, 0, 800);
+}
+
+// stick pushed into the corners: diagonal sweeps across cell corners
+static void traceDiagonal(void){
+  int i;
+  for(i = 0; i < 3; i++){
+    add(4095, 0, 700); add(0, 4095, 700);
+  }
+}
+
+// random flicks, each held for a random time
+static void traceFlicks(void){
+  static const uint16_t level[3] = {0, 2048, 4095};
+  uint32_t lfsr = 0xACE1u;
+  int i;
+  for(i = 0; i < 200; i++){
+    lfsr = (lfsr >> 1) ^ (-(lfsr & 1u) & 0xB400u);
+    add(level[lfsr % 3], level[(lfsr >> 4) % 3], 10 + (lfsr >> 8) % 90);
+  }
+}
+
+static int load(const char *name){
+  FILE *f = fopen(name, "r");
+  char line[80];
+  unsigned x, y;
+  if(!f){
+    perror(name);
+    return 0;
+  }
+  while(fgets(line, sizeof(line), f) && (Samples < TRACE_MAX)){
+    if((line[0] != '#') && (sscanf(line, "%u %u", &x, &y) == 2)){
+      add(x, y, 1);
+    }
+  }
+  fclose(f);
+  return 1;
+}
+
+//------------replay------------
+// the thresholds, clamps and scale Producer() had
+static void produce(int i, int *ox, int *oy, int16_t *px, int16_t *py){
+  if(RawX[i] > 3000) *ox += Step;
+  if(RawY[i] < 1800) *oy += Step;
+  if(RawX[i] < 1400) *ox -= Step;
+  if(RawY[i] > 3000) *oy -= Step;
+  if(*ox >= 4050) *ox = 4050;
+  if(*ox <= 50) *ox = 50;
+  if(*oy <= 50) *oy = 50;
+  if(*oy >= 3550) *oy = 3550;
+  *px = (*ox * 128) / 4095;
+  *py = (*oy * 128) / 4095;
+}
+
+static void replay(const char *name, ResultType *r){
+  int ox = 2048, oy = 2048;
+  int16_t x, y, startX, startY, lastX, lastY;
+  uint64_t crossed, swept;
+  uint8_t cells[BOARD_SWEEPMAX];
+  int i, k, n, start;
+  memset(r, 0, sizeof(*r));
+  produce(0, &ox, &oy, &lastX, &lastY);
+  for(i = 1; i < Samples; i += Ticks){
+    startX = lastX;
+    startY = lastY;
+    start = cellOf(startX, startY);
+    crossed = swept = 0;
+    for(k = i; (k < i + Ticks) && (k < Samples); k++){
+      produce(k, &ox, &oy, &x, &y);
+      // reference: many points along the segment
+      for(n = 1; n <= DENSE; n++){
+        crossed |= BOARD_BIT(cellOf(lastX + (x - lastX)*n/DENSE, lastY + (y - lastY)*n/DENSE));
+      }
+      n = Board_Sweep(lastX, lastY, x, y, cells);
+      while(n--){
+        swept |= BOARD_BIT(cells[n]);
+      }
+      lastX = x;
+      lastY = y;
+    }
+    crossed &= ~BOARD_BIT(start);   // update() skips the cell it was in
+    swept &= ~BOARD_BIT(start);
+    r->crossed += __builtin_popcountll(crossed);
+    r->sweepFound += __builtin_popcountll(crossed & swept);
+    if(cellOf(lastX, lastY) != start){
+      r->oldFound++;                // the newest sample only
+    }
+  }
+  printf("%-12s %6d samples  %5u crossed  newest sample %5u found %4u missed"
+         "  swept %5u found %4u missed\n", name, Samples, r->crossed,
+         r->oldFound, r->crossed - r->oldFound,
+         r->sweepFound, r->crossed - r->sweepFound);
+}
+
+int main(int argc, char **argv){
+  static const struct {
+    const char *name;
+    void (*make)(void);
+  } builtin[] = {
+    {"box", traceBox}, {"diagonal", traceDiagonal}, {"flicks", traceFlicks}
+  };
+  ResultType r;
+  int i, files = 0, fail = 0;
+  for(i = 1; i < argc; i++){
+    if(!strcmp(argv[i], "-step") && (i + 1 < argc)){
+      Step = atoi(argv[++i]);
+    }else if(!strcmp(argv[i], "-ticks") && (i + 1 < argc)){
+      Ticks = atoi(argv[++i]);
+    }
+  }
+  if(Ticks < 1) Ticks = 1;
+  printf("step %d ADC units per tick, %d ticks per frame\n", Step, Ticks);
+  for(i = 1; i < argc; i++){
+    if(!strcmp(argv[i], "-step") || !strcmp(argv[i], "-ticks")){
+      i++;
+      continue;
+    }
+    files++;
+    Samples = 0;
+    if(!load(argv[i])){
+      fail = 1;
+      continue;
+    }
+    replay(argv[i], &r);
+    fail |= (r.sweepFound != r.crossed);
+  }
+  for(i = 0; (files == 0) && (i < (int)(sizeof(builtin)/sizeof(builtin[0]))); i++){
+    Samples = 0;
+    builtin[i].make();
+    replay(builtin[i].name, &r);
+    fail |= (r.sweepFound != r.crossed);
+  }
+  return fail;
+}
@@ -0,0 +1,1070 @@
+// teledecode.c
+// Host decoder of the telemetry frames the board sends on UART0, see
+// telemetry.h: reads a file, a serial device or a pty, checks each
+// frame's COBS encoding, CRC and sequence number, and prints one line
+// per record, the Log records formatted with LOG_FORMATS.  With -csv it
+// writes prefix-log.csv, prefix-game.csv, prefix-kernel.csv and
+// prefix-threads.csv and prefix-trace.csv instead, one row per record
+// (per thread for TELE_THREADS, per event for TELE_TRACE), for a
+// spreadsheet or a plot.  -trace writes the kernel trace dumps of
+// trace.h as Chrome trace JSON, each dump a process with a track per
+// thread, interrupt and semaphore spin, to open in chrome://tracing or
+// ui.perfetto.dev.  At the end, to stderr,
+// frames good and damaged and the frames the board dropped, from the
+// gaps in the sequence numbers.
+//
+// -test runs log.c and telemetry.c themselves on the host: Log calls at
+// random, and what the Telemetry thread in Main.c does, every 20 ms
+// Log_Drain() and every 100 ms the three snapshots, into a UART0 that
+// sends at 115200 baud.  The decoder must give back every Log record not
+// counted lost and every snapshot not dropped, exactly; then, with bytes
+// damaged on the line, lose only the frames they are in and accept no
+// more damaged frames than a CRC-16 lets through, one in 65536.
+// Then trace.c: two dumps, one of a full ring and one triggered early,
+// must come back event for event, centred on the trigger, and make
+// Chrome trace JSON.  Last the cost of a Log2() call, a TELE_GAME frame
+// and a Trace_Event() call on the host.
+//
+// build: gcc -std=gnu99 -O2 -I. -o teledecode tools/teledecode.c log.c telemetry.c trace.c UART_FIFO.c
+// usage: ./teledecode [-csv prefix] [-trace file.json] file|device|-    - reads stdin
+//        ./teledecode -test [-n calls]
+// Exit status 1 if the test fails.
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include "os.h"
+#include "UART.h"
+#include "UART_FIFO.h"
+#include "telemetry.h"
+#include "log.h"
+#include "trace.h"
+
+#define LOG_STRING(id, format) format,
+#define LOG_NAME(id, format) #id,
+#define TELE_NAME(name, what) #name,
+static const char *Format[LOG_IDS] = { LOG_FORMATS(LOG_STRING) };
+static const char *Name[LOG_IDS] = { LOG_FORMATS(LOG_NAME) };
+static const char *GameName[] = { TELE_GAME_FIELDS(TELE_NAME) };
+static const char *KernelName[] = { TELE_KERNEL_FIELDS(TELE_NAME) };
+static const char *StateName[] = { "running", "ready", "sleeping", "waiting" };
+#define TRACE_NAME(type, what) #type,
+static const char *TraceName[TRACE_TYPE_COUNT] = { TRACE_TYPES(TRACE_NAME) };
+
+#define BODY_MAX (5 + TELE_PAYLOAD)       // type, seq, payload, crc
+#define SEQ_WINDOW 1024                   // frames dropped in a row, more is damage or a reset
+
+//------------Log records------------
+typedef struct {
+  uint32_t id, args, arg[LOG_ARGS];
+  uint64_t cycles;            // since LOG_BOOT, unwrapped
+} RecordType;
+
+typedef struct {
+  uint8_t buffer[4*(2 + LOG_ARGS)];
+  uint32_t count;             // bytes of the record in buffer
+  uint32_t lastTime;
+  uint64_t cycles;
+  int started;
+  uint32_t records, skipped;
+} DecoderType;
+
+// feed one byte, 1 when it completes a record
+static int decode(DecoderType *d, uint8_t byte, RecordType *r){
+  uint32_t header, words, i, t;
+  int32_t delta;
+  const uint8_t *b = d->buffer;
+  d->buffer[d->count++] = byte;
+  while(d->count){
+    header = b[0] | (d->count > 1 ? b[1] << 8 : 0) | (d->count > 2 ? b[2] << 16 : 0) |
+             (d->count > 3 ? (uint32_t)b[3] << 24 : 0);
+    // a header is 0xA5, the number of arguments, an id and a zero byte
+    if((b[0] == LOG_SYNC) && ((d->count < 2) || (b[1] <= LOG_ARGS)) &&
+       ((d->count < 3) || (b[2] < LOG_IDS)) && ((d->count < 4) || (b[3] == 0))){
+      break;
+    }
+    memmove(d->buffer, d->buffer + 1, --d->count);    // not a header, resync
+    d->skipped++;
+  }
+  if(d->count < 4){
+    return 0;
+  }
+  words = 2 + ((header >> 8)&0xFF);
+  if(d->count < 4*words){
+    return 0;
+  }
+  r->id = (header >> 16)&0xFF;
+  r->args = words - 2;
+  t = b[4] | b[5] << 8 | b[6] << 16 | (uint32_t)b[7] << 24;
+  for(i = 0; i < r->args; i++){
+    r->arg[i] = b[8 + 4*i] | b[9 + 4*i] << 8 | b[10 + 4*i] << 16 | (uint32_t)b[11 + 4*i] << 24;
+  }
+  for(; i < LOG_ARGS; i++){
+    r->arg[i] = 0;
+  }
+  // LOG_TIME comes every 10 s, so one record follows the one before
+  // within that; a time further away, forward or back, is not trusted
+  // and the record gets the time of the one before.  A time a little
+  // ahead is taken, the next record steps back by as much.
+  delta = (int32_t)(t - d->lastTime);
+  if(!d->started || (r->id == LOG_BOOT)){
+    d->started = 1;
+    d->cycles = 0;
+    d->lastTime = t;
+  }else if((delta < 2*LOG_TIME_MS*80000) && (delta > -2*LOG_TIME_MS*80000)){
+    d->cycles += delta;
+    d->lastTime = t;
+  }
+  r->cycles = d->cycles;
+  d->count = 0;
+  d->records++;
+  return 1;
+}
+
+//------------trace dumps------------
+typedef struct {
+  uint32_t time[TRACE_EVENTS], event[TRACE_EVENTS];
+  uint32_t events;            // in the dump
+  uint32_t got;               // events received in order, the dump is whole at events
+  uint32_t dump, eventCycles;
+  uint32_t dumps, broken;     // whole dumps, dumps a frame of which was lost
+} DumpType;
+
+//------------frames------------
+typedef struct {
+  uint8_t raw[BODY_MAX + 2];  // COBS bytes since the last 0x00
+  uint32_t n;
+  int overflow;
+  uint8_t body[BODY_MAX];     // the frame decoded
+  uint32_t size;
+  uint32_t type;
+  uint64_t seq;               // unwrapped
+  int started;
+  int restart;                // restartSeq came far from the sequence
+  uint16_t restartSeq;
+  uint32_t good, damaged, dropped, bytes;
+  DecoderType log;
+  DumpType trace;
+} StreamType;
+
+typedef struct {
+  int csv;
+  FILE *out[6];               // stdout, or a file per type for CSV
+  FILE *json;                 // Chrome trace of the dumps, or 0
+  uint32_t jsonEvents;
+} OutputType;
+
+// CRC-16/CCITT bit by bit, not the table of telemetry.c
+static uint16_t crc16(const uint8_t *pt, uint32_t n){
+  uint16_t crc = 0xFFFF;
+  uint32_t i;
+  while(n--){
+    crc ^= *pt++ << 8;
+    for(i = 0; i < 8; i++){
+      crc = (crc&0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+static uint32_t word(const uint8_t *pt){
+  return pt[0] | pt[1] << 8 | pt[2] << 16 | (uint32_t)pt[3] << 24;
+}
+
+// undo COBS and check the CRC, 1 if s->body holds a good frame
+static int unframe(StreamType *s){
+  uint32_t i = 0, k, code, m = 0;
+  uint16_t seq, gap;
+  if(s->overflow || (s->n == 0)){
+    return 0;
+  }
+  while(i < s->n){
+    code = s->raw[i++];
+    if((code == 0) || (i + code - 1 > s->n)){
+      return 0;
+    }
+    for(k = 1; k < code; k++){
+      s->body[m++] = s->raw[i++];
+    }
+    if((code != 0xFF) && (i < s->n)){
+      if(m == BODY_MAX) return 0;
+      s->body[m++] = 0;
+    }
+  }
+  if((m < 5) || (crc16(s->body, m - 2) != (s->body[m - 2] | s->body[m - 1] << 8))){
+    return 0;
+  }
+  s->type = s->body[0];
+  s->size = m - 5;
+  seq = s->body[1] | s->body[2] << 8;
+  gap = (uint16_t)(seq - (uint16_t)(s->seq + 1));
+  if(s->started && (gap >= SEQ_WINDOW)){
+    // CRC-16 passes one damaged frame in 65536, the sequence number
+    // catches most of those; two frames in a row start over (a reset)
+    if(!s->restart || (seq != (uint16_t)(s->restartSeq + 1))){
+      s->restart = 1;
+      s->restartSeq = seq;
+      return 0;
+    }
+    gap = 0;
+  }
+  s->restart = 0;
+  if(s->started){
+    s->dropped += gap;
+    s->seq += 1 + gap;
+  }else{
+    s->seq = seq;
+    s->started = 1;
+  }
+  return 1;
+}
+
+static void printLog(FILE *out, const RecordType *r, int csv){
+  uint32_t i;
+  if(csv){
+    fprintf(out, "%.6f,%s", r->cycles/80e6, Name[r->id]);
+    for(i = 0; i < r->args; i++){
+      fprintf(out, ",%u", r->arg[i]);
+    }
+    fprintf(out, "\n");
+  }else{
+    fprintf(out, "%12.6f  ", r->cycles/80e6);
+    fprintf(out, Format[r->id], r->arg[0], r->arg[1], r->arg[2], r->arg[3]);
+    fprintf(out, "\n");
+  }
+}
+
+static void printFields(FILE *out, const char *type, const char **name, const uint8_t *p, uint32_t n, int csv){
+  uint32_t i;
+  if(csv){
+    fprintf(out, "%.3f", word(p)/1e3);
+    for(i = 1; i < n; i++){
+      fprintf(out, ",%u", word(p + 4*i));
+    }
+  }else{
+    fprintf(out, "%12.3f  %s", word(p)/1e3, type);
+    for(i = 1; i < n; i++){
+      fprintf(out, " %s %u", name[i], word(p + 4*i));
+    }
+  }
+  fprintf(out, "\n");
+}
+
+static void printThreads(FILE *out, const uint8_t *p, uint32_t n, int csv){
+  uint32_t i, w, ms = word(p);
+  if(!csv){
+    fprintf(out, "%12.3f  threads", ms/1e3);
+  }
+  for(i = 0; i < n; i++){
+    w = word(p + 4 + 8*i);
+    if(csv){
+      fprintf(out, "%.3f,%u,%s,%u,%u,%u\n", ms/1e3, w&0xFF, StateName[((w >> 8)&0xFF)%4], (w >> 16)&0xFF,
+              w >> 24, word(p + 8 + 8*i));
+    }else{
+      fprintf(out, " %u:%s", w&0xFF, StateName[((w >> 8)&0xFF)%4]);
+    }
+  }
+  if(!csv){
+    fprintf(out, "\n");
+  }
+}
+
+// one TELE_TRACE frame into d, 1 when it completes a dump
+static int dump(DumpType *d, const uint8_t *p, uint32_t n){
+  uint32_t i, first = p[0] | p[1] << 8, number = p[2] | p[3] << 8, events = word(p + 4);
+  if((events > TRACE_EVENTS) || (first + n > events)){
+    return 0;
+  }
+  if(first == 0){
+    if(d->got && (d->got < d->events)){
+      d->broken++;
+    }
+    d->dump = number;
+    d->events = events;
+    d->eventCycles = word(p + 8);
+    d->got = 0;
+  }else if((number != d->dump) || (first != d->got)){
+    if(d->got < d->events){
+      d->broken++;
+    }
+    d->events = d->got = 0;         // wait for the next dump
+    return 0;
+  }
+  p += sizeof(TraceHeaderType);
+  for(i = 0; i < n; i++){
+    d->time[d->got] = word(p + 8*i);
+    d->event[d->got++] = word(p + 4 + 8*i);
+  }
+  if(d->got < d->events){
+    return 0;
+  }
+  d->dumps++;
+  return 1;
+}
+
+static void printDump(FILE *out, const DumpType *d, int csv){
+  uint32_t i, e;
+  uint64_t cycles = 0;
+  if(!csv){
+    fprintf(out, "%12s  trace dump %u, %u events, %u cycles an event\n", "", d->dump, d->events, d->eventCycles);
+  }
+  for(i = 0; i < d->events; i++){
+    e = d->event[i];
+    cycles += i ? (uint32_t)(d->time[i] - d->time[i - 1]) : 0;
+    if(csv){
+      fprintf(out, "%u,%.6f,%s,%u,%u\n", d->dump, cycles/80e6, TraceName[(e&0xFF)%TRACE_TYPE_COUNT],
+              (e >> 8)&0xFF, e >> 16);
+    }else{
+      fprintf(out, "%12.6f  %-15s thread %3u arg %u\n", cycles/80e6, TraceName[(e&0xFF)%TRACE_TYPE_COUNT],
+              (e >> 8)&0xFF, e >> 16);
+    }
+  }
+}
+
+static const char *irqName(uint32_t irq){
+  switch(irq){
+    case TRACE_IRQ_GPIOD:   return "GPIOPortD";
+    case TRACE_IRQ_UART0:   return "UART0";
+    case TRACE_IRQ_ADC0SS1: return "ADC0Seq1";
+    case TRACE_IRQ_TIMER1A: return "Timer1A";
+    case TRACE_IRQ_TIMER2A: return "Timer2A";
+    case TRACE_IRQ_TIMER4A: return "Timer4A";
+    case TRACE_IRQ_TIMER5A: return "Timer5A";
+    case TRACE_IRQ_WTIMER0A: return "WideTimer0A";
+  }
+  return "IRQ";
+}
+
+// Chrome trace tracks of a dump, thread ids:
+#define TID_ISR  1000         // + interrupt number, its handler running
+#define TID_SEMA 500          // + thread, it spinning on a semaphore
+
+static void json(OutputType *o, const char *format, ...){
+  va_list args;
+  fprintf(o->json, o->jsonEvents++ ? ",\n" : "\n");
+  va_start(args, format);
+  vfprintf(o->json, format, args);
+  va_end(args);
+}
+
+static void slice(OutputType *o, uint32_t pid, uint32_t tid, const char *name, double from, double to){
+  json(o, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%.4f,\"dur\":%.4f}",
+       name, pid, tid, from, to - from);
+}
+
+// a dump as Chrome trace events, a process of its own: a track per thread
+// with a slice for each time it runs and a mark for its other events, a
+// track per interrupt, a track per thread for its semaphore spins
+static void jsonDump(OutputType *o, const DumpType *d){
+  static double run[256], isr[256], block[256];   // start, -1 if none
+  static uint8_t sema[256];
+  static uint8_t used[3][256];                    // tracks: thread, interrupt, spin
+  char name[32];
+  uint32_t i, e, type, thread, arg, pid = d->dump + 1;
+  int running = -1;
+  uint64_t cycles = 0;
+  double us = 0;
+  memset(used, 0, sizeof(used));
+  for(i = 0; i < 256; i++){
+    run[i] = isr[i] = block[i] = -1;
+  }
+  for(i = 0; i < d->events; i++){
+    e = d->event[i];
+    type = e&0xFF;
+    thread = (e >> 8)&0xFF;
+    arg = e >> 16;
+    cycles += i ? (uint32_t)(d->time[i] - d->time[i - 1]) : 0;
+    us = cycles/80.0;                             // 80 MHz bus cycles
+    used[0][thread] = 1;
+    switch(type){
+      case TRACE_SWITCH:
+        if(running >= 0){
+          slice(o, pid, running, "run", run[running], us);
+        }else if(run[thread] < 0){
+          slice(o, pid, thread, "run", 0, us);    // since before the dump
+        }
+        running = arg&0xFF;
+        used[0][running] = 1;
+        run[running] = us;
+        break;
+      case TRACE_ISR_ENTER:
+        isr[arg&0xFF] = us;
+        used[1][arg&0xFF] = 1;
+        break;
+      case TRACE_ISR_EXIT:
+        if(isr[arg&0xFF] >= 0){
+          slice(o, pid, TID_ISR + (arg&0xFF), irqName(arg), isr[arg&0xFF], us);
+        }
+        isr[arg&0xFF] = -1;
+        break;
+      case TRACE_BLOCK:
+        block[thread] = us;
+        sema[thread] = arg;
+        used[2][thread] = 1;
+        break;
+      case TRACE_WAKE:
+        if(block[thread] >= 0){
+          snprintf(name, sizeof(name), "wait sem %u", arg);
+          slice(o, pid, TID_SEMA + thread, name, block[thread], us);
+        }
+        block[thread] = -1;
+        break;
+      default:
+        json(o, "{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":%u,\"tid\":%u,\"ts\":%.4f,"
+             "\"args\":{\"arg\":%u}}", TraceName[type%TRACE_TYPE_COUNT] + 6, pid, thread, us, arg);
+        break;
+    }
+  }
+  // what is still going on at the end of the dump
+  if(running >= 0){
+    slice(o, pid, running, "run", run[running], us);
+  }
+  for(i = 0; i < 256; i++){
+    if(isr[i] >= 0){
+      slice(o, pid, TID_ISR + i, irqName(i), isr[i], us);
+    }
+    if(block[i] >= 0){
+      snprintf(name, sizeof(name), "wait sem %u", sema[i]);
+      slice(o, pid, TID_SEMA + i, name, block[i], us);
+    }
+  }
+  json(o, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,"
+       "\"args\":{\"name\":\"dump %u, %u events, %u cycles an event\"}}", pid, d->dump, d->events, d->eventCycles);
+  for(i = 0; i < 256; i++){
+    if(used[0][i]){
+      if(i == TRACE_NO_THREAD){
+        json(o, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":\"no thread\"}}", pid, i);
+      }else{
+        json(o, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}", pid, i, i);
+      }
+    }
+    if(used[1][i]){
+      json(o, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":\"%s %u\"}}",
+           pid, TID_ISR + i, irqName(i), i);
+    }
+    if(used[2][i]){
+      json(o, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":\"thread %u spins\"}}",
+           pid, TID_SEMA + i, i);
+    }
+  }
+}
+
+// one frame of the line, 0x00 not included; a damaged one is counted
+// Output: 1 if good, -1 if damaged
+static int frame(StreamType *s, OutputType *o){
+  RecordType r;
+  const uint8_t *p = &s->body[3];
+  uint32_t i;
+  if(!unframe(s)){
+    s->damaged++;
+    return -1;
+  }
+  switch(s->type){
+    case TELE_LOG:
+      if(s->size%4) break;
+      for(i = 0; i < s->size; i++){
+        if(decode(&s->log, p[i], &r) && o){
+          printLog(o->out[TELE_LOG], &r, o->csv);
+        }
+      }
+      s->log.count = 0;         // records never straddle frames
+      s->good++;
+      return 1;
+    case TELE_GAME:
+      if(s->size != sizeof(TeleGameType)) break;
+      if(o) printFields(o->out[TELE_GAME], "game", GameName, p, s->size/4, o->csv);
+      s->good++;
+      return 1;
+    case TELE_KERNEL:
+      if(s->size != sizeof(TeleKernelType)) break;
+      if(o) printFields(o->out[TELE_KERNEL], "kernel", KernelName, p, s->size/4, o->csv);
+      s->good++;
+      return 1;
+    case TELE_THREADS:
+      if((s->size < 4) || ((s->size - 4)%8)) break;
+      if(o) printThreads(o->out[TELE_THREADS], p, (s->size - 4)/8, o->csv);
+      s->good++;
+      return 1;
+    case TELE_TRACE:
+      if((s->size < sizeof(TraceHeaderType)) || ((s->size - sizeof(TraceHeaderType))%8)) break;
+      if(dump(&s->trace, p, (s->size - sizeof(TraceHeaderType))/8) && o){
+        if(o->out[TELE_TRACE]) printDump(o->out[TELE_TRACE], &s->trace, o->csv);
+        if(o->json) jsonDump(o, &s->trace);
+      }
+      s->good++;
+      return 1;
+  }
+  s->damaged++;                 // a good CRC on a frame this tool does not know
+  return -1;
+}
+
+// feed one byte of the line
+// Output: 1 when it ended a good frame, -1 a damaged one, 0 otherwise
+static int feed(StreamType *s, uint8_t byte, OutputType *o){
+  int result = 0;
+  s->bytes++;
+  if(byte == 0){
+    if(s->n || s->overflow){
+      result = frame(s, o);
+    }
+    s->n = 0;
+    s->overflow = 0;
+    return result;
+  }
+  if(s->n < sizeof(s->raw)){
+    s->raw[s->n++] = byte;
+  }else{
+    s->overflow = 1;
+  }
+  return 0;
+}
+
+static FILE *csvFile(const char *prefix, const char *type, const char *header){
+  char name[256];
+  FILE *f;
+  snprintf(name, sizeof(name), "%s-%s.csv", prefix, type);
+  f = fopen(name, "w");
+  if(!f){
+    perror(name);
+    exit(1);
+  }
+  fprintf(f, "%s\n", header);
+  return f;
+}
+
+static int decodeFile(const char *name, const char *prefix, const char *trace){
+  static StreamType s;
+  OutputType o;
+  struct termios tty;
+  char header[512];
+  uint8_t buffer[256];
+  ssize_t n, i;
+  int fd = strcmp(name, "-") ? open(name, O_RDONLY|O_NOCTTY) : 0;
+  if(fd < 0){
+    perror(name);
+    return 1;
+  }
+  if(isatty(fd) && (tcgetattr(fd, &tty) == 0)){
+    cfmakeraw(&tty);
+    cfsetispeed(&tty, B115200);
+    cfsetospeed(&tty, B115200);
+    tcsetattr(fd, TCSANOW, &tty);
+  }
+  o.csv = prefix != 0;
+  for(i = 0; i < 6; i++){
+    o.out[i] = stdout;
+  }
+  o.json = 0;
+  o.jsonEvents = 0;
+  if(trace){
+    o.json = fopen(trace, "w");
+    if(!o.json){
+      perror(trace);
+      return 1;
+    }
+    fprintf(o.json, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+  }
+  if(prefix){
+    o.out[TELE_LOG] = csvFile(prefix, "log", "seconds,id,arg0,arg1,arg2,arg3");
+    strcpy(header, "seconds");
+    for(i = 1; i < (ssize_t)(sizeof(GameName)/sizeof(GameName[0])); i++){
+      strcat(header, ",");
+      strcat(header, GameName[i]);
+    }
+    o.out[TELE_GAME] = csvFile(prefix, "game", header);
+    strcpy(header, "seconds");
+    for(i = 1; i < (ssize_t)(sizeof(KernelName)/sizeof(KernelName[0])); i++){
+      strcat(header, ",");
+      strcat(header, KernelName[i]);
+    }
+    o.out[TELE_KERNEL] = csvFile(prefix, "kernel", header);
+    o.out[TELE_THREADS] = csvFile(prefix, "threads", "seconds,id,state,priority,cell,sleepMs");
+    o.out[TELE_TRACE] = csvFile(prefix, "trace", "dump,seconds,type,thread,arg");
+  }
+  while((n = read(fd, buffer, sizeof(buffer))) > 0){
+    for(i = 0; i < n; i++){
+      if(feed(&s, buffer[i], &o) && !prefix){
+        fflush(stdout);
+      }
+    }
+  }
+  for(i = 1; i < 6; i++){
+    if(o.out[i] != stdout) fclose(o.out[i]);
+  }
+  if(o.json){
+    fprintf(o.json, "\n]}\n");
+    fclose(o.json);
+  }
+  fprintf(stderr, "%u bytes, %u frames, %u damaged, %u dropped by the board, %u Log records, %u trace dumps, %u broken\n",
+          s.bytes, s.good, s.damaged, s.dropped, s.log.records, s.trace.dumps, s.trace.broken);
+  return 0;
+}
+
+//------------host build of log.c, telemetry.c and trace.c------------
+static uint64_t Now;          // bus cycles
+#define THREADS 12
+static OSThreadType Threads[THREADS];
+static uint32_t ThreadCount;
+static tcbType Tcb;
+tcbType *RunPt = &Tcb;
+
+unsigned long OS_Time(void){ return (uint32_t)Now; }
+unsigned long OS_TimeDifference(unsigned long start, unsigned long stop){ return (uint32_t)(stop - start); }
+unsigned long OS_MsTime(void){ return (unsigned long)(Now/80000); }
+long StartCritical(void){ return 0; }
+void EndCritical(long sr){ (void)sr; }
+uint32_t UART_Write(const char *pt, uint32_t n){
+  return Tx_UARTFifo_PutN(pt, n);
+}
+uint32_t OS_Threads(OSThreadType *list, uint32_t max){
+  uint32_t n = ThreadCount < max ? ThreadCount : max;
+  memcpy(list, Threads, n*sizeof(OSThreadType));
+  return n;
+}
+
+#define WIRE_MAX    (1 << 24)
+#define CHAR_CYCLES 6944      // 10 bits at 115200 baud
+static uint8_t Wire[WIRE_MAX];
+static uint32_t WireCount;
+static uint64_t WireTime;     // the line is busy until then
+
+// UART0 sends what Tx_UARTFifo holds up to the time Now
+static void wire(void){
+  uint32_t n;
+  const char *pt;
+  while(Tx_UARTFifo_Size() && (WireTime + CHAR_CYCLES <= Now)){
+    pt = Tx_UARTFifo_Peek(&n);
+    if(WireCount < WIRE_MAX){
+      Wire[WireCount++] = *pt;
+    }
+    Tx_UARTFifo_Skip(1);
+    WireTime += CHAR_CYCLES;
+  }
+  if((Tx_UARTFifo_Size() == 0) && (WireTime < Now)){
+    WireTime = Now;           // idle line, the next byte starts when it is written
+  }
+}
+
+//------------test------------
+#define EXPECT_MAX (1 << 20)
+#define SNAP_MAX   (1 << 14)
+static RecordType Expect[EXPECT_MAX];   // records stored by the calls, cycles since LOG_BOOT
+static uint32_t Expects;
+static TeleGameType Games[SNAP_MAX];    // snapshots sent
+static TeleKernelType Kernels[SNAP_MAX];
+static uint32_t GamesSent, KernelsSent, ThreadsSent, ThreadsListed;
+static uint64_t Boot;                   // Now at Log_Init()
+static uint32_t Lfsr = 0x1234567;
+static int Failed;
+
+static uint32_t next(void){
+  Lfsr ^= Lfsr << 13;
+  Lfsr ^= Lfsr >> 17;
+  Lfsr ^= Lfsr << 5;
+  return Lfsr;
+}
+
+static void expect(int ok, const char *what){
+  if(!ok){
+    printf("  FAIL %s\n", what);
+    Failed++;
+  }
+}
+
+static double hostNs(void){
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec*1e9 + t.tv_nsec;
+}
+
+static int same(const RecordType *a, const RecordType *b){
+  return (a->id == b->id) && (a->args == b->args) && !memcmp(a->arg, b->arg, sizeof(a->arg)) &&
+         (a->cycles == b->cycles);
+}
+
+// one random call at time Now, kept in Expect[] if the ring took it
+static void call(void){
+  RecordType r;
+  uint32_t before = LogStats.records;
+  r.id = LOG_STATE + next()%(LOG_IDS - LOG_STATE);
+  r.args = next()%(LOG_ARGS + 1);
+  r.arg[0] = r.arg[1] = r.arg[2] = r.arg[3] = 0;
+  switch(r.args){
+    case 4: r.arg[3] = next();  // fall through
+    case 3: r.arg[2] = next();  // fall through
+    case 2: r.arg[1] = next();  // fall through
+    case 1: r.arg[0] = next();
+  }
+  switch(r.args){
+    case 0: Log0(r.id); break;
+    case 1: Log1(r.id, r.arg[0]); break;
+    case 2: Log2(r.id, r.arg[0], r.arg[1]); break;
+    case 3: Log3(r.id, r.arg[0], r.arg[1], r.arg[2]); break;
+    default: Log4(r.id, r.arg[0], r.arg[1], r.arg[2], r.arg[3]); break;
+  }
+  r.cycles = Now - Boot;
+  if((LogStats.records != before) && (Expects < EXPECT_MAX)){
+    Expect[Expects++] = r;
+  }
+}
+
+// the snapshots of the Telemetry thread in Main.c, random values
+static void snapshots(void){
+  TeleGameType g;
+  TeleKernelType k;
+  uint32_t i, ms = OS_MsTime();
+  uint32_t *w = (uint32_t *)&g;
+  for(i = 0; i < sizeof(g)/4; i++){
+    w[i] = next()%(i < 4 ? 4 : 1000);   // small numbers have COBS zeros to replace
+  }
+  g.ms = ms;
+  if(Telemetry_Send(TELE_GAME, &g, sizeof(g)) && (GamesSent < SNAP_MAX)){
+    Games[GamesSent++] = g;
+  }
+  w = (uint32_t *)&k;
+  for(i = 0; i < sizeof(k)/4; i++){
+    w[i] = next();
+  }
+  k.ms = ms;
+  if(Telemetry_Send(TELE_KERNEL, &k, sizeof(k)) && (KernelsSent < SNAP_MAX)){
+    Kernels[KernelsSent++] = k;
+  }
+  ThreadCount = 1 + next()%THREADS;
+  for(i = 0; i < ThreadCount; i++){
+    Threads[i].id = i;
+    Threads[i].state = next()%4;
+    Threads[i].priority = next()%6;
+    Threads[i].cell = next()%37;
+    Threads[i].sleepMs = next()%3 ? 0 : next()%1000;
+  }
+  if(Telemetry_Threads(ms)){
+    ThreadsSent++;
+    ThreadsListed += ThreadCount;
+  }
+}
+
+// every Log record and snapshot of a clean line, checked field by field
+static void clean(void){
+  static StreamType s;
+  DecoderType d;
+  RecordType r;
+  const uint8_t *p;
+  uint32_t i, j, e = 0, g = 0, k = 0, t = 0, listed = 0, lost = 0, times = 0, badTimes = 0, bad = 0;
+  memset(&s, 0, sizeof(s));
+  memset(&d, 0, sizeof(d));
+  for(i = 0; i < WireCount; i++){
+    if(feed(&s, Wire[i], 0) != 1) continue;
+    p = &s.body[3];
+    if(s.type == TELE_LOG){
+      for(j = 0; j < s.size; j++){
+        if(!decode(&d, p[j], &r)) continue;
+        if(r.id == LOG_TIME){
+          times++;
+          badTimes += r.arg[0] != (Boot + r.cycles)/80000;
+        }else if(r.id == LOG_LOST){
+          lost += r.arg[0];
+        }else if(r.id != LOG_BOOT){
+          bad += (e >= Expects) || !same(&r, &Expect[e]);
+          e++;
+        }
+      }
+    }else if(s.type == TELE_GAME){
+      bad += (g >= GamesSent) || memcmp(p, &Games[g], sizeof(TeleGameType));
+      g++;
+    }else if(s.type == TELE_KERNEL){
+      bad += (k >= KernelsSent) || memcmp(p, &Kernels[k], sizeof(TeleKernelType));
+      k++;
+    }else if(s.type == TELE_THREADS){
+      t++;
+      listed += (s.size - 4)/8;
+    }
+  }
+  printf("  clean line: %u Log records of the calls, %u LOG_TIME, %u lost told, %u game, %u kernel, %u threads frames\n",
+         e, times, lost, g, k, t);
+  expect((bad == 0) && (s.damaged == 0), "a record or snapshot differs");
+  expect(e == Expects, "Log records missing");
+  expect((times >= (Now - Boot)/80000/LOG_TIME_MS - 1) && (badTimes == 0), "LOG_TIME wrong");
+  expect(lost == LogStats.lost, "LOG_LOST does not add up");
+  expect((g == GamesSent) && (k == KernelsSent) && (t == ThreadsSent) && (listed == ThreadsListed),
+         "snapshots missing");
+  expect(s.dropped == TeleStats.dropped, "sequence gaps differ from the frames dropped");
+}
+
+// damage one byte in every `every`, each frame accepted must be one sent;
+// a damaged byte costs its frame, or two if it was the 0x00 between them
+static void noisy(uint32_t every){
+  static StreamType s, c;
+  static uint8_t bodies[1 << 24];
+  static uint32_t start[(1 << 17) + 1];   // where each clean frame's body is, by seq
+  uint32_t i, used = 0, frames = 0, damaged = 0, wrong = 0;
+  uint8_t byte;
+  memset(&c, 0, sizeof(c));
+  for(i = 0; i < WireCount; i++){
+    if((feed(&c, Wire[i], 0) == 1) && (c.seq < (1 << 17)) && (used + c.size + 5 <= sizeof(bodies))){
+      start[c.seq] = used;
+      memcpy(&bodies[used], c.body, c.size + 5);
+      used += c.size + 5;
+      start[c.seq + 1] = used;
+      frames = c.seq + 1;
+    }
+  }
+  memset(&s, 0, sizeof(s));
+  for(i = 0; i < WireCount; i++){
+    byte = Wire[i];
+    if(next()%every == 0){
+      byte ^= 1 + next()%255;
+      damaged++;
+    }
+    if((feed(&s, byte, 0) == 1) &&
+       ((s.seq >= frames) || (s.size + 5 != start[s.seq + 1] - start[s.seq]) ||
+        memcmp(s.body, &bodies[start[s.seq]], s.size + 5))){
+      wrong++;
+    }
+  }
+  printf("  one byte in %u damaged: %u bytes, %u of %u frames good, %u damaged, %u taken for wrong\n",
+         every, damaged, s.good, frames - TeleStats.dropped, s.damaged, wrong);
+  // a CRC-16 passes one frame in 65536 with random damage, more than one
+  // damaged byte in a frame is that; allow four times as many
+  expect(wrong <= 4*s.damaged/65536, "damaged frames passed the CRC");
+  expect(s.good + 2*damaged >= frames - TeleStats.dropped, "good frames lost on a noisy line");
+}
+
+// trace.c: events a scheduler and its interrupts would make, `before`
+// of them, a trigger, then more than the ring takes.  The dump must be
+// every event up to TRACE_EVENTS/2 after the trigger, at most
+// TRACE_EVENTS of them, so the trigger is in the middle of a full ring.
+#define SHADOW_MAX (4*TRACE_EVENTS)
+static uint32_t ShadowTime[SHADOW_MAX], ShadowEvent[SHADOW_MAX];   // events since recording started
+static uint32_t Shadows;
+static uint32_t DumpTime[2][TRACE_EVENTS], DumpEvent[2][TRACE_EVENTS], DumpEvents[2];
+
+static void shadow(uint32_t type, uint32_t thread, uint32_t arg){
+  if(Shadows < SHADOW_MAX){
+    ShadowTime[Shadows] = (uint32_t)Now;
+    ShadowEvent[Shadows++] = type | thread << 8 | arg << 16;
+  }
+}
+
+static void event(uint32_t type, uint32_t thread, uint32_t arg){
+  Now += 20 + next()%4000;
+  Trace_Event(type, thread, arg);
+  shadow(type, thread, arg);
+}
+
+static void traceRun(uint32_t number, uint32_t before){
+  static const uint8_t irq[] = { TRACE_IRQ_GPIOD, TRACE_IRQ_UART0, TRACE_IRQ_ADC0SS1,
+                                 TRACE_IRQ_TIMER1A, TRACE_IRQ_TIMER2A, TRACE_IRQ_TIMER4A };
+  uint8_t blocked[6] = { 0 };       // semaphore + 1 a thread spins on
+  uint32_t i, k, to, running = 0, first = 0;
+  Shadows = 0;
+  for(i = 0; i < before + TRACE_EVENTS; i++){
+    if(i == before){
+      Now += 100;
+      Tcb.id = running;
+      Trace_Trigger(number + 1000);
+      shadow(TRACE_TRIGGER, running, number + 1000);
+      first = Shadows - 1;
+    }else if(i == before + 10){
+      Trace_Trigger(1);             // pending, ignored
+    }
+    switch(next()%8){
+      case 0: case 1:
+        to = next()%6;
+        event(TRACE_SWITCH, running, to);
+        running = to;
+        if(blocked[to]){
+          event(TRACE_WAKE, to, blocked[to] - 1);
+          blocked[to] = 0;
+        }
+        break;
+      case 2:
+        k = irq[next()%sizeof(irq)];
+        event(TRACE_ISR_ENTER, running, k);
+        event(TRACE_ISR_EXIT, running, k);
+        break;
+      case 3:
+        if(blocked[running]) break;
+        k = 1 + next()%4;
+        event(TRACE_WAIT, running, k);
+        if(next()%2){
+          event(TRACE_BLOCK, running, k);
+          blocked[running] = k + 1;
+        }
+        break;
+      case 4: event(TRACE_SIGNAL, running, 1 + next()%4); break;
+      case 5: event(TRACE_SLEEP, running, next()%100); break;
+      case 6: event(TRACE_CREATE, running, 6 + next()%10); break;
+      default: event(TRACE_FLUSH, running, 0); break;
+    }
+  }
+  // the trigger and TRACE_EVENTS/2 - 1 events after it
+  DumpEvents[number] = first + TRACE_EVENTS/2 < TRACE_EVENTS ? first + TRACE_EVENTS/2 : TRACE_EVENTS;
+  first = first + TRACE_EVENTS/2 - DumpEvents[number];
+  memcpy(DumpTime[number], &ShadowTime[first], 4*DumpEvents[number]);
+  memcpy(DumpEvent[number], &ShadowEvent[first], 4*DumpEvents[number]);
+  while(TraceStats.dumps == number){  // the Telemetry thread, every 20 ms
+    Now += 20*80000;
+    Trace_Drain();
+    wire();
+  }
+  while(Tx_UARTFifo_Size()){
+    Now += CHAR_CYCLES;
+    wire();
+  }
+}
+
+static void traceTest(void){
+  static StreamType s;
+  OutputType o;
+  char *text, *pt;
+  size_t size;
+  uint32_t i, k, dumps = 0, bad = 0, slices = 0, negative = 0, depth = 0, unbalanced = 0;
+  double t;
+  Tx_UARTFifo_Init();
+  WireCount = 0;
+  WireTime = Now;
+  Trace_Init();
+  traceRun(0, 3*TRACE_EVENTS/2);      // the ring wrapped before the trigger
+  traceRun(1, 100);                   // not yet
+  memset(&s, 0, sizeof(s));
+  memset(&o, 0, sizeof(o));
+  o.json = open_memstream(&text, &size);
+  fprintf(o.json, "{\"traceEvents\":[");
+  for(i = 0; i < WireCount; i++){
+    if((feed(&s, Wire[i], &o) != 1) || (s.type != TELE_TRACE) || (s.trace.got != s.trace.events)) continue;
+    k = s.trace.dump;
+    bad += (k > 1) || (s.trace.events != DumpEvents[k]) || (s.trace.eventCycles != TraceStats.eventCycles) ||
+           memcmp(s.trace.time, DumpTime[k], 4*DumpEvents[k]) || memcmp(s.trace.event, DumpEvent[k], 4*DumpEvents[k]);
+    dumps++;
+  }
+  fprintf(o.json, "\n]}\n");
+  fclose(o.json);
+  // JSON: brackets balance outside strings, no slice ends before it starts
+  for(i = 0; i < size; i++){
+    if(text[i] == '"'){
+      while(text[++i] != '"');
+    }else if((text[i] == '{') || (text[i] == '[')){
+      depth++;
+    }else if((text[i] == '}') || (text[i] == ']')){
+      unbalanced += depth-- == 0;
+    }
+  }
+  for(pt = text; (pt = strstr(pt, "\"dur\":")); pt++){
+    slices++;
+    negative += pt[6] == '-';
+  }
+  printf("  trace: %u dumps of %u and %u events, %u frames, %u JSON events, %u slices\n",
+         dumps, DumpEvents[0], DumpEvents[1], s.good, o.jsonEvents, slices);
+  expect((dumps == 2) && (bad == 0) && (s.damaged == 0) && (TraceStats.dumps == 2), "a trace dump differs");
+  expect((DumpEvents[0] == TRACE_EVENTS) && (DumpEvents[1] < TRACE_EVENTS) &&
+         ((DumpEvent[0][TRACE_EVENTS/2]&0xFF) == TRACE_TRIGGER) &&
+         ((DumpEvent[1][DumpEvents[1] - TRACE_EVENTS/2]&0xFF) == TRACE_TRIGGER), "trigger not in place");
+  expect((depth == 0) && (unbalanced == 0) && (negative == 0) && (slices > 0), "trace JSON malformed");
+  free(text);
+  // cost on the host
+  Trace_Init();
+  t = -hostNs();
+  for(i = 0; i < 256000; i++){
+    Trace_Event(TRACE_SIGNAL, 3, i);
+  }
+  t += hostNs();
+  printf("  Trace_Event() on this computer: %.1f ns a call\n", t/256000);
+}
+
+static int test(uint32_t calls){
+  uint32_t i, k, n = 0;
+  uint64_t drained = 0, snapped = 0;
+  uint8_t g[sizeof(TeleGameType)];
+  double t;
+  Tx_UARTFifo_Init();
+  Now = Boot = 1000;
+  WireTime = Now;
+  Log_Init();
+  while(n < calls){
+    // a few calls, and a burst now and then faster than the line
+    k = (next()%32 == 0) ? 30 + next()%100 : next()%8;
+    for(i = 0; (i < k) && (n < calls); i++, n++){
+      call();
+      Now += 50 + next()%400;
+    }
+    Now += next()%(30*80000);       // up to 30 ms to the next calls
+    wire();
+    while(Now - drained >= 20*80000){   // the Telemetry thread, every 20 ms
+      drained = drained + 20*80000 > Now ? Now : drained + 20*80000;
+      Log_Drain();
+      if(drained - snapped >= 100*80000){
+        snapped = drained;
+        snapshots();
+      }
+      wire();
+    }
+  }
+  for(i = 0; i < 3; i++){           // the last records, then LOG_LOST
+    Now += 20*80000;
+    Log_Drain();
+    while(Tx_UARTFifo_Size()){
+      Now += CHAR_CYCLES;
+      wire();
+    }
+  }
+  printf("test: %u calls, %u stored, %u lost, ring peak %u of %d words\n",
+         n, LogStats.records, LogStats.lost, LogStats.maxUsed, LOG_SIZE);
+  printf("  %u frames, %u dropped, %u bytes in %.1f s, %.0f%% of 115200 baud\n", TeleStats.frames,
+         TeleStats.dropped, WireCount, (Now - Boot)/80e6, 100.0*WireCount*CHAR_CYCLES/(Now - Boot));
+  expect(WireCount < WIRE_MAX, "test too long for Wire[]");
+  expect(LogStats.lost > 0, "no burst filled the ring");
+  expect(TeleStats.bytes == WireCount, "bytes sent and on the line differ");
+  clean();
+  noisy(1000);
+  noisy(100);
+  // cost on the host
+  t = 0;
+  for(i = 0; i < 10000; i++){
+    Log_Init();
+    t -= hostNs();
+    for(k = 0; k < 64; k++){        // 256 words, the ring never fills
+      Log2(LOG_FRAME_DROP, k, i);
+    }
+    t += hostNs();
+  }
+  printf("  Log2() on this computer: %.1f ns a call\n", t/640000);
+  memset(g, 7, sizeof(g));
+  t = 0;
+  for(i = 0; i < 10000; i++){
+    Tx_UARTFifo_Init();
+    t -= hostNs();
+    Telemetry_Send(TELE_GAME, g, sizeof(g));
+    t += hostNs();
+  }
+  printf("  TELE_GAME frame on this computer: %.1f ns\n", t/10000);
+  traceTest();
+  printf("%d checks failed\n", Failed);
+  return Failed != 0;
+}
+
+int main(int argc, char **argv){
+  int i;
+  const char *prefix = 0, *trace = 0;
+  uint32_t calls = 200000;
+  for(i = 1; i < argc; i++){
+    if(!strcmp(argv[i], "-csv") && (i + 1 < argc)){
+      prefix = argv[++i];
+    }else if(!strcmp(argv[i], "-trace") && (i + 1 < argc)){
+      trace = argv[++i];
+    }else if(!strcmp(argv[i], "-n") && (i + 1 < argc)){
+      calls = strtoul(argv[++i], 0, 0);
+    }else if(!strcmp(argv[i], "-test")){
+      return test(calls);
+    }else{
+      return decodeFile(argv[i], prefix, trace);
+    }
+  }
+  fprintf(stderr, "usage: %s [-csv prefix] [-trace file.json] file|device|-\n       %s -test [-n calls]\n", argv[0], argv[0]);
+  return 1;
+}
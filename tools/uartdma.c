@@ -0,0 +1,266 @@
+// uartdma.c
+// Host test of the uDMA UART driver: UART.c and uDMA.c run unchanged
+// against the model of UART0 and uDMA in UARTSim.c, with a computer on
+// the other end of the line.
+//   tx     UART_OutChar, UART_OutString and UART_Write at random, with
+//          pauses; every byte goes out once, in order, and the line
+//          never idles while Tx_UARTFifo holds data
+//   rx     bursts of 1 to 300 bytes with 0 to 40 idle bits between; every
+//          byte arrives once, in order, and the last byte before a quiet
+//          line reaches UART_Read() within 34 bit times (32 for the
+//          receive time-out, then the reader's poll)
+//   echo   the computer sends without a gap, the board echoes what it reads
+//   slow   a reader slower than the line: received, dropped and overrun
+//          bytes must add up to what was sent
+// Then the interrupt rate and an estimate of the CPU load at 115200 baud
+// in each direction, next to the interrupt driven UART.c this replaced.
+//
+// build: gcc -std=gnu99 -O2 -DUART_SIM -I. -o uartdma tools/uartdma.c UART.c UART_FIFO.c uDMA.c UARTSim.c
+// usage: ./uartdma [-n bytes]
+// Exit status 1 if a check fails.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "UART.h"
+#include "UARTSim.h"
+
+// cycles of the Cortex-M4 at 80 MHz assumed for the load estimate
+#define IRQ_CYCLES      120   // entry, exit and the handler's own work per interrupt
+#define COPY_CYCLES     2     // per byte a full half moves into Rx_UARTFifo
+#define DR_CYCLES       12    // per byte read from UART0_DR_R, the ring put included
+// the UART.c interrupt driven through the FIFO.c rings before uDMA:
+// one interrupt per 2 bytes received (RX 1/8) and per 14 sent (TX 1/8
+// refilled to 16), each byte moved through UART0_DR_R and a semaphore
+#define OLD_BYTE_CYCLES 45
+#define OLD_RX_PER_IRQ  2
+#define OLD_TX_PER_IRQ  14
+
+long StartCritical(void){ return 0; }
+void EndCritical(long sr){ (void)sr; }
+
+// a waiting thread comes back one bit time later
+void OS_Suspend(void){
+  UARTSim_Run(UARTSim_BitCycles());
+}
+
+static uint32_t Bytes = 200000;
+static uint8_t *Data;
+static int Failed;
+static uint32_t Lfsr = 0x2545F491;
+
+static uint32_t next(void){
+  Lfsr ^= Lfsr << 13;
+  Lfsr ^= Lfsr >> 17;
+  Lfsr ^= Lfsr << 5;
+  return Lfsr;
+}
+
+static void check(int ok, const char *name, const char *what){
+  if(!ok){
+    printf("  FAIL %s: %s\n", name, what);
+    Failed++;
+  }
+}
+
+static void start(void){
+  uint32_t i;
+  UARTSim_Reset();
+  memset(&UARTStats, 0, sizeof(UARTStats));
+  UART_Init();
+  for(i = 0; i < Bytes; i++){
+    Data[i] = 1 + next()%255;           // no 0, UART_OutString() sends them too
+  }
+}
+
+static double seconds(void){
+  return (double)UARTSimStats.cycles/SIM_CLOCK;
+}
+
+static void load(const char *name, double rxBytes){
+  double s = seconds();
+  double irq = UARTStats.interrupts/s;
+  double cycles = UARTStats.interrupts*(double)IRQ_CYCLES + (rxBytes - UARTSimStats.cpuRx)*COPY_CYCLES +
+                  UARTSimStats.cpuRx*(double)DR_CYCLES;
+  printf("  %s: %.0f bytes/s, %.0f interrupts/s, CPU %.2f%% (estimate)\n", name,
+         (UARTSimStats.dmaTx + UARTSimStats.dmaRx + UARTSimStats.cpuRx)/s, irq, 100*cycles/s/SIM_CLOCK);
+}
+
+static void oldLoad(void){
+  double rate = SIM_CLOCK/(double)UARTSim_CharCycles();      // bytes per second at full line rate
+  double rx = rate/OLD_RX_PER_IRQ, tx = rate/OLD_TX_PER_IRQ;
+  printf("  before uDMA: receive %.0f interrupts/s, CPU %.2f%%; send %.0f interrupts/s, CPU %.2f%% (estimate)\n",
+         rx, 100*(rx*IRQ_CYCLES + rate*OLD_BYTE_CYCLES)/SIM_CLOCK,
+         tx, 100*(tx*IRQ_CYCLES + rate*OLD_BYTE_CYCLES)/SIM_CLOCK);
+}
+
+//------------tx------------
+static void tx(void){
+  char text[101];
+  uint32_t i = 0, k, n;
+  uint64_t gap, gapMin, gapMax;
+  const uint8_t *out;
+  const uint64_t *times;
+  start();
+  while(i < Bytes){
+    k = 1 + next()%100;
+    if(k > Bytes - i) k = Bytes - i;
+    switch(next()%4){
+      case 0:
+        UART_OutChar(Data[i++]);
+        break;
+      case 1:
+        memcpy(text, &Data[i], k);
+        text[k] = 0;
+        UART_OutString(text);
+        i += k;
+        break;
+      case 2:
+        n = UART_Write((const char *)&Data[i], k);
+        if(n == 0){
+          OS_Suspend();
+        }
+        i += n;
+        break;
+      default:
+        UARTSim_Run(next()%(2*UARTSim_CharCycles()));      // the thread does something else
+        break;
+    }
+  }
+  while(UARTSim_Received(&n, 0), n < Bytes){
+    UARTSim_Run(UARTSim_CharCycles());
+  }
+  out = UARTSim_Received(&n, &times);
+  check(memcmp(out, Data, Bytes) == 0, "tx", "bytes sent differ");
+  // back to back, each stop bit ends one character time after the last
+  for(i = 1, gapMin = ~0ull, gapMax = 0; i < Bytes; i++){
+    gap = times[i] - times[i - 1];
+    if(gap < gapMin) gapMin = gap;
+    if(gap > gapMax) gapMax = gap;
+  }
+  printf("tx: %u bytes, %u transfers, %llu to %llu cycles from one stop bit to the next, %u errors\n",
+         Bytes, UARTStats.txBlocks, (unsigned long long)gapMin, (unsigned long long)gapMax,
+         UARTSimStats.errors);
+  check(gapMax == gapMin, "tx", "the line went idle with data waiting");
+  check(UARTSimStats.errors == 0, "tx", "UARTSim found a driver mistake");
+  load("send at line rate", 0);
+}
+
+//------------rx------------
+static void rx(void){
+  static uint8_t quiet[1 << 20];        // a quiet line follows the byte
+  uint8_t buffer[64];
+  uint32_t sent = 0, got = 0, k, gap, i, n, ends = 0;
+  uint64_t latency, worst = 0;
+  start();
+  memset(quiet, 0, sizeof(quiet));
+  gap = 0;
+  while(sent < Bytes){
+    k = 1 + next()%300;
+    if(k > Bytes - sent) k = Bytes - sent;
+    UARTSim_Send(&Data[sent], k, gap);
+    sent += k;
+    gap = next()%41;
+    if(sent < (1 << 20)){
+      quiet[sent - 1] = (gap >= 32) || (sent == Bytes);
+    }
+  }
+  while((got < Bytes) && (seconds() < 2.0*Bytes*UARTSim_CharCycles()/SIM_CLOCK + 1)){
+    n = UART_Read((char *)buffer, 1 + next()%64);
+    if(n == 0){
+      OS_Suspend();
+      continue;
+    }
+    for(i = 0; i < n; i++, got++){
+      if((got < Bytes) && (buffer[i] != Data[got])){
+        check(0, "rx", "byte received differs");
+        got = Bytes;
+        break;
+      }
+      if((got < (1 << 20)) && quiet[got]){
+        latency = UARTSimStats.cycles - UARTSim_Arrived(got);
+        if(latency > worst) worst = latency;
+        ends++;
+      }
+    }
+  }
+  printf("rx: %u of %u bytes, %u halves, %u time-outs, %u read by the CPU, %u dropped, %u overruns\n",
+         got, Bytes, UARTStats.rxBlocks, UARTStats.rxIdle, UARTSimStats.cpuRx, UARTStats.rxDropped,
+         UARTSimStats.overruns);
+  printf("  last byte before a quiet line: %u of them, latest %.1f bit times after its stop bit\n",
+         ends, (double)worst/UARTSim_BitCycles());
+  check(got == Bytes, "rx", "bytes missing");
+  check(worst <= 34*(uint64_t)UARTSim_BitCycles(), "rx", "a burst waited past the time-out");
+  check((UARTStats.rxDropped == 0) && (UARTSimStats.overruns == 0), "rx", "bytes lost");
+  check(UARTSimStats.errors == 0, "rx", "UARTSim found a driver mistake");
+  load("receive in bursts", got);
+}
+
+//------------echo------------
+static void echo(void){
+  char buffer[64];
+  uint32_t n, k, i, got = 0;
+  const uint8_t *out;
+  start();
+  UARTSim_Send(Data, Bytes, 0);
+  while((UARTSim_Received(&n, 0), n < Bytes) && (seconds() < 3.0*Bytes*UARTSim_CharCycles()/SIM_CLOCK + 1)){
+    n = UART_Read(buffer, sizeof(buffer));
+    if(n == 0){
+      OS_Suspend();
+      continue;
+    }
+    got += n;
+    for(i = 0; i < n; i += k){
+      k = UART_Write(&buffer[i], n - i);
+      if(k == 0){
+        OS_Suspend();
+      }
+    }
+  }
+  out = UARTSim_Received(&n, 0);
+  printf("echo: %u bytes each way in %.3f s (%.3f s at line rate), %u interrupts\n", n, seconds(),
+         (double)Bytes*UARTSim_CharCycles()/SIM_CLOCK, UARTStats.interrupts);
+  check((n == Bytes) && (memcmp(out, Data, Bytes) == 0), "echo", "bytes echoed differ");
+  check((UARTStats.rxDropped == 0) && (UARTSimStats.overruns == 0), "echo", "bytes lost");
+  check(UARTSimStats.errors == 0, "echo", "UARTSim found a driver mistake");
+  load("receive and send at line rate", got);
+}
+
+//------------slow------------
+static void slow(void){
+  char buffer[100];
+  uint32_t sent = Bytes < 20000 ? Bytes : 20000, got = 0, n;
+  uint64_t end;
+  start();
+  UARTSim_Send(Data, sent, 0);
+  end = (uint64_t)(sent + 100)*UARTSim_CharCycles();
+  while(UARTSimStats.cycles < end){
+    UARTSim_Run(SIM_CLOCK/50);          // 20 ms
+    got += UART_Read(buffer, sizeof(buffer));
+  }
+  while((n = UART_Read(buffer, sizeof(buffer))) != 0){
+    got += n;
+  }
+  printf("slow: %u sent, %u read, %u dropped, %u overruns\n", sent, got, UARTStats.rxDropped,
+         UARTSimStats.overruns);
+  check(got + UARTStats.rxDropped + UARTSimStats.overruns == sent, "slow", "bytes unaccounted for");
+  check(UARTStats.rxDropped > 0, "slow", "a slow reader dropped nothing");
+}
+
+int main(int argc, char **argv){
+  if((argc == 3) && !strcmp(argv[1], "-n")){
+    Bytes = strtoul(argv[2], 0, 0);
+  }
+  if(Bytes < 1000) Bytes = 1000;
+  if(Bytes > (1 << 22)) Bytes = 1 << 22;
+  Data = malloc(Bytes);
+  tx();
+  rx();
+  echo();
+  slow();
+  printf("CPU load at 115200 baud:\n");
+  oldLoad();
+  printf("%d checks failed\n", Failed);
+  return Failed != 0;
+}
@@ -0,0 +1,345 @@
+// wavetest.c
+// Host test of the sample mixer: wave.c and uDMA.c run unchanged
+// against the model of Wide Timer 0A, uDMA channel 10 and PWM1 in
+// WaveSim.c, which logs the duty cycle of every sample the buzzer plays.
+//   init     silence at the middle duty, one sample per 5000 cycles,
+//            one interrupt per block, uDMA never short of a sample
+//   sine     a 1 kHz wavetable tone: sample for sample what the mixer
+//            should give, starting on the second block after the call,
+//            100 ms long, and 99.9 % of its power at 1 kHz
+//   mix      the square voice, a sine and an 8-bit recording at half
+//            its rate playing together, clipped where they add up
+//   voices   a sound with every voice busy is refused; Wave_Stop()
+//            leaves the square voice; a recording ends by itself
+//   late     interrupts held off for 10 ms: uDMA runs dry, the mixer
+//            counts an underrun and the sound goes on
+// The expected waveform comes from mixing the same voices here, in
+// 64-bit arithmetic, from the definition in wave.h.  Then the CPU load
+// of mixing, at 1 to WAVE_VOICES voices.
+//
+// build: gcc -std=gnu99 -O2 -DWAVE_SIM -I. -o wavetest tools/wavetest.c wave.c uDMA.c WaveSim.c -lm
+// usage: ./wavetest [-o file.csv]   the duty cycles of the mix test, one per line
+// Exit status 1 if a check fails.
+
+#define _GNU_SOURCE
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "tm4c123gh6pm.h"
+#include "WaveSim.h"
+#include "wave.h"
+
+// cycles of the Cortex-M4 at 80 MHz assumed for the load estimate
+#define VOICE_CYCLES 9        // a sample of one voice: load, scale, add, step, wrap test
+#define OUT_CYCLES   8        // a sample out: shift, clip, scale, store, clear
+#define IRQ_CYCLES   120      // entry, exit, uDMA acknowledge and re-arm per block
+
+#define PERIOD   (SIM_CLOCK/WAVE_RATE)
+#define MS       (SIM_CLOCK/1000)
+#define SILENCE  (1 + ((2048*(WAVE_LOAD - 1)) >> 12))
+
+static int Failed;
+
+long StartCritical(void){ return 0; }
+void EndCritical(long sr){ (void)sr; }
+
+// host nanoseconds, so WaveStats.mixCycles is what a block costs here
+unsigned long OS_Time(void){
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (unsigned long)(t.tv_sec*1000000000ull + t.tv_nsec);
+}
+unsigned long OS_TimeDifference(unsigned long start, unsigned long stop){
+  return stop - start;
+}
+
+static void expect(int ok, const char *what){
+  if(!ok){
+    printf("  FAIL %s\n", what);
+    Failed++;
+  }
+}
+
+//------------the mix expected------------
+typedef struct {
+  const WaveSound *sound;
+  uint64_t start, end;        // samples it plays, end excluded
+  double step;                // source samples per sample out
+  int loop;
+  int32_t gain;
+} RefVoice;
+
+static RefVoice Ref[8];
+static uint32_t RefCount;
+
+static int32_t source(const WaveSound *s, uint32_t i){
+  return s->bits == 8 ? ((int32_t)((const uint8_t *)s->data)[i] - 128) << 4 :
+                        (int32_t)((const uint16_t *)s->data)[i] - 2048;
+}
+
+// sample k of voice v, 0 outside it; the phase in 16.16 as wave.h says
+static int32_t refSample(const RefVoice *v, uint64_t k){
+  uint64_t n, phase, step = (uint64_t)(v->step*65536.0), end = (uint64_t)v->sound->length << 16;
+  if((k < v->start) || (k >= v->end)) return 0;
+  n = k - v->start;
+  phase = n*step;
+  if(v->loop){
+    phase %= end;
+  }else if(phase >= end){
+    return 0;
+  }
+  return source(v->sound, (uint32_t)(phase >> 16))*v->gain;
+}
+
+static uint32_t refDuty(uint64_t k, uint32_t *clipped){
+  int64_t sum = 0, x;
+  uint32_t i;
+  for(i = 0; i < RefCount; i++){
+    sum += refSample(&Ref[i], k);
+  }
+  x = sum >> 8;
+  if((x > 2047) || (x < -2048)){
+    (*clipped)++;
+    x = x > 0 ? 2047 : -2048;
+  }
+  return 1 + (uint32_t)(((x + 2048)*(WAVE_LOAD - 1)) >> 12);
+}
+
+// first sample a sound started now plays: uDMA is on block j, the
+// interrupt at its end mixes block j+2
+static uint64_t nextStart(void){
+  return (WaveSimStats.timeouts/WAVE_BLOCK + 2)*(uint64_t)WAVE_BLOCK;
+}
+
+static RefVoice *refAdd(const WaveSound *s, double step, int loop, uint32_t ms, uint32_t gain){
+  RefVoice *v = &Ref[RefCount++];
+  v->sound = s;
+  v->start = nextStart();
+  v->step = step;
+  v->loop = loop;
+  v->end = loop ? v->start + ms*(WAVE_RATE/1000) : (uint64_t)-1;
+  v->gain = gain;
+  return v;
+}
+
+// the log from sample first to last against the voices in Ref
+static void compare(const char *name, uint64_t first, uint64_t last){
+  uint32_t n, clipped = 0, wrong = 0;
+  const uint32_t *duty = WaveSim_Samples(&n);
+  uint64_t k;
+  char what[120];
+  if(last > n) last = n;
+  for(k = first; k < last; k++){
+    uint32_t want = refDuty(k, &clipped);
+    if(duty[k] != want){
+      if(wrong++ < 3){
+        printf("  %s, sample %llu: duty %u, not %u\n", name, (unsigned long long)k, duty[k], want);
+      }
+    }
+  }
+  snprintf(what, sizeof(what), "%s: %u of %llu samples differ", name, wrong,
+           (unsigned long long)(last - first));
+  expect(wrong == 0, what);
+}
+
+// the level of a duty cycle, -2048 to 2047
+static double level(uint32_t duty){
+  return (double)(duty - 1)*4096/(WAVE_LOAD - 1) - 2048;
+}
+
+// share of the power of samples first to last at frequency f
+static double purity(uint64_t first, uint64_t last, double f, double *amplitude){
+  uint32_t n;
+  const uint32_t *duty = WaveSim_Samples(&n);
+  double re = 0, im = 0, power = 0, x;
+  uint64_t k;
+  for(k = first; k < last; k++){
+    x = level(duty[k]);
+    re += x*cos(2*M_PI*f*k/WAVE_RATE);
+    im += x*sin(2*M_PI*f*k/WAVE_RATE);
+    power += x*x;
+  }
+  *amplitude = 2*sqrt(re*re + im*im)/(last - first);
+  return (*amplitude)*(*amplitude)/2/(power/(last - first));
+}
+
+//------------tests------------
+static void init(void){
+  uint32_t n, i, quiet = 1;
+  const uint32_t *duty;
+  WaveSim_Reset();
+  Wave_Init();
+  WaveSim_Run(20*MS);
+  duty = WaveSim_Samples(&n);
+  for(i = 0; i < n; i++){
+    quiet &= duty[i] == SILENCE;
+  }
+  expect((n == 20*WAVE_RATE/1000) && quiet, "silence after Wave_Init");
+  expect((WaveSimStats.interrupts == n/WAVE_BLOCK) && (WaveStats.blocks == n/WAVE_BLOCK) &&
+         (WaveSimStats.starved == 0), "one interrupt and one block mixed per block played");
+  expect((WTIMER0_TAILR_R == PERIOD - 1) && (PWM1_3_LOAD_R == WAVE_LOAD) &&
+         ((NVIC_PRI23_R&0x00E00000) == WAVE_PRIORITY << 21), "sample rate, carrier or priority");
+}
+
+static void sine(void){
+  uint64_t first, end;
+  double amplitude, share;
+  char what[100];
+  WaveSim_Run(rand()%(8*PERIOD));
+  RefCount = 0;
+  refAdd(&WaveSine, 1000.0*64/WAVE_RATE, 1, 100, WAVE_GAIN);
+  first = nextStart() - 3*WAVE_BLOCK;
+  expect(Wave_Tone(&WaveSine, 1000, 100, WAVE_GAIN), "Wave_Tone refused");
+  WaveSim_Run(130*MS);
+  end = Ref[0].end;
+  compare("1 kHz sine", first, WaveSimStats.timeouts);
+  share = purity(Ref[0].start, end, 1000, &amplitude);
+  snprintf(what, sizeof(what), "1 kHz sine: amplitude %.1f, %.4f of the power at 1 kHz", amplitude, share);
+  printf("%s\n", what);
+  expect((fabs(amplitude - 2047) < 20) && (share > 0.999), what);
+  expect(Wave_Busy() == 0, "the tone still plays after 100 ms");
+}
+
+static const uint16_t SquareTable[2] = { 4095, 1 };  // voice 0 of wave.c
+static const WaveSound Square = { SquareTable, 2, 0, 12 };
+static uint8_t Chirp[4000];           // 0.5 s at 8 kHz, 8 bits
+static const WaveSound ChirpSound = { Chirp, sizeof(Chirp), 8000, 8 };
+
+static void mix(const char *csv){
+  uint64_t first, k;
+  uint32_t i, n;
+  const uint32_t *duty;
+  FILE *f;
+  for(i = 0; i < sizeof(Chirp); i++){   // 200 Hz rising to 1 kHz
+    Chirp[i] = 128 + 110*sin(2*M_PI*(200.0*i/8000 + 800.0*i*i/(2*8000.0*sizeof(Chirp))));
+  }
+  WaveSim_Run(rand()%(8*PERIOD));
+  RefCount = 0;
+  first = nextStart();
+  Wave_Square(1568);
+  refAdd(&Square, 1568.0*2/WAVE_RATE, 1, 0, WAVE_GAIN/2)->end = (uint64_t)-1;
+  WaveSim_Run(7*MS + 77);
+  expect(Wave_Tone(&WaveSine, 440, 300, WAVE_GAIN/2), "Wave_Tone refused");
+  refAdd(&WaveSine, 440.0*64/WAVE_RATE, 1, 300, WAVE_GAIN/2);
+  WaveSim_Run(50*MS + 1234);
+  expect(Wave_Sample(&ChirpSound, WAVE_GAIN), "Wave_Sample refused");
+  refAdd(&ChirpSound, 0.5, 0, 0, WAVE_GAIN);
+  WaveSim_Run(600*MS);
+  Wave_Square(0);
+  Ref[0].end = nextStart();
+  WaveSim_Run(20*MS);
+  compare("square, sine and recording", first, WaveSimStats.timeouts);
+  expect(WaveStats.clipped > 0, "full scale exceeded but nothing clipped");
+  printf("square, sine and recording: %u samples clipped\n", WaveStats.clipped);
+  expect(Wave_Busy() == 0, "voices still play after the mix");
+  if(csv && (f = fopen(csv, "w"))){
+    duty = WaveSim_Samples(&n);
+    fprintf(f, "sample,duty,level\n");
+    for(k = first; k < n; k++){
+      fprintf(f, "%llu,%u,%.1f\n", (unsigned long long)k, duty[k], level(duty[k]));
+    }
+    fclose(f);
+    printf("wrote %s\n", csv);
+  }
+}
+
+static void voices(void){
+  uint32_t dropped = WaveStats.dropped;
+  uint64_t at;
+  uint32_t n, i, quiet = 1;
+  const uint32_t *duty;
+  Wave_Square(880);
+  for(i = 1; i < WAVE_VOICES; i++){
+    expect(Wave_Tone(&WaveSine, 200*i, 1000, WAVE_GAIN/8), "Wave_Tone refused with a voice free");
+  }
+  expect(!Wave_Tone(&WaveSine, 300, 10, WAVE_GAIN) && !Wave_Sample(&ChirpSound, WAVE_GAIN) &&
+         (WaveStats.dropped == dropped + 2), "sounds with every voice busy");
+  WaveSim_Run(20*MS);
+  Wave_Stop();
+  WaveSim_Run(20*MS);
+  expect(Wave_Busy() == 1, "Wave_Stop left more or less than the square voice");
+  Wave_Square(0);
+  at = nextStart();
+  WaveSim_Run(20*MS);
+  duty = WaveSim_Samples(&n);
+  for(i = at; i < n; i++){
+    quiet &= duty[i] == SILENCE;
+  }
+  expect(quiet && (Wave_Busy() == 0), "silence after Wave_Square(0)");
+  expect(!Wave_Tone(&WaveSine, WAVE_RATE/2, 10, WAVE_GAIN), "a tone at WAVE_RATE/2");
+}
+
+static void late(void){
+  uint32_t underruns = WaveStats.underruns, starved = WaveSimStats.starved, n;
+  uint64_t call, first;
+  const uint32_t *duty;
+  NVIC_EN2_R = 0;                       // as if a higher priority held the CPU
+  WaveSim_Run(10*MS);
+  NVIC_EN2_R = 0x40000000;
+  expect(WaveSimStats.starved > starved, "uDMA did not run dry");
+  WaveSim_Run(PERIOD);
+  expect(WaveStats.underruns == underruns + 1, "the underrun not counted");
+  // the blocks are no longer where they were, find the tone in the log:
+  // its first sample is the middle of the sine, the second is not
+  call = WaveSimStats.timeouts;
+  RefCount = 0;
+  expect(Wave_Tone(&WaveSine, 500, 50, WAVE_GAIN), "Wave_Tone refused after the underrun");
+  WaveSim_Run(80*MS);
+  duty = WaveSim_Samples(&n);
+  for(first = call; (first < n) && (duty[first] == SILENCE); first++){}
+  first--;
+  expect(first - call <= 2*WAVE_BLOCK, "the tone after the underrun late");
+  refAdd(&WaveSine, 500.0*64/WAVE_RATE, 1, 50, WAVE_GAIN);
+  Ref[0].start = first;
+  Ref[0].end = first + 50*(WAVE_RATE/1000);
+  compare("500 Hz sine after the underrun", call, n);
+}
+
+// the mixer's cost: host time per block, and what it comes to on the board
+static void load(void){
+  uint32_t v, i, blocks;
+  double ns, cycles;
+  for(v = 1; v <= WAVE_VOICES; v++){
+    Wave_Init();
+    if(v > 1) Wave_Square(440);
+    for(i = 1; i < v; i++){
+      Wave_Tone(&WaveSine, 300 + 100*i, 60000, WAVE_GAIN/4);
+    }
+    if(v == 1) Wave_Square(440);
+    WaveStats.mixMax = 0;
+    blocks = WaveStats.blocks;
+    ns = 0;
+    for(i = 0; i < 200; i++){
+      WaveSim_Run(WAVE_BLOCK*PERIOD);
+      ns += WaveStats.mixCycles;
+    }
+    blocks = WaveStats.blocks - blocks;
+    cycles = IRQ_CYCLES + WAVE_BLOCK*(OUT_CYCLES + v*VOICE_CYCLES);
+    printf("%u voice%s: %.0f ns a block on the host; estimate %.0f cycles a block, %.2f %% of the CPU\n",
+           v, v > 1 ? "s" : " ", ns/blocks, cycles, 100.0*cycles*WAVE_RATE/WAVE_BLOCK/SIM_CLOCK);
+  }
+}
+
+int main(int argc, char **argv){
+  const char *csv = 0;
+  if((argc == 3) && !strcmp(argv[1], "-o")){
+    csv = argv[2];
+  }
+  srand(50);
+  init();
+  sine();
+  mix(csv);
+  voices();
+  late();
+  load();
+  printf("%u blocks, %u underruns, %u clipped, %u dropped; model: %u samples, %u interrupts, "
+         "%u starved, %u errors\n", WaveStats.blocks, WaveStats.underruns, WaveStats.clipped,
+         WaveStats.dropped, WaveSimStats.timeouts, WaveSimStats.interrupts, WaveSimStats.starved,
+         WaveSimStats.errors);
+  expect(WaveSimStats.errors == 0, "errors found by the model");
+  printf("%d checks failed\n", Failed);
+  return Failed != 0;
+}
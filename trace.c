@@ -0,0 +1,113 @@
+// trace.c
+// Kernel event trace into TraceRing, dumped to UART0 in telemetry
+// frames, see trace.h.
+
+#include <stdint.h>
+#include "os.h"
+#include "telemetry.h"
+#include "trace.h"
+
+long StartCritical(void);    // previous I bit, disable interrupts
+void EndCritical(long sr);    // restore I bit to previous value
+
+#define TRACE_BENCH 16                // events timed by Trace_Init()
+
+typedef struct {
+  uint32_t time;                      // OS_Time()
+  uint32_t event;                     // type | thread << 8 | arg << 16
+} TraceEventType;
+
+typedef struct {
+  TraceHeaderType header;
+  TraceEventType events[TRACE_FRAME_EVENTS];
+} TraceFrameType;
+
+TraceStatsType TraceStats;
+static TraceEventType TraceRing[TRACE_EVENTS];
+static volatile uint32_t TracePutI;   // events since recording started
+static volatile uint32_t TraceAfter;  // events left to record after a trigger, 0 if none
+static volatile int TraceFrozen;
+static uint32_t TraceSent;            // events of the frozen ring sent
+static TraceFrameType TraceFrame;     // the payload Trace_Drain() sends
+
+void Trace_Event(uint32_t type, uint32_t thread, uint32_t arg){
+  TraceEventType *e;
+  long sr = StartCritical();
+  if(TraceFrozen){
+    EndCritical(sr);
+    return;
+  }
+  if(thread == TRACE_CURRENT){
+    thread = RunPt ? RunPt->id : TRACE_NO_THREAD;
+  }
+  e = &TraceRing[TracePutI&(TRACE_EVENTS - 1)];
+  e->time = OS_Time();
+  e->event = type | (thread << 8) | (arg << 16);
+  TracePutI++;
+  if(TraceAfter && (--TraceAfter == 0)){
+    TraceFrozen = 1;
+  }
+  EndCritical(sr);
+}
+
+void Trace_Trigger(uint32_t arg){
+  long sr = StartCritical();
+  if(!TraceFrozen && !TraceAfter){
+    TraceAfter = TRACE_EVENTS/2;
+    Trace_Event(TRACE_TRIGGER, TRACE_CURRENT, arg);
+  }
+  EndCritical(sr);
+}
+
+static void restart(void){
+  long sr = StartCritical();
+  TracePutI = 0;
+  TraceAfter = 0;
+  TraceSent = 0;
+  TraceFrozen = 0;
+  EndCritical(sr);
+}
+
+void Trace_Init(void){
+  uint32_t i, t;
+  restart();
+  t = OS_Time();
+  for(i = 0; i < TRACE_BENCH; i++){
+    Trace_Event(TRACE_TRIGGER, TRACE_NO_THREAD, i);
+  }
+  t = OS_TimeDifference(t, OS_Time());
+  TraceStats.events = TraceStats.dumps = 0;
+  TraceStats.eventCycles = t/TRACE_BENCH;   // OS_Time() counts bus cycles
+  restart();                        // forget the timed events
+}
+
+uint32_t Trace_Drain(void){
+  uint32_t i, k, n, first, sent = 0;
+  if(!TraceFrozen){
+    return 0;
+  }
+  n = TracePutI < TRACE_EVENTS ? TracePutI : TRACE_EVENTS;
+  first = TracePutI - n;            // the oldest event still in the ring
+  while(TraceSent < n){
+    k = n - TraceSent < TRACE_FRAME_EVENTS ? n - TraceSent : TRACE_FRAME_EVENTS;
+    if(!Telemetry_Fits(sizeof(TraceHeaderType) + 8*k)){
+      break;
+    }
+    TraceFrame.header.first = TraceSent;
+    TraceFrame.header.dump = TraceStats.dumps;
+    TraceFrame.header.events = n;
+    TraceFrame.header.eventCycles = TraceStats.eventCycles;
+    for(i = 0; i < k; i++){
+      TraceFrame.events[i] = TraceRing[(first + TraceSent + i)&(TRACE_EVENTS - 1)];
+    }
+    Telemetry_Send(TELE_TRACE, &TraceFrame, sizeof(TraceHeaderType) + 8*k);
+    TraceSent += k;
+    sent += k;
+  }
+  if(TraceSent == n){
+    TraceStats.events += n;
+    TraceStats.dumps++;
+    restart();
+  }
+  return sent;
+}
@@ -0,0 +1,118 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+// Kernel event trace.  The kernel records context switches, semaphore
+// waits and signals, interrupt entry and exit and thread creation and
+// kill into TraceRing, each with OS_Time(); the ring keeps the newest
+// TRACE_EVENTS of them.  Trace_Trigger() freezes the ring once half of
+// it holds what came after the trigger, Trace_Drain() sends the frozen
+// ring in TELE_TRACE frames (telemetry.h) and recording starts over.
+// tools/teledecode.c -trace writes the dumps as Chrome trace JSON, for
+// chrome://tracing or ui.perfetto.dev.
+//
+// An event is two words, OS_Time() and type | thread << 8 | arg << 16,
+// stored with interrupts disabled for a few instructions: no loop, no
+// wait, the same cost for every event.  Trace_Init() measures it into
+// TraceStats.eventCycles.  A dump of 512 events takes 0.4 s of UART0.
+//
+// TRACE_ON 0 leaves the calls out of the kernel; host builds of the
+// drivers (HOST_SIM, UART_SIM, SOUND_SIM, WAVE_SIM) have no trace.c
+// and leave them out too.
+
+#ifndef TRACE_ON
+#if defined(HOST_SIM) || defined(UART_SIM) || defined(SOUND_SIM) || defined(WAVE_SIM)
+#define TRACE_ON 0
+#else
+#define TRACE_ON 1
+#endif
+#endif
+
+#define TRACE_EVENTS 512      // in TraceRing, must be a power of 2
+
+// type, then what thread and arg are
+#define TRACE_TYPES(X) \
+  X(TRACE_SWITCH,    "thread arg runs after thread") \
+  X(TRACE_WAIT,      "thread calls OS_Wait on semaphore arg") \
+  X(TRACE_BLOCK,     "semaphore arg was taken, thread spins") \
+  X(TRACE_WAKE,      "thread got semaphore arg after spinning") \
+  X(TRACE_SIGNAL,    "thread signals semaphore arg") \
+  X(TRACE_ISR_ENTER, "interrupt arg starts, thread was running") \
+  X(TRACE_ISR_EXIT,  "interrupt arg returns") \
+  X(TRACE_CREATE,    "thread adds thread arg") \
+  X(TRACE_KILL,      "thread kills itself") \
+  X(TRACE_FLUSH,     "thread releases every other thread") \
+  X(TRACE_SLEEP,     "thread sleeps arg ms") \
+  X(TRACE_TRIGGER,   "Trace_Trigger() called, arg given")
+
+#define TRACE_ENUM(type, what) type,
+enum { TRACE_TYPES(TRACE_ENUM) TRACE_TYPE_COUNT };
+
+// interrupt numbers of TRACE_ISR_ENTER and TRACE_ISR_EXIT, as in the
+// vector table of startup.s
+#define TRACE_IRQ_GPIOD   3
+#define TRACE_IRQ_UART0   5
+#define TRACE_IRQ_ADC0SS1 15
+#define TRACE_IRQ_TIMER1A 21
+#define TRACE_IRQ_TIMER2A 23
+#define TRACE_IRQ_TIMER4A 70
+#define TRACE_IRQ_TIMER5A 92
+#define TRACE_IRQ_WTIMER0A 94
+
+#define TRACE_NO_THREAD 0xFF  // thread of an event before the first OS_AddThread
+#define TRACE_CURRENT   0xFE  // Trace_Event() stores the running thread
+
+// TELE_TRACE payload: this header, then up to TRACE_FRAME_EVENTS events
+typedef struct {
+  uint16_t first;             // index in the dump of the frame's first event
+  uint16_t dump;              // dumps sent since Trace_Init()
+  uint32_t events;            // events in the dump
+  uint32_t eventCycles;       // TraceStats.eventCycles
+} TraceHeaderType;
+#define TRACE_FRAME_EVENTS 28
+
+typedef struct {
+  uint32_t events;            // events sent in dumps
+  uint32_t dumps;             // dumps sent
+  uint32_t eventCycles;       // cost of one event, measured by Trace_Init()
+} TraceStatsType;
+extern TraceStatsType TraceStats;
+
+//------------Trace_Init------------
+// Empty the ring, time a few events into TraceStats.eventCycles and
+// start recording.
+// Input: none
+// Output: none
+void Trace_Init(void);
+
+//------------Trace_Event------------
+// Record one event unless the ring is frozen.  Callable from any
+// thread or interrupt.
+// Input: type from TRACE_TYPES, thread (TRACE_CURRENT for the running one) and arg
+// Output: none
+void Trace_Event(uint32_t type, uint32_t thread, uint32_t arg);
+
+//------------Trace_Trigger------------
+// Freeze the ring after TRACE_EVENTS/2 more events, so the dump shows
+// as much before the call as after.  Ignored while a trigger is pending
+// or the ring is frozen.
+// Input: arg, recorded in a TRACE_TRIGGER event
+// Output: none
+void Trace_Trigger(uint32_t arg);
+
+//------------Trace_Drain------------
+// Send the frozen ring in TELE_TRACE frames, as many as Tx_UARTFifo has
+// room for, and start recording again after the last.  Call it from
+// the thread that sends the other telemetry frames.
+// Input: none
+// Output: events sent
+uint32_t Trace_Drain(void);
+
+#if TRACE_ON
+#define TRACE(type, thread, arg) Trace_Event((type), (thread), (arg))
+#else
+#define TRACE(type, thread, arg)
+#endif
+
+#endif
@@ -0,0 +1,26 @@
+// uDMA.c
+// Runs on TM4C123
+// Channel control table of the uDMA controller, see uDMA.h.
+
+#include <stdint.h>
+#include "tm4c123gh6pm.h"
+#ifdef UART_SIM
+#include "UARTSim.h"
+#endif
+#ifdef WAVE_SIM
+#include "WaveSim.h"
+#endif
+#include "uDMA.h"
+
+// the controller needs the table on a 1024 byte boundary
+DMA_ChannelType DMA_Table[2*DMA_CHANNELS] __attribute__((aligned(1024)));
+
+void DMA_Init(void){
+  if(UDMA_CFG_R&UDMA_CFG_MASTEN){
+    return;                             // another driver did it
+  }
+  SYSCTL_RCGCDMA_R |= SYSCTL_RCGCDMA_R0; // activate uDMA
+  while((SYSCTL_PRDMA_R&SYSCTL_PRDMA_R0) == 0){};
+  UDMA_CFG_R = UDMA_CFG_MASTEN;         // enable the controller
+  UDMA_CTLBASE_R = (uint32_t)(uintptr_t)DMA_Table;
+}
@@ -0,0 +1,41 @@
+// uDMA.h
+// Runs on TM4C123
+// Channel control table of the uDMA controller, shared by every driver
+// that moves data with uDMA.  Channels in use:
+//   8  encoding 0, UART0 RX, ping-pong into two halves, see UART.c
+//   9  encoding 0, UART0 TX, basic transfers out of Tx_UARTFifo, see UART.c
+//   10 encoding 3, Wide Timer 0A, ping-pong from two blocks of samples
+//      into PWM1_3_CMPA_R, see wave.c
+
+#ifndef UDMA_H
+#define UDMA_H
+
+#include <stdint.h>
+
+#define DMA_CHANNELS 32
+
+// one channel control structure, 16 bytes on the target
+typedef struct {
+  volatile uintptr_t srcEnd;    // address of the last source item
+  volatile uintptr_t dstEnd;    // address of the last destination item
+  volatile uint32_t control;    // UDMA_CHCTL_ fields in tm4c123gh6pm.h
+  uint32_t spare;
+} DMA_ChannelType;
+
+// primary structures first, then the alternate ones used by ping-pong
+extern DMA_ChannelType DMA_Table[2*DMA_CHANNELS];
+#define DMA_PRIMARY(ch)   (&DMA_Table[(ch)])
+#define DMA_ALTERNATE(ch) (&DMA_Table[DMA_CHANNELS + (ch)])
+
+// items a control word has left to move, 0 once uDMA has stopped it
+#define DMA_REMAINING(control) ((((control)&UDMA_CHCTL_XFERMODE_M) == UDMA_CHCTL_XFERMODE_STOP) ? 0 : \
+  ((((control)&UDMA_CHCTL_XFERSIZE_M) >> UDMA_CHCTL_XFERSIZE_S) + 1))
+
+//------------DMA_Init------------
+// Activate the uDMA controller and point it at DMA_Table.  Every
+// driver that uses a channel calls it, only the first call does anything.
+// Input: none
+// Output: none
+void DMA_Init(void);
+
+#endif
@@ -0,0 +1,298 @@
+// wave.c
+// Sample playback and mixing on M1PWM6 (PF2), fed by uDMA, see wave.h.
+
+#include <stdint.h>
+#include "tm4c123gh6pm.h"
+#ifdef WAVE_SIM
+#include "WaveSim.h"
+#endif
+#include "os.h"
+#include "uDMA.h"
+#include "wave.h"
+#include "trace.h"
+
+long StartCritical(void);    // previous I bit, disable interrupts
+void EndCritical(long sr);    // restore I bit to previous value
+
+#define NVIC_EN2_INT94 0x40000000  // Interrupt 94 enable, Wide Timer 0A
+#define WAVE_CHANNEL  10           // uDMA channel 10 encoding 3, Wide Timer 0A
+#define WAVE_ENCODING 3
+#define WAVE_BIT      (1u << WAVE_CHANNEL)
+#define WAVE_CONTROL (UDMA_CHCTL_DSTINC_NONE|UDMA_CHCTL_DSTSIZE_32|UDMA_CHCTL_SRCINC_32|\
+  UDMA_CHCTL_SRCSIZE_32|UDMA_CHCTL_ARBSIZE_1|((WAVE_BLOCK - 1) << UDMA_CHCTL_XFERSIZE_S)|\
+  UDMA_CHCTL_XFERMODE_PINGPONG)
+#define WAVE_SILENCE  (1 + ((2048*(WAVE_LOAD - 1)) >> 12)) // duty of the middle level
+#define SQUARE_GAIN   (WAVE_GAIN/2)
+
+typedef struct {
+  const void *data;
+  uint32_t phase;             // position in data, 16.16 fixed point
+  uint32_t step;              // added to phase each sample
+  uint32_t end;               // length of data, 16.16
+  uint32_t left;              // samples to go of a tone, 0 without an end
+  int32_t gain;               // 1/256
+  uint8_t bits;
+  uint8_t loop;               // a wavetable, starts over at the end
+  volatile uint8_t on;
+} VoiceType;
+
+WaveStatsType WaveStats;
+static VoiceType Voice[WAVE_VOICES];
+static uint32_t Buffer[2][WAVE_BLOCK];  // duty cycles, uDMA plays one while the other is mixed
+static int32_t Sum[WAVE_BLOCK];
+static uint32_t Half;                   // the block uDMA plays first
+
+static const uint16_t SineTable[64] = {
+  2048, 2249, 2447, 2642, 2831, 3013, 3185, 3347,
+  3495, 3630, 3750, 3853, 3939, 4007, 4056, 4085,
+  4095, 4085, 4056, 4007, 3939, 3853, 3750, 3630,
+  3495, 3347, 3185, 3013, 2831, 2642, 2447, 2249,
+  2048, 1847, 1649, 1454, 1265, 1083,  911,  749,
+   601,  466,  346,  243,  157,   89,   40,   11,
+     1,   11,   40,   89,  157,  243,  346,  466,
+   601,  749,  911, 1083, 1265, 1454, 1649, 1847
+};
+const WaveSound WaveSine = { SineTable, 64, 0, 12 };
+
+static const uint16_t SquareTable[2] = { 4095, 1 };
+static const WaveSound WaveSquare = { SquareTable, 2, 0, 12 };
+
+//------------mixer------------
+// add the next samples of a voice to Sum; the loop for each sample size
+#define WAVE_ADD(type, sample) { \
+  const type *s = v->data; \
+  for(i = 0; i < n; i++){ \
+    Sum[i] += (sample)*gain; \
+    phase += step; \
+    if(phase >= end){ \
+      if(!v->loop){ \
+        v->on = 0; \
+        break; \
+      } \
+      phase -= end; \
+    } \
+  } \
+}
+
+static void add(VoiceType *v){
+  uint32_t i, n = WAVE_BLOCK, phase = v->phase, step = v->step, end = v->end;
+  int32_t gain = v->gain;
+  if(v->left){
+    if(v->left <= n){
+      n = v->left;
+      v->on = 0;
+    }
+    v->left -= n;
+  }
+  if(v->bits == 8){
+    WAVE_ADD(uint8_t, ((int32_t)s[phase >> 16] - 128) << 4)
+  }else{
+    WAVE_ADD(uint16_t, (int32_t)s[phase >> 16] - 2048)
+  }
+  v->phase = phase;
+}
+
+// the voices, summed and clipped, as duty cycles into out
+static void mix(uint32_t *out){
+  uint32_t i;
+  int32_t x;
+  for(i = 0; i < WAVE_VOICES; i++){
+    if(Voice[i].on){
+      add(&Voice[i]);
+    }
+  }
+  for(i = 0; i < WAVE_BLOCK; i++){
+    x = Sum[i] >> 8;
+    Sum[i] = 0;
+    if(x > 2047){
+      x = 2047;
+      WaveStats.clipped++;
+    }else if(x < -2048){
+      x = -2048;
+      WaveStats.clipped++;
+    }
+    out[i] = 1 + (((uint32_t)(x + 2048)*(WAVE_LOAD - 1)) >> 12);
+  }
+}
+
+// mix each block uDMA has played, and re-arm it
+static void refill(void){
+  DMA_ChannelType *half;
+  uint32_t t;
+  for(;;){
+    half = Half ? DMA_ALTERNATE(WAVE_CHANNEL) : DMA_PRIMARY(WAVE_CHANNEL);
+    if((half->control&UDMA_CHCTL_XFERMODE_M) != UDMA_CHCTL_XFERMODE_STOP){
+      return;                           // still to play
+    }
+    t = OS_Time();
+    mix(Buffer[Half]);
+    t = OS_TimeDifference(t, OS_Time());
+    WaveStats.mixCycles = t;
+    if(t > WaveStats.mixMax){
+      WaveStats.mixMax = t;
+    }
+    WaveStats.blocks++;
+    half->control = WAVE_CONTROL;
+    Half ^= 1;
+    if((UDMA_ENASET_R&WAVE_BIT) == 0){
+      WaveStats.underruns++;            // both blocks played, the channel stopped
+      UDMA_ENASET_R = WAVE_BIT;
+    }
+  }
+}
+
+// uDMA played a block
+void WideTimer0A_Handler(void){
+  TRACE(TRACE_ISR_ENTER, TRACE_CURRENT, TRACE_IRQ_WTIMER0A);
+  UDMA_CHIS_R = WAVE_BIT;               // acknowledge uDMA
+  refill();
+  TRACE(TRACE_ISR_EXIT, TRACE_CURRENT, TRACE_IRQ_WTIMER0A);
+}
+
+void Wave_Init(void){
+  uint32_t i;
+  for(i = 0; i < WAVE_VOICES; i++){
+    Voice[i].on = 0;
+    Voice[i].left = 0;
+  }
+  for(i = 0; i < WAVE_BLOCK; i++){
+    Buffer[0][i] = Buffer[1][i] = WAVE_SILENCE;
+    Sum[i] = 0;
+  }
+  Half = 0;
+
+  SYSCTL_RCGCPWM_R |= 0x02;       // Activate PWM1
+  SYSCTL_RCGCGPIO_R |= 0x20;      // Activate Port F
+  while((SYSCTL_PRGPIO_R & 0x20) == 0){}; // Ready
+  GPIO_PORTF_AFSEL_R |= 0x04;     // Enable alt funct on PF2
+  GPIO_PORTF_PCTL_R &= ~0x00000F00;
+  GPIO_PORTF_PCTL_R |= 0x00000500; // Configure PF2 as M1PWM6
+  GPIO_PORTF_AMSEL_R &= ~0x04;    // Disable analog on PF2
+  GPIO_PORTF_DIR_R |= 0x04;       // PF2 output
+  GPIO_PORTF_DEN_R |= 0x04;       // enable digital I/O on PF2
+  SYSCTL_RCC_R &= ~SYSCTL_RCC_USEPWMDIV; // PWM1 counts the bus clock
+  PWM1_3_CTL_R = 0;               // Generator 3 disable
+  PWM1_3_GENA_R = 0xC8;           // low on LOAD, high on CMPA down
+  PWM1_3_LOAD_R = WAVE_LOAD;      // carrier of twice WAVE_RATE
+  PWM1_3_CMPA_R = WAVE_SILENCE;
+  PWM1_3_CTL_R |= 0x01;           // enable generator, CMPA updates at 0
+  PWM1_ENABLE_R |= 0x40;          // M1PWM6 on, silence is the middle duty
+
+  DMA_Init();
+  UDMA_ENACLR_R = WAVE_BIT;       // stop the channel while it is set up
+  UDMA_CHMAP1_R = (UDMA_CHMAP1_R&~UDMA_CHMAP1_CH10SEL_M)|(WAVE_ENCODING << UDMA_CHMAP1_CH10SEL_S);
+  UDMA_PRIOCLR_R = WAVE_BIT;      // default priority
+  UDMA_REQMASKCLR_R = WAVE_BIT;   // allow requests from Wide Timer 0A
+  UDMA_ALTCLR_R = WAVE_BIT;       // start on the primary structure
+  UDMA_USEBURSTCLR_R = WAVE_BIT;  // a timer request is a burst of one anyway
+  for(i = 0; i < 2; i++){
+    DMA_Table[i*DMA_CHANNELS + WAVE_CHANNEL].srcEnd = (uintptr_t)&Buffer[i][WAVE_BLOCK - 1];
+    DMA_Table[i*DMA_CHANNELS + WAVE_CHANNEL].dstEnd = (uintptr_t)&PWM1_3_CMPA_R;
+    DMA_Table[i*DMA_CHANNELS + WAVE_CHANNEL].control = WAVE_CONTROL;
+  }
+  UDMA_ENASET_R = WAVE_BIT;
+
+  SYSCTL_RCGCWTIMER_R |= 0x01;    // Activate Wide Timer 0
+  while((SYSCTL_PRWTIMER_R & 0x01) == 0){};
+  WTIMER0_CTL_R &= ~TIMER_CTL_TAEN;
+  WTIMER0_CFG_R = TIMER_CFG_16_BIT; // the 32-bit half of the wide timer
+  WTIMER0_TAMR_R = TIMER_TAMR_TAMR_PERIOD;
+  WTIMER0_TAILR_R = 80000000/WAVE_RATE - 1;
+  WTIMER0_TAPR_R = 0;
+  WTIMER0_IMR_R = 0;              // timeouts only request uDMA, its done interrupt comes on its own
+  NVIC_PRI23_R = (NVIC_PRI23_R&0xFF00FFFF)|(WAVE_PRIORITY << 21); // bits 23-21
+  NVIC_EN2_R = NVIC_EN2_INT94;
+  WTIMER0_CTL_R |= TIMER_CTL_TAEN;
+}
+
+// start sound in voice k, interrupts disabled
+static void start(uint32_t k, const WaveSound *sound, uint32_t step, uint32_t left, int loop,
+                  uint32_t gain){
+  VoiceType *v = &Voice[k];
+  v->on = 0;
+  v->data = sound->data;
+  v->bits = sound->bits;
+  v->phase = 0;
+  v->step = step;
+  v->end = (uint32_t)sound->length << 16;
+  v->left = left;
+  v->loop = loop;
+  v->gain = gain;
+  v->on = 1;
+}
+
+// a free voice for an effect, interrupts disabled; WAVE_VOICES if none
+static uint32_t voice(void){
+  uint32_t k;
+  for(k = 1; k < WAVE_VOICES; k++){
+    if(!Voice[k].on){
+      return k;
+    }
+  }
+  WaveStats.dropped++;
+  return WAVE_VOICES;
+}
+
+int Wave_Sample(const WaveSound *sound, uint32_t gain){
+  uint32_t k;
+  long sr;
+  if((sound->length == 0) || (sound->length > WAVE_LENGTH_MAX)){
+    return 0;
+  }
+  sr = StartCritical();
+  k = voice();
+  if(k < WAVE_VOICES){
+    start(k, sound, (uint32_t)(((uint64_t)sound->rate << 16)/WAVE_RATE), 0, 0, gain);
+  }
+  EndCritical(sr);
+  return k < WAVE_VOICES;
+}
+
+// phase step of a wavetable at frequency, 0 at or above WAVE_RATE/2
+static uint32_t tableStep(const WaveSound *table, uint32_t frequency){
+  if((frequency >= WAVE_RATE/2) || (table->length == 0) || (table->length > WAVE_LENGTH_MAX)){
+    return 0;
+  }
+  return (uint32_t)((((uint64_t)frequency*table->length) << 16)/WAVE_RATE);
+}
+
+int Wave_Tone(const WaveSound *table, uint32_t frequency, uint32_t duration, uint32_t gain){
+  uint32_t k, step = tableStep(table, frequency), left = duration*(WAVE_RATE/1000);
+  long sr;
+  if((step == 0) || (left == 0)){
+    return 0;
+  }
+  sr = StartCritical();
+  k = voice();
+  if(k < WAVE_VOICES){
+    start(k, table, step, left, 1, gain);
+  }
+  EndCritical(sr);
+  return k < WAVE_VOICES;
+}
+
+void Wave_Square(uint32_t frequency){
+  uint32_t step = tableStep(&WaveSquare, frequency);
+  long sr = StartCritical();
+  if(step){
+    start(0, &WaveSquare, step, 0, 1, SQUARE_GAIN);  // until the next call
+  }else{
+    Voice[0].on = 0;
+  }
+  EndCritical(sr);
+}
+
+void Wave_Stop(void){
+  uint32_t k;
+  for(k = 1; k < WAVE_VOICES; k++){
+    Voice[k].on = 0;
+  }
+}
+
+uint32_t Wave_Busy(void){
+  uint32_t k, n = 0;
+  for(k = 0; k < WAVE_VOICES; k++){
+    n += Voice[k].on;
+  }
+  return n;
+}
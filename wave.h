@@ -0,0 +1,94 @@
+#ifndef WAVE_H
+#define WAVE_H
+
+#include <stdint.h>
+
+// Sample playback on the buzzer at PF2 (M1PWM6) as a PWM DAC.  PWM1
+// generator 3 counts the 80 MHz bus clock with a carrier of twice
+// WAVE_RATE, and its duty cycle is the sound: Wide Timer 0A times out
+// WAVE_RATE times a second and each timeout makes uDMA channel 10 copy
+// the next duty cycle into PWM1_3_CMPA_R.  uDMA plays two blocks of
+// WAVE_BLOCK samples ping-pong; when one is done WideTimer0A_Handler()
+// mixes the voices into it while uDMA plays the other.
+//
+// Up to WAVE_VOICES sounds play at once, summed in fixed point, 12 bits
+// a sample and gains in 1/256, clipped at full scale.  A voice plays a
+// recording once at its own rate, or loops one period of a wavetable at
+// any frequency; voice 0 is the square wave of sound.c's sequencer,
+// the others are for game effects, so they overlap.  Sound sources are
+// 8-bit unsigned (128 the middle) or 12-bit unsigned (2048 the middle).
+//
+// WaveStats.mixCycles is what a block costs to mix, measured with
+// OS_Time(); at WAVE_RATE/WAVE_BLOCK blocks a second that is the CPU
+// load of the mixer.
+//
+// Host build (for tools/wavetest.c): compile with -DWAVE_SIM, the
+// registers become WaveSim.c's model of Wide Timer 0A, uDMA and PWM1.
+
+#define WAVE_RATE     16000     // samples a second, 8000 to 16000
+#define WAVE_BLOCK    64        // samples a uDMA half, 4 ms at 16 kHz
+#define WAVE_VOICES   4         // voice 0 the sequencer's square wave
+#define WAVE_GAIN     256       // gain of 1
+#define WAVE_LOAD     (80000000/(2*WAVE_RATE) - 1) // PWM1_3_LOAD_R, 2500 steps at 16 kHz
+#define WAVE_PRIORITY 5         // Wide Timer 0A, with the sequencer's Timer5A
+#define WAVE_LENGTH_MAX 32768   // samples of a recording or a wavetable
+
+// a recording, or one period of a wavetable
+typedef struct {
+  const void *data;           // uint8_t or uint16_t samples
+  uint16_t length;            // samples, at most WAVE_LENGTH_MAX
+  uint16_t rate;              // samples a second of a recording, unused for a wavetable
+  uint8_t bits;               // 8 or 12
+} WaveSound;
+
+// one period of a sine, 64 samples of 12 bits
+extern const WaveSound WaveSine;
+
+typedef struct {
+  uint32_t blocks;            // blocks mixed
+  uint32_t underruns;         // uDMA had played both blocks before one was mixed
+  uint32_t clipped;           // samples louder than full scale
+  uint32_t dropped;           // sounds not played, every voice busy
+  uint32_t mixCycles;         // bus cycles to mix the last block
+  uint32_t mixMax;            // most bus cycles a block took
+} WaveStatsType;
+extern WaveStatsType WaveStats;
+
+//------------Wave_Init------------
+// PF2 as M1PWM6 at the middle duty, PWM1 on the undivided bus clock,
+// uDMA channel 10 on Wide Timer 0A, playing silence from now on.
+// Input: none
+// Output: none
+void Wave_Init(void);
+
+//------------Wave_Sample------------
+// Play a recording once, in the first free voice.
+// Input: sound, the recording; gain in 1/256 (WAVE_GAIN for as recorded)
+// Output: 1 if it plays, 0 if every voice is busy
+int Wave_Sample(const WaveSound *sound, uint32_t gain);
+
+//------------Wave_Tone------------
+// Loop one period of a wavetable at a frequency, in the first free voice.
+// Input: table, one period; frequency in Hz; duration in ms; gain in 1/256
+// Output: 1 if it plays, 0 if every voice is busy
+int Wave_Tone(const WaveSound *table, uint32_t frequency, uint32_t duration, uint32_t gain);
+
+//------------Wave_Square------------
+// The square wave of voice 0, until the next call; PlaySound() and
+// StopSound() of sound.c when the mixer drives the buzzer.
+// Input: frequency in Hz, 0 for silence
+// Output: none
+void Wave_Square(uint32_t frequency);
+
+//------------Wave_Stop------------
+// Silence every voice but the square wave.
+// Input: none
+// Output: none
+void Wave_Stop(void);
+
+//------------Wave_Busy------------
+// Input: none
+// Output: voices playing, the square wave included
+uint32_t Wave_Busy(void);
+
+#endif
@@ -0,0 +1,95 @@
+// widget.c
+// Retained-mode text widgets for the HUD and the menus.
+// A widget owns a run of glyph cells on the 21x13 character grid and
+// keeps a copy of the characters it last drew there.  Updates compose
+// the new text into a scratch buffer and only call BSP_LCD_DrawChar()
+// for the cells that differ from that copy.
+
+#include <stdint.h>
+#include "LCD.h"
+#include "widget.h"
+
+#define WIDGET_MARKER 0x10  // right pointing triangle in the LCD font
+
+void Widget_Init(WidgetType *w, uint8_t col, uint8_t row, uint8_t len, int16_t textColor, int16_t bgColor){
+  if(len > WIDGET_MAXLEN) len = WIDGET_MAXLEN;
+  if(col + len > 21) len = 21 - col;  // stay on the screen
+  w->col = col;
+  w->row = row;
+  w->len = len;
+  w->textColor = textColor;
+  w->bgColor = bgColor;
+  Widget_Invalidate(w);
+}
+
+void Widget_Invalidate(WidgetType *w){
+  int i;
+  for(i = 0; i < WIDGET_MAXLEN; i++){
+    w->shown[i] = 0;  // 0 never matches a printable character
+  }
+}
+
+// push the composed text, one glyph cell at a time, skipping the
+// cells that already show the right character
+static uint32_t update(WidgetType *w, const char *text){
+  uint32_t sent = 0;
+  int i;
+  for(i = 0; i < w->len; i++){
+    if(w->shown[i] != text[i]){
+      BSP_LCD_DrawChar((w->col + i)*6, w->row*10, text[i], w->textColor, w->bgColor, 1);
+      w->shown[i] = text[i];
+      sent++;
+    }
+  }
+  return sent;
+}
+
+uint32_t Widget_Label(WidgetType *w, const char *string){
+  char text[WIDGET_MAXLEN];
+  int i;
+  for(i = 0; i < w->len; i++){
+    if(*string){
+      text[i] = *string++;
+    }else{
+      text[i] = ' ';   // pad so that a shorter string erases the old one
+    }
+  }
+  return update(w, text);
+}
+
+uint32_t Widget_Number(WidgetType *w, uint32_t value){
+  char text[WIDGET_MAXLEN];
+  int i = w->len;
+  int overflow = 0;
+  // fill from the right, ones digit last
+  do{
+    text[--i] = (value % 10) + '0';
+    value = value / 10;
+  }while(value && i > 0);
+  if(value){
+    overflow = 1;      // does not fit, show 9s like BSP_LCD_OutUDec4
+  }
+  while(i > 0){
+    text[--i] = ' ';
+  }
+  if(overflow){
+    for(i = 0; i < w->len; i++){
+      text[i] = '9';
+    }
+  }
+  return update(w, text);
+}
+
+uint32_t Widget_MenuItem(WidgetType *w, const char *string, int selected){
+  char text[WIDGET_MAXLEN];
+  int i;
+  text[0] = selected ? WIDGET_MARKER : ' ';
+  for(i = 1; i < w->len; i++){
+    if(*string){
+      text[i] = *string++;
+    }else{
+      text[i] = ' ';
+    }
+  }
+  return update(w, text);
+}
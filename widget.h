@@ -0,0 +1,66 @@
+#ifndef WIDGET_H
+#define WIDGET_H
+
+#include <stdint.h>
+
+// Retained-mode text widgets on the 21x13 character grid used by
+// BSP_LCD_DrawString().  Each widget remembers the characters it has
+// already put on the screen, so an update only sends the glyph cells
+// whose character changed (11 + 96 bytes per changed cell) instead of
+// redrawing the whole label and value every pass.
+
+#define WIDGET_MAXLEN 16  // maximum number of glyph cells owned by one widget
+
+typedef struct {
+  uint8_t col;                  // column of the first glyph cell (0 to 20)
+  uint8_t row;                  // row of the glyph cells (0 to 12)
+  uint8_t len;                  // number of glyph cells owned by the widget
+  int16_t textColor;            // 16-bit color of the characters
+  int16_t bgColor;              // 16-bit color behind the characters
+  char shown[WIDGET_MAXLEN];    // characters currently on the screen, 0 if unknown
+} WidgetType;
+
+//------------Widget_Init------------
+// Attach a widget to a run of glyph cells.  Nothing is drawn until
+// the first Widget_Label/Widget_Number/Widget_MenuItem call.
+// Input: w         pointer to the widget
+//        col       column of the first glyph cell (0 to 20)
+//        row       row of the glyph cells (0 to 12)
+//        len       number of glyph cells (1 to WIDGET_MAXLEN)
+//        textColor 16-bit color of the characters
+//        bgColor   16-bit color behind the characters
+// Output: none
+void Widget_Init(WidgetType *w, uint8_t col, uint8_t row, uint8_t len, int16_t textColor, int16_t bgColor);
+
+//------------Widget_Invalidate------------
+// Forget what the widget has drawn, e.g. after the screen has been
+// cleared, so that the next update redraws every glyph cell.
+// Input: w pointer to the widget
+// Output: none
+void Widget_Invalidate(WidgetType *w);
+
+//------------Widget_Label------------
+// Show a string, left aligned and padded with spaces to the widget length.
+// Input: w      pointer to the widget
+//        string pointer to a null terminated string
+// Output: number of glyph cells sent to the LCD
+uint32_t Widget_Label(WidgetType *w, const char *string);
+
+//------------Widget_Number------------
+// Show an unsigned decimal number, right aligned in the widget length.
+// Values too large for the field are clamped to all 9s.
+// Input: w     pointer to the widget
+//        value number to be shown
+// Output: number of glyph cells sent to the LCD
+uint32_t Widget_Number(WidgetType *w, uint32_t value);
+
+//------------Widget_MenuItem------------
+// Show a menu entry.  The first glyph cell holds the selection marker
+// and the rest of the widget holds the string.
+// Input: w        pointer to the widget
+//        string   pointer to a null terminated string
+//        selected 1 to show the marker, 0 to hide it
+// Output: number of glyph cells sent to the LCD
+uint32_t Widget_MenuItem(WidgetType *w, const char *string, int selected);
+
+#endif